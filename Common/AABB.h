@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <glm/glm.hpp>
+
+namespace LibOpenNFS {
+    // Axis aligned bounding box. Default constructed boxes are empty (inverted) so that they can be grown with Extend.
+    struct AABB {
+        glm::vec3 min{FLT_MAX};
+        glm::vec3 max{-FLT_MAX};
+
+        AABB() = default;
+        AABB(glm::vec3 const &min, glm::vec3 const &max) : min(min), max(max) {
+        }
+
+        void Extend(glm::vec3 const &point) {
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+        void Extend(AABB const &other) {
+            min = glm::min(min, other.min);
+            max = glm::max(max, other.max);
+        }
+        bool IsValid() const {
+            return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+        }
+        glm::vec3 Center() const {
+            return (min + max) * 0.5f;
+        }
+        glm::vec3 Size() const {
+            return max - min;
+        }
+        float SurfaceArea() const {
+            if (!IsValid()) {
+                return 0.f;
+            }
+            glm::vec3 const size{Size()};
+            return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+        bool Contains(glm::vec3 const &point) const {
+            return point.x >= min.x && point.y >= min.y && point.z >= min.z && point.x <= max.x && point.y <= max.y && point.z <= max.z;
+        }
+        bool Intersects(AABB const &other) const {
+            return min.x <= other.max.x && max.x >= other.min.x && min.y <= other.max.y && max.y >= other.min.y && min.z <= other.max.z &&
+                   max.z >= other.min.z;
+        }
+        float DistanceSquared(glm::vec3 const &point) const {
+            glm::vec3 const delta{glm::max(glm::max(min - point, point - max), glm::vec3(0.f))};
+            return glm::dot(delta, delta);
+        }
+        // Slab test against a ray given as origin and 1/direction. On a hit, tEntry is the (clamped to 0) entry distance.
+        bool IntersectRay(glm::vec3 const &origin, glm::vec3 const &invDirection, float const tMax, float &tEntry) const {
+            glm::vec3 const t0{(min - origin) * invDirection};
+            glm::vec3 const t1{(max - origin) * invDirection};
+            glm::vec3 const tNear{glm::min(t0, t1)};
+            glm::vec3 const tFar{glm::max(t0, t1)};
+            tEntry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.f));
+            float const tExit{std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax))};
+            return tEntry <= tExit;
+        }
+        AABB Expanded(float const amount) const {
+            return {min - glm::vec3(amount), max + glm::vec3(amount)};
+        }
+        // Bounds of this box after an affine transform (Arvo): the centre is transformed, the half extents by the absolute matrix
+        AABB Transformed(glm::mat4 const &transform) const {
+            if (!IsValid()) {
+                return {};
+            }
+            glm::vec3 const center{transform * glm::vec4(Center(), 1.f)};
+            glm::vec3 const halfExtent{Size() * 0.5f};
+            glm::vec3 newHalfExtent{0.f};
+            for (int column = 0; column < 3; ++column) {
+                newHalfExtent += glm::abs(glm::vec3(transform[column])) * halfExtent[column];
+            }
+            return {center - newHalfExtent, center + newHalfExtent};
+        }
+    };
+} // namespace LibOpenNFS
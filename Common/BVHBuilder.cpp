@@ -0,0 +1,115 @@
+#include "BVHBuilder.h"
+
+#include <array>
+
+namespace LibOpenNFS {
+    namespace {
+        constexpr uint32_t kSAHBins{16};
+        // Below this depth nodes are split at the object median, which bounds the depth of a tree to kMedianSplitDepth + 32
+        constexpr uint32_t kMedianSplitDepth{32};
+        static_assert(BVHBuilder::kMaxDepth == kMedianSplitDepth + 32);
+    } // namespace
+
+    std::vector<BVHNode> BVHBuilder::Build(std::vector<AABB> const &primBounds, std::vector<uint32_t> &primOrder, uint32_t const maxLeafSize) {
+        std::vector<BVHNode> nodes;
+        if (primOrder.empty()) {
+            return nodes;
+        }
+        nodes.reserve(primOrder.size() * 2);
+        nodes.push_back({{}, 0, {}, static_cast<uint32_t>(primOrder.size())});
+
+        std::vector<std::pair<uint32_t, uint32_t>> pendingNodes{{0, 0}};
+        while (!pendingNodes.empty()) {
+            auto const [nodeIdx, depth] = pendingNodes.back();
+            pendingNodes.pop_back();
+            uint32_t const first{nodes[nodeIdx].leftOrFirst};
+            uint32_t const count{nodes[nodeIdx].nPrimitives};
+
+            AABB bounds, centroidBounds;
+            for (uint32_t primIdx = first; primIdx < first + count; ++primIdx) {
+                bounds.Extend(primBounds[primOrder[primIdx]]);
+                centroidBounds.Extend(primBounds[primOrder[primIdx]].Center());
+            }
+            nodes[nodeIdx].min = bounds.min;
+            nodes[nodeIdx].max = bounds.max;
+            if (count <= maxLeafSize) {
+                continue;
+            }
+
+            // Find the cheapest bin boundary over all three axes
+            float bestCost{FLT_MAX};
+            int32_t bestAxis{-1};
+            uint32_t bestSplit{0};
+            glm::vec3 const centroidExtent{centroidBounds.Size()};
+            for (int32_t axis = 0; axis < 3 && depth < kMedianSplitDepth; ++axis) {
+                if (centroidExtent[axis] <= 0.f) {
+                    continue;
+                }
+                std::array<AABB, kSAHBins> binBounds{};
+                std::array<uint32_t, kSAHBins> binCounts{};
+                float const binScale{kSAHBins / centroidExtent[axis]};
+                for (uint32_t primIdx = first; primIdx < first + count; ++primIdx) {
+                    AABB const &prim{primBounds[primOrder[primIdx]]};
+                    auto const bin{std::min(kSAHBins - 1, static_cast<uint32_t>((prim.Center()[axis] - centroidBounds.min[axis]) * binScale))};
+                    binBounds[bin].Extend(prim);
+                    ++binCounts[bin];
+                }
+                // Sweep from the right to get the cost of everything right of each boundary, then from the left
+                std::array<float, kSAHBins - 1> rightCosts{};
+                AABB rightBounds;
+                uint32_t rightCount{0};
+                for (uint32_t bin = kSAHBins - 1; bin > 0; --bin) {
+                    rightBounds.Extend(binBounds[bin]);
+                    rightCount += binCounts[bin];
+                    rightCosts[bin - 1] = rightBounds.SurfaceArea() * static_cast<float>(rightCount);
+                }
+                AABB leftBounds;
+                uint32_t leftCount{0};
+                for (uint32_t split = 0; split < kSAHBins - 1; ++split) {
+                    leftBounds.Extend(binBounds[split]);
+                    leftCount += binCounts[split];
+                    if (leftCount == 0 || leftCount == count) {
+                        continue;
+                    }
+                    float const cost{leftBounds.SurfaceArea() * static_cast<float>(leftCount) + rightCosts[split]};
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = split;
+                    }
+                }
+            }
+
+            uint32_t *const begin{primOrder.data() + first};
+            uint32_t *const end{begin + count};
+            uint32_t *middle{begin};
+            if (bestAxis >= 0) {
+                float const binScale{kSAHBins / centroidExtent[bestAxis]};
+                middle = std::partition(begin, end, [&](uint32_t const primIdx) {
+                    auto const bin{std::min(kSAHBins - 1,
+                                            static_cast<uint32_t>((primBounds[primIdx].Center()[bestAxis] - centroidBounds.min[bestAxis]) * binScale))};
+                    return bin <= bestSplit;
+                });
+            }
+            if (bestAxis < 0 || middle == begin || middle == end) {
+                int32_t const longestAxis{centroidExtent.x >= centroidExtent.y && centroidExtent.x >= centroidExtent.z ? 0
+                                          : centroidExtent.y >= centroidExtent.z                                   ? 1
+                                                                                                                   : 2};
+                middle = begin + count / 2;
+                std::nth_element(begin, middle, end, [&](uint32_t const a, uint32_t const b) {
+                    return primBounds[a].Center()[longestAxis] < primBounds[b].Center()[longestAxis];
+                });
+            }
+
+            auto const leftIdx{static_cast<uint32_t>(nodes.size())};
+            auto const leftCount{static_cast<uint32_t>(middle - begin)};
+            nodes.push_back({{}, first, {}, leftCount});
+            nodes.push_back({{}, first + leftCount, {}, count - leftCount});
+            nodes[nodeIdx].leftOrFirst = leftIdx;
+            nodes[nodeIdx].nPrimitives = 0;
+            pendingNodes.emplace_back(leftIdx, depth + 1);
+            pendingNodes.emplace_back(leftIdx + 1, depth + 1);
+        }
+        return nodes;
+    }
+} // namespace LibOpenNFS
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+
+#include "AABB.h"
+
+namespace LibOpenNFS {
+    // 32 bytes, children of an interior node are stored next to each other
+    struct BVHNode {
+        glm::vec3 min;
+        uint32_t leftOrFirst; // Left child index for interior nodes (right child follows it), first primitive for leaves
+        glm::vec3 max;
+        uint32_t nPrimitives; // 0 for interior nodes
+
+        AABB Bounds() const {
+            return {min, max};
+        }
+    };
+
+    class BVHBuilder {
+      public:
+        // Deepest tree Build can produce, so that traversals can use fixed size stacks
+        static constexpr uint32_t kMaxDepth{64};
+
+        // Binned SAH build over arbitrary primitive bounds. Reorders primOrder so that every leaf covers a contiguous range of it
+        // (leftOrFirst indexes primOrder, not primBounds).
+        static std::vector<BVHNode> Build(std::vector<AABB> const &primBounds, std::vector<uint32_t> &primOrder, uint32_t maxLeafSize);
+    };
+} // namespace LibOpenNFS
@@ -0,0 +1,415 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <span>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ONFS_SSE2
+#endif
+
+#include "Entities/TrackTextureTable.h"
+#include "Logging.h"
+#include "Parallel.h"
+#include "Shared/FSH/FshArchive.h"
+
+namespace LibOpenNFS {
+    namespace {
+        // 16 RGBA texels of a 4x4 block, row by row
+        using Block = std::array<uint8_t, 64>;
+        using Colour = std::array<float, 3>;
+
+        void ExtractBlock(std::vector<uint8_t> const &rgba, uint32_t const width, uint32_t const height, uint32_t const blockX,
+                          uint32_t const blockY, Block &block) {
+            for (uint32_t y = 0; y < 4; ++y) {
+                uint32_t const srcY{std::min(blockY * 4 + y, height - 1)};
+                for (uint32_t x = 0; x < 4; ++x) {
+                    uint32_t const srcX{std::min(blockX * 4 + x, width - 1)};
+                    std::memcpy(&block[(y * 4 + x) * 4], &rgba[(static_cast<size_t>(srcY) * width + srcX) * 4], 4);
+                }
+            }
+        }
+
+        uint16_t To565(Colour const &colour) {
+            auto const r{static_cast<uint16_t>(std::clamp(std::lround(colour[0] * 31.f / 255.f), 0l, 31l))};
+            auto const g{static_cast<uint16_t>(std::clamp(std::lround(colour[1] * 63.f / 255.f), 0l, 63l))};
+            auto const b{static_cast<uint16_t>(std::clamp(std::lround(colour[2] * 31.f / 255.f), 0l, 31l))};
+            return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+        }
+
+        std::array<uint8_t, 4> From565(uint16_t const colour) {
+            uint8_t const r{static_cast<uint8_t>((colour >> 11) & 0x1F)};
+            uint8_t const g{static_cast<uint8_t>((colour >> 5) & 0x3F)};
+            uint8_t const b{static_cast<uint8_t>(colour & 0x1F)};
+            return {static_cast<uint8_t>((r << 3) | (r >> 2)), static_cast<uint8_t>((g << 2) | (g >> 4)),
+                    static_cast<uint8_t>((b << 3) | (b >> 2)), 255};
+        }
+
+        // Four colour palette as decoded by hardware, RGBA with opaque alpha
+        std::array<uint8_t, 16> Palette(uint16_t const colour0, uint16_t const colour1) {
+            std::array<uint8_t, 4> const c0{From565(colour0)}, c1{From565(colour1)};
+            std::array<uint8_t, 16> palette{};
+            for (uint32_t channel = 0; channel < 4; ++channel) {
+                palette[channel] = c0[channel];
+                palette[4 + channel] = c1[channel];
+                palette[8 + channel] = static_cast<uint8_t>((2 * c0[channel] + c1[channel]) / 3);
+                palette[12 + channel] = static_cast<uint8_t>((c0[channel] + 2 * c1[channel]) / 3);
+            }
+            return palette;
+        }
+
+        // Nearest palette entry for each texel, returns the summed squared error
+        uint32_t SelectIndices(Block const &block, std::array<uint8_t, 16> const &palette, std::array<uint8_t, 16> &indices) {
+            uint32_t totalError{0};
+#ifdef ONFS_SSE2
+            // Per texel squared distance to each palette colour, two texels per register in 16 bit lanes, alpha masked off
+            __m128i const zero{_mm_setzero_si128()};
+            __m128i const rgbMask{_mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1)};
+            __m128i paletteColours[4];
+            for (uint32_t entry = 0; entry < 4; ++entry) {
+                uint32_t colour;
+                std::memcpy(&colour, &palette[entry * 4], 4);
+                paletteColours[entry] = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(colour)), zero);
+            }
+            for (uint32_t texelIdx = 0; texelIdx < 16; texelIdx += 4) {
+                __m128i const texels{_mm_loadu_si128(reinterpret_cast<__m128i const *>(&block[texelIdx * 4]))};
+                __m128i const texelPairs[2]{_mm_unpacklo_epi8(texels, zero), _mm_unpackhi_epi8(texels, zero)};
+                __m128i errors[4];
+                for (uint32_t entry = 0; entry < 4; ++entry) {
+                    __m128i sums[2];
+                    for (uint32_t pairIdx = 0; pairIdx < 2; ++pairIdx) {
+                        __m128i const difference{_mm_and_si128(_mm_sub_epi16(texelPairs[pairIdx], paletteColours[entry]), rgbMask)};
+                        // (r^2 + g^2, b^2 + 0) per texel, then summed
+                        __m128i const squares{_mm_madd_epi16(difference, difference)};
+                        sums[pairIdx] = _mm_add_epi32(squares, _mm_srli_epi64(squares, 32));
+                    }
+                    // Texel errors in lanes 0 and 2 of each pair, packed into the four lanes
+                    errors[entry] = _mm_castps_si128(
+                        _mm_shuffle_ps(_mm_castsi128_ps(sums[0]), _mm_castsi128_ps(sums[1]), _MM_SHUFFLE(2, 0, 2, 0)));
+                }
+                std::array<uint32_t, 4> bestErrors, bestIndices;
+                __m128i bestError{errors[0]};
+                __m128i bestIndex{zero};
+                for (uint32_t entry = 1; entry < 4; ++entry) {
+                    __m128i const better{_mm_cmplt_epi32(errors[entry], bestError)};
+                    bestError = _mm_or_si128(_mm_and_si128(better, errors[entry]), _mm_andnot_si128(better, bestError));
+                    bestIndex = _mm_or_si128(_mm_and_si128(better, _mm_set1_epi32(static_cast<int>(entry))),
+                                             _mm_andnot_si128(better, bestIndex));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(bestErrors.data()), bestError);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(bestIndices.data()), bestIndex);
+                for (uint32_t lane = 0; lane < 4; ++lane) {
+                    indices[texelIdx + lane] = static_cast<uint8_t>(bestIndices[lane]);
+                    totalError += bestErrors[lane];
+                }
+            }
+#else
+            for (uint32_t texelIdx = 0; texelIdx < 16; ++texelIdx) {
+                uint32_t bestError{UINT32_MAX};
+                for (uint32_t entry = 0; entry < 4; ++entry) {
+                    uint32_t error{0};
+                    for (uint32_t channel = 0; channel < 3; ++channel) {
+                        int32_t const difference{block[texelIdx * 4 + channel] - palette[entry * 4 + channel]};
+                        error += static_cast<uint32_t>(difference * difference);
+                    }
+                    if (error < bestError) {
+                        bestError = error;
+                        indices[texelIdx] = static_cast<uint8_t>(entry);
+                    }
+                }
+                totalError += bestError;
+            }
+#endif
+            return totalError;
+        }
+
+        void BoundingBoxEndpoints(Block const &block, Colour &endpoint0, Colour &endpoint1) {
+            Colour minColour{255.f, 255.f, 255.f}, maxColour{0.f, 0.f, 0.f}, mean{0.f, 0.f, 0.f};
+            for (uint32_t texelIdx = 0; texelIdx < 16; ++texelIdx) {
+                for (uint32_t channel = 0; channel < 3; ++channel) {
+                    float const value{static_cast<float>(block[texelIdx * 4 + channel])};
+                    minColour[channel] = std::min(minColour[channel], value);
+                    maxColour[channel] = std::max(maxColour[channel], value);
+                    mean[channel] += value / 16.f;
+                }
+            }
+            // Pick the box diagonal the texels lie along, by the sign of red/blue covariance with green
+            float covarianceRG{0.f}, covarianceBG{0.f};
+            for (uint32_t texelIdx = 0; texelIdx < 16; ++texelIdx) {
+                float const green{block[texelIdx * 4 + 1] - mean[1]};
+                covarianceRG += (block[texelIdx * 4] - mean[0]) * green;
+                covarianceBG += (block[texelIdx * 4 + 2] - mean[2]) * green;
+            }
+            if (covarianceRG < 0.f) {
+                std::swap(minColour[0], maxColour[0]);
+            }
+            if (covarianceBG < 0.f) {
+                std::swap(minColour[2], maxColour[2]);
+            }
+            // Inset by 1/16 of the range, the extremes are rarely worth an exact palette entry
+            for (uint32_t channel = 0; channel < 3; ++channel) {
+                float const inset{(maxColour[channel] - minColour[channel]) / 16.f};
+                endpoint0[channel] = maxColour[channel] - inset;
+                endpoint1[channel] = minColour[channel] + inset;
+            }
+        }
+
+        void PrincipalAxisEndpoints(Block const &block, Colour &endpoint0, Colour &endpoint1) {
+            Colour mean{0.f, 0.f, 0.f};
+            for (uint32_t texelIdx = 0; texelIdx < 16; ++texelIdx) {
+                for (uint32_t channel = 0; channel < 3; ++channel) {
+                    mean[channel] += block[texelIdx * 4 + channel] / 16.f;
+                }
+            }
+            std::array<float, 6> covariance{}; // rr, rg, rb, gg, gb, bb
+            for (uint32_t texelIdx = 0; texelIdx < 16; ++texelIdx) {
+                float const r{block[texelIdx * 4] - mean[0]}, g{block[texelIdx * 4 + 1] - mean[1]}, b{block[texelIdx * 4 + 2] - mean[2]};
+                covariance[0] += r * r;
+                covariance[1] += r * g;
+                covariance[2] += r * b;
+                covariance[3] += g * g;
+                covariance[4] += g * b;
+                covariance[5] += b * b;
+            }
+            // Power iteration for the dominant eigenvector
+            Colour axis{1.f, 1.f, 1.f};
+            for (uint32_t iteration = 0; iteration < 8; ++iteration) {
+                Colour const next{covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+                                  covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+                                  covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2]};
+                float const length{std::max({std::fabs(next[0]), std::fabs(next[1]), std::fabs(next[2])})};
+                if (length < 1e-6f) {
+                    break;
+                }
+                axis = {next[0] / length, next[1] / length, next[2] / length};
+            }
+            float const axisLengthSquared{axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]};
+            float minProjection{0.f}, maxProjection{0.f};
+            for (uint32_t texelIdx = 0; texelIdx < 16; ++texelIdx) {
+                float projection{0.f};
+                for (uint32_t channel = 0; channel < 3; ++channel) {
+                    projection += (block[texelIdx * 4 + channel] - mean[channel]) * axis[channel];
+                }
+                minProjection = std::min(minProjection, projection);
+                maxProjection = std::max(maxProjection, projection);
+            }
+            for (uint32_t channel = 0; channel < 3; ++channel) {
+                endpoint0[channel] = std::clamp(mean[channel] + axis[channel] * maxProjection / axisLengthSquared, 0.f, 255.f);
+                endpoint1[channel] = std::clamp(mean[channel] + axis[channel] * minProjection / axisLengthSquared, 0.f, 255.f);
+            }
+        }
+
+        // Endpoints minimising the squared error for fixed indices, false if the system is singular (single palette entry used)
+        bool RefineEndpoints(Block const &block, std::array<uint8_t, 16> const &indices, Colour &endpoint0, Colour &endpoint1) {
+            constexpr std::array<float, 4> kWeights{1.f, 0.f, 2.f / 3.f, 1.f / 3.f}; // Of endpoint0, per palette entry
+            float aa{0.f}, ab{0.f}, bb{0.f};
+            Colour ax{0.f, 0.f, 0.f}, bx{0.f, 0.f, 0.f};
+            for (uint32_t texelIdx = 0; texelIdx < 16; ++texelIdx) {
+                float const a{kWeights[indices[texelIdx]]};
+                float const b{1.f - a};
+                aa += a * a;
+                ab += a * b;
+                bb += b * b;
+                for (uint32_t channel = 0; channel < 3; ++channel) {
+                    ax[channel] += a * block[texelIdx * 4 + channel];
+                    bx[channel] += b * block[texelIdx * 4 + channel];
+                }
+            }
+            float const determinant{aa * bb - ab * ab};
+            if (std::fabs(determinant) < 1e-6f) {
+                return false;
+            }
+            for (uint32_t channel = 0; channel < 3; ++channel) {
+                endpoint0[channel] = std::clamp((ax[channel] * bb - bx[channel] * ab) / determinant, 0.f, 255.f);
+                endpoint1[channel] = std::clamp((bx[channel] * aa - ax[channel] * ab) / determinant, 0.f, 255.f);
+            }
+            return true;
+        }
+
+        struct ColourBlock {
+            uint16_t colour0{0};
+            uint16_t colour1{0};
+            std::array<uint8_t, 16> indices{};
+            uint32_t error{UINT32_MAX};
+        };
+
+        // Quantise endpoints into a four colour block (colour0 > colour1) and pick its indices
+        ColourBlock QuantiseColourBlock(Block const &block, Colour const &endpoint0, Colour const &endpoint1) {
+            ColourBlock colourBlock;
+            colourBlock.colour0 = To565(endpoint0);
+            colourBlock.colour1 = To565(endpoint1);
+            if (colourBlock.colour0 < colourBlock.colour1) {
+                std::swap(colourBlock.colour0, colourBlock.colour1);
+            }
+            colourBlock.error = SelectIndices(block, Palette(colourBlock.colour0, colourBlock.colour1), colourBlock.indices);
+            if (colourBlock.colour0 == colourBlock.colour1) {
+                // Equal endpoints decode in three colour mode, where index 3 is transparent. Every palette entry is the same colour,
+                // so index 0 costs nothing.
+                colourBlock.indices.fill(0);
+            }
+            return colourBlock;
+        }
+
+        void EncodeColourBlock(Block const &block, CompressionQuality const quality, uint8_t *output) {
+            Colour endpoint0, endpoint1;
+            if (quality == CompressionQuality::Fast) {
+                BoundingBoxEndpoints(block, endpoint0, endpoint1);
+            } else {
+                PrincipalAxisEndpoints(block, endpoint0, endpoint1);
+            }
+            ColourBlock best{QuantiseColourBlock(block, endpoint0, endpoint1)};
+            if (quality == CompressionQuality::High) {
+                for (uint32_t iteration = 0; iteration < 2 && best.error > 0; ++iteration) {
+                    // Indices are relative to the quantised colour0, so the refined endpoint0 takes its place
+                    Colour refined0, refined1;
+                    if (!RefineEndpoints(block, best.indices, refined0, refined1)) {
+                        break;
+                    }
+                    ColourBlock const candidate{QuantiseColourBlock(block, refined0, refined1)};
+                    if (candidate.error >= best.error) {
+                        break;
+                    }
+                    best = candidate;
+                }
+            }
+
+            uint32_t indexBits{0};
+            for (uint32_t texelIdx = 0; texelIdx < 16; ++texelIdx) {
+                indexBits |= static_cast<uint32_t>(best.indices[texelIdx]) << (texelIdx * 2);
+            }
+            std::memcpy(output, &best.colour0, 2);
+            std::memcpy(output + 2, &best.colour1, 2);
+            std::memcpy(output + 4, &indexBits, 4);
+        }
+
+        // Eight value interpolated alpha (alpha0 > alpha1) between the block's extremes
+        void EncodeAlphaBlock(Block const &block, uint8_t *output) {
+            uint8_t minAlpha{255}, maxAlpha{0};
+            for (uint32_t texelIdx = 0; texelIdx < 16; ++texelIdx) {
+                minAlpha = std::min(minAlpha, block[texelIdx * 4 + 3]);
+                maxAlpha = std::max(maxAlpha, block[texelIdx * 4 + 3]);
+            }
+            output[0] = maxAlpha;
+            output[1] = minAlpha;
+            uint64_t indexBits{0};
+            if (maxAlpha > minAlpha) {
+                std::array<uint8_t, 8> palette{maxAlpha, minAlpha};
+                for (uint32_t entry = 1; entry < 7; ++entry) {
+                    palette[entry + 1] = static_cast<uint8_t>(((7 - entry) * maxAlpha + entry * minAlpha) / 7);
+                }
+                for (uint32_t texelIdx = 0; texelIdx < 16; ++texelIdx) {
+                    uint8_t const alpha{block[texelIdx * 4 + 3]};
+                    uint64_t bestEntry{0};
+                    int32_t bestError{INT32_MAX};
+                    for (uint32_t entry = 0; entry < 8; ++entry) {
+                        int32_t const error{std::abs(alpha - palette[entry])};
+                        if (error < bestError) {
+                            bestError = error;
+                            bestEntry = entry;
+                        }
+                    }
+                    indexBits |= bestEntry << (texelIdx * 3);
+                }
+            }
+            for (uint32_t byteIdx = 0; byteIdx < 6; ++byteIdx) {
+                output[2 + byteIdx] = static_cast<uint8_t>(indexBits >> (byteIdx * 8));
+            }
+        }
+    } // namespace
+
+    size_t BlockCompression::BlockSize(BlockFormat const format) {
+        switch (format) {
+        case BlockFormat::BC1:
+            return 8;
+        case BlockFormat::BC2:
+        case BlockFormat::BC3:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+
+    size_t BlockCompression::CompressedSize(BlockFormat const format, uint32_t const width, uint32_t const height) {
+        return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * BlockSize(format);
+    }
+
+    BlockFormat BlockCompression::ChooseFormat(std::vector<uint8_t> const &rgba) {
+        for (size_t alphaIdx = 3; alphaIdx < rgba.size(); alphaIdx += 4) {
+            if (rgba[alphaIdx] != 255) {
+                return BlockFormat::BC3;
+            }
+        }
+        return BlockFormat::BC1;
+    }
+
+    std::vector<uint8_t> BlockCompression::Encode(std::vector<uint8_t> const &rgba, uint32_t const width, uint32_t const height,
+                                                  BlockFormat const format, CompressionQuality const quality) {
+        if ((format != BlockFormat::BC1 && format != BlockFormat::BC3) || width == 0 || height == 0 ||
+            rgba.size() < static_cast<size_t>(width) * height * 4) {
+            return {};
+        }
+        uint32_t const blocksWide{(width + 3) / 4}, blocksHigh{(height + 3) / 4};
+        size_t const blockSize{BlockSize(format)};
+        std::vector<uint8_t> output(CompressedSize(format, width, height));
+        Block block;
+        for (uint32_t blockY = 0; blockY < blocksHigh; ++blockY) {
+            for (uint32_t blockX = 0; blockX < blocksWide; ++blockX) {
+                ExtractBlock(rgba, width, height, blockX, blockY, block);
+                uint8_t *const blockOutput{output.data() + (static_cast<size_t>(blockY) * blocksWide + blockX) * blockSize};
+                if (format == BlockFormat::BC3) {
+                    EncodeAlphaBlock(block, blockOutput);
+                    EncodeColourBlock(block, quality, blockOutput + 8);
+                } else {
+                    EncodeColourBlock(block, quality, blockOutput);
+                }
+            }
+        }
+        return output;
+    }
+
+    void BlockCompression::CompressTextures(TrackTextureTable &textureAssets, CompressionQuality const quality,
+                                            bool const dropPixels) {
+        std::vector<TrackTextureAsset *> textures;
+        for (auto &[id, textureAsset] : textureAssets) {
+            if (textureAsset.compressedFormat == BlockFormat::None && textureAsset.HasPixelData()) {
+                textures.push_back(&textureAsset);
+            }
+        }
+        Utils::ParallelFor(textures.size(), [&](size_t const textureIdx) {
+            TrackTextureAsset &textureAsset{*textures[textureIdx]};
+            // Lazily loaded DXT textures are already block compressed in their archive, so are copied without decoding
+            if (textureAsset.data.empty() && textureAsset.archive != nullptr) {
+                Shared::FshTexture const &fshTexture{textureAsset.archive->GetTexture(textureAsset.archiveIdx)};
+                std::span<uint8_t const> const blocks{fshTexture.DXTBlocks()};
+                if (!blocks.empty()) {
+                    textureAsset.compressedData.assign(blocks.begin(), blocks.end());
+                    textureAsset.compressedFormat =
+                        fshTexture.Format() == Shared::PixelFormat::DXT1 ? BlockFormat::BC1 : BlockFormat::BC2;
+                    return;
+                }
+            }
+            TextureCache::Pixels const pixels{textureAsset.Pixels()};
+            BlockFormat const format{ChooseFormat(*pixels)};
+            textureAsset.compressedData = Encode(*pixels, textureAsset.width, textureAsset.height, format, quality);
+            if (textureAsset.compressedData.empty()) {
+                return;
+            }
+            textureAsset.compressedFormat = format;
+            if (dropPixels) {
+                std::vector<uint8_t>().swap(textureAsset.data);
+            }
+        });
+
+        size_t nCompressed{0}, compressedBytes{0};
+        for (TrackTextureAsset const *textureAsset : textures) {
+            if (textureAsset->compressedFormat != BlockFormat::None) {
+                ++nCompressed;
+                compressedBytes += textureAsset->compressedData.size();
+            }
+        }
+        LogInfo("Block compressed %zu of %zu textures into %zu bytes", nCompressed, textures.size(), compressedBytes);
+    }
+} // namespace LibOpenNFS
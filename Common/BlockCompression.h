@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LibOpenNFS {
+    class TrackTextureTable;
+
+    enum class BlockFormat : uint8_t {
+        None,
+        BC1, // DXT1, 8 bytes per 4x4 block. Blocks encoded here are opaque, but DXT1 passed through from FSH can have 1-bit
+             // (punch-through) alpha in its three colour blocks, so sample it as RGBA (BC1A)
+        BC2, // DXT3, 16 bytes per 4x4 block, explicit 4-bit alpha (only passed through from FSH, never encoded)
+        BC3, // DXT5, 16 bytes per 4x4 block, interpolated alpha
+    };
+
+    enum class CompressionQuality : uint8_t {
+        Fast,   // Bounding box endpoints
+        Normal, // Principal axis endpoints
+        High,   // Principal axis endpoints refined by least squares
+    };
+
+    // BC1/BC3 encoder for RGBA8 pixels. Blocks are stored row by row, and images whose size isn't a multiple of 4 have their
+    // partial blocks padded by repeating the last row/column. Colour indices are chosen by nearest (squared RGB distance) palette
+    // entry, with SSE2 where available.
+    class BlockCompression {
+      public:
+        static size_t BlockSize(BlockFormat format);
+        static size_t CompressedSize(BlockFormat format, uint32_t width, uint32_t height);
+
+        // BC3 if any pixel isn't fully opaque, BC1 otherwise
+        static BlockFormat ChooseFormat(std::vector<uint8_t> const &rgba);
+        static std::vector<uint8_t> Encode(std::vector<uint8_t> const &rgba, uint32_t width, uint32_t height, BlockFormat format,
+                                           CompressionQuality quality = CompressionQuality::Normal);
+
+        // Fill TrackTextureAsset::compressedData/compressedFormat of every texture with pixel data, in parallel over textures.
+        // Lazily loaded textures whose FSH source is DXT1/DXT3 take its blocks as BC1 (keeping any 1-bit alpha) or BC2 without
+        // decoding. Textures that are already compressed are skipped. With dropPixels, TrackTextureAsset::data is freed once
+        // compressed. If decoding a texture throws, the first exception is rethrown once every texture has been attempted.
+        static void CompressTextures(TrackTextureTable &textureAssets,
+                                     CompressionQuality quality = CompressionQuality::Normal, bool dropPixels = false);
+    };
+} // namespace LibOpenNFS
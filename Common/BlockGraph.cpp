@@ -0,0 +1,107 @@
+#include "BlockGraph.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "Logging.h"
+#include "Parallel.h"
+
+namespace LibOpenNFS {
+    BlockGraph BlockGraph::Build(std::vector<TrackBlock> const &trackBlocks, uint32_t const maxHops) {
+        BlockGraph graph;
+        graph.m_nBlocks = static_cast<uint32_t>(trackBlocks.size());
+        graph.m_maxHops = std::min<uint32_t>(maxHops, kUnreachable - 1);
+
+        // Neighbours are stored as block IDs, which don't have to match the block's position in trackBlocks
+        std::unordered_map<uint32_t, uint32_t> blockIndices;
+        for (uint32_t blockIdx = 0; blockIdx < graph.m_nBlocks; ++blockIdx) {
+            blockIndices.emplace(trackBlocks[blockIdx].id, blockIdx);
+        }
+        std::vector<std::vector<uint32_t>> adjacency(graph.m_nBlocks);
+        size_t nUnknownNeighbours{0};
+        for (uint32_t blockIdx = 0; blockIdx < graph.m_nBlocks; ++blockIdx) {
+            for (uint32_t const neighbourId : trackBlocks[blockIdx].neighbourIds) {
+                auto const neighbourIt{blockIndices.find(neighbourId)};
+                if (neighbourIt == blockIndices.end()) {
+                    ++nUnknownNeighbours;
+                    continue;
+                }
+                if (neighbourIt->second == blockIdx) {
+                    continue;
+                }
+                adjacency[blockIdx].push_back(neighbourIt->second);
+                adjacency[neighbourIt->second].push_back(blockIdx);
+            }
+        }
+        if (nUnknownNeighbours > 0) {
+            LogWarning("Ignored %zu neighbour references to blocks that don't exist", nUnknownNeighbours);
+        }
+        graph.m_adjacencyStart.reserve(graph.m_nBlocks + 1);
+        graph.m_adjacencyStart.push_back(0);
+        for (auto &neighbours : adjacency) {
+            std::sort(neighbours.begin(), neighbours.end());
+            neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+            graph.m_adjacency.insert(graph.m_adjacency.end(), neighbours.begin(), neighbours.end());
+            graph.m_adjacencyStart.push_back(static_cast<uint32_t>(graph.m_adjacency.size()));
+        }
+
+        // A BFS from every block fills its row of the distance table, and its nearby set in order of distance
+        uint32_t const nearbyStride{graph.m_maxHops + 2};
+        graph.m_distances.assign(static_cast<size_t>(graph.m_nBlocks) * graph.m_nBlocks, kUnreachable);
+        std::vector<std::vector<uint32_t>> nearby(graph.m_nBlocks);
+        std::vector<std::vector<uint32_t>> nearbyHopEnds(graph.m_nBlocks);
+        Utils::ParallelFor(graph.m_nBlocks, [&](size_t const sourceIdx) {
+            uint16_t *const distances{graph.m_distances.data() + sourceIdx * graph.m_nBlocks};
+            std::vector<uint32_t> queue{static_cast<uint32_t>(sourceIdx)};
+            distances[sourceIdx] = 0;
+            std::vector<uint32_t> &hopEnds{nearbyHopEnds[sourceIdx]};
+            for (size_t queueIdx = 0; queueIdx < queue.size(); ++queueIdx) {
+                uint32_t const blockIdx{queue[queueIdx]};
+                uint16_t const distance{distances[blockIdx]};
+                // BFS visits blocks in order of distance, so the nearby set is the queue up to the last block within maxHops
+                while (hopEnds.size() < distance && hopEnds.size() <= graph.m_maxHops) {
+                    hopEnds.push_back(static_cast<uint32_t>(queueIdx));
+                }
+                if (distance == kUnreachable - 1) {
+                    continue;
+                }
+                for (uint32_t adjacencyIdx = graph.m_adjacencyStart[blockIdx]; adjacencyIdx < graph.m_adjacencyStart[blockIdx + 1];
+                     ++adjacencyIdx) {
+                    uint32_t const neighbourIdx{graph.m_adjacency[adjacencyIdx]};
+                    if (distances[neighbourIdx] == kUnreachable) {
+                        distances[neighbourIdx] = distance + 1;
+                        queue.push_back(neighbourIdx);
+                    }
+                }
+            }
+            while (hopEnds.size() <= graph.m_maxHops) {
+                hopEnds.push_back(static_cast<uint32_t>(queue.size()));
+            }
+            queue.resize(hopEnds.back());
+            nearby[sourceIdx] = std::move(queue);
+        });
+
+        graph.m_nearbyStart.reserve(static_cast<size_t>(graph.m_nBlocks) * nearbyStride);
+        for (uint32_t blockIdx = 0; blockIdx < graph.m_nBlocks; ++blockIdx) {
+            auto const base{static_cast<uint32_t>(graph.m_nearby.size())};
+            graph.m_nearbyStart.push_back(base);
+            for (uint32_t const hopEnd : nearbyHopEnds[blockIdx]) {
+                graph.m_nearbyStart.push_back(base + hopEnd);
+            }
+            graph.m_nearby.insert(graph.m_nearby.end(), nearby[blockIdx].begin(), nearby[blockIdx].end());
+        }
+        LogInfo("Built block graph over %u blocks (%zu edges), nearby sets within %u hops hold %zu blocks", graph.m_nBlocks,
+                graph.m_adjacency.size() / 2, graph.m_maxHops, graph.m_nearby.size());
+
+        return graph;
+    }
+
+    std::span<uint32_t const> BlockGraph::Neighbours(uint32_t const blockIdx) const {
+        return {m_adjacency.data() + m_adjacencyStart[blockIdx], m_adjacency.data() + m_adjacencyStart[blockIdx + 1]};
+    }
+
+    std::span<uint32_t const> BlockGraph::WithinHops(uint32_t const blockIdx, uint32_t const hops) const {
+        size_t const base{static_cast<size_t>(blockIdx) * (m_maxHops + 2)};
+        return {m_nearby.data() + m_nearbyStart[base], m_nearby.data() + m_nearbyStart[base + std::min(hops, m_maxHops) + 1]};
+    }
+} // namespace LibOpenNFS
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "Entities/TrackBlock.h"
+
+namespace LibOpenNFS {
+    // Undirected adjacency graph of a Track's blocks from TrackBlock::neighbourIds, in compressed sparse row form, with the hop
+    // distance between every pair of blocks and, per block, every block within maxHops of it. Blocks are addressed by their
+    // index into Track::trackBlocks.
+    class BlockGraph {
+      public:
+        static constexpr uint16_t kUnreachable{UINT16_MAX};
+
+        BlockGraph() = default;
+        // maxHops bounds the per block sets returned by WithinHops, the distance table always covers the whole track
+        static BlockGraph Build(std::vector<TrackBlock> const &trackBlocks, uint32_t maxHops = 4);
+
+        std::span<uint32_t const> Neighbours(uint32_t blockIdx) const;
+        // Blocks at most hops (clamped to maxHops) away from blockIdx, nearest first, starting with blockIdx itself. Suitable as a
+        // coarse visibility set for rendering, or the set of blocks to keep resident when streaming.
+        std::span<uint32_t const> WithinHops(uint32_t blockIdx, uint32_t hops) const;
+        uint16_t Distance(uint32_t fromBlockIdx, uint32_t toBlockIdx) const {
+            return m_distances[static_cast<size_t>(fromBlockIdx) * m_nBlocks + toBlockIdx];
+        }
+
+        uint32_t BlockCount() const {
+            return m_nBlocks;
+        }
+        uint32_t MaxHops() const {
+            return m_maxHops;
+        }
+
+      private:
+        uint32_t m_nBlocks{0};
+        uint32_t m_maxHops{0};
+        // Neighbours of block b are m_adjacency[m_adjacencyStart[b], m_adjacencyStart[b + 1])
+        std::vector<uint32_t> m_adjacencyStart;
+        std::vector<uint32_t> m_adjacency;
+        // Row major nBlocks x nBlocks hop distances
+        std::vector<uint16_t> m_distances;
+        // Blocks within h hops of block b are m_nearby[m_nearbyStart[b * (maxHops + 2)], m_nearbyStart[b * (maxHops + 2) + h + 1])
+        std::vector<uint32_t> m_nearbyStart;
+        std::vector<uint32_t> m_nearby;
+    };
+} // namespace LibOpenNFS
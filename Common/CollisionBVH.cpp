@@ -0,0 +1,408 @@
+#include "CollisionBVH.h"
+
+#include <array>
+
+#include "GeometryUtils.h"
+#include "Logging.h"
+#include "Parallel.h"
+
+namespace LibOpenNFS {
+    namespace {
+        constexpr uint32_t kMaxLeafTriangles{4};
+        // Block trees are grafted below the leaves of the top level tree, so the merged tree can be up to twice as deep
+        constexpr uint32_t kMaxStackDepth{2 * BVHBuilder::kMaxDepth + 2};
+
+        using Node = CollisionBVH::Node;
+        using Triangle = CollisionBVH::Triangle;
+
+        AABB TriangleBounds(Triangle const &triangle) {
+            AABB bounds;
+            bounds.Extend(triangle.v0);
+            bounds.Extend(triangle.v0 + triangle.edge1);
+            bounds.Extend(triangle.v0 + triangle.edge2);
+            return bounds;
+        }
+
+        struct BlockBVH {
+            std::vector<Node> nodes;
+            std::vector<Triangle> triangles;
+        };
+
+        void CollectTriangles(std::vector<TrackEntity> const &entities, uint32_t const blockId, std::vector<Triangle> &triangles) {
+            for (auto const &entity : entities) {
+                if (!entity.collidable || !entity.hasGeometry) {
+                    continue;
+                }
+                TrackGeometry const &mesh{entity.Mesh()};
+                GeometryUtils::ForEachWorldTriangle(entity, [&](glm::vec3 const &v0, glm::vec3 const &v1, glm::vec3 const &v2,
+                                                                uint32_t const i0, uint32_t, uint32_t) {
+                    uint32_t const textureId{i0 < mesh.m_textureIndices.size() ? mesh.m_textureIndices[i0] : 0u};
+                    triangles.push_back({v0, v1 - v0, v2 - v0, blockId, entity.entityID, textureId});
+                });
+            }
+        }
+
+        BlockBVH BuildBlockBVH(std::vector<Triangle> &&triangles) {
+            BlockBVH blockBVH;
+            std::vector<AABB> triangleBounds(triangles.size());
+            std::vector<uint32_t> triangleOrder(triangles.size());
+            for (uint32_t triIdx = 0; triIdx < triangles.size(); ++triIdx) {
+                triangleBounds[triIdx] = TriangleBounds(triangles[triIdx]);
+                triangleOrder[triIdx] = triIdx;
+            }
+            blockBVH.nodes = BVHBuilder::Build(triangleBounds, triangleOrder, kMaxLeafTriangles);
+            blockBVH.triangles.reserve(triangles.size());
+            for (uint32_t const triIdx : triangleOrder) {
+                blockBVH.triangles.push_back(triangles[triIdx]);
+            }
+            return blockBVH;
+        }
+
+        // Möller-Trumbore, two sided
+        bool IntersectTriangle(Triangle const &triangle, glm::vec3 const &origin, glm::vec3 const &direction, float &t) {
+            glm::vec3 const pVec{glm::cross(direction, triangle.edge2)};
+            float const det{glm::dot(triangle.edge1, pVec)};
+            if (std::abs(det) < 1e-12f) {
+                return false;
+            }
+            float const invDet{1.f / det};
+            glm::vec3 const tVec{origin - triangle.v0};
+            float const u{glm::dot(tVec, pVec) * invDet};
+            if (u < 0.f || u > 1.f) {
+                return false;
+            }
+            glm::vec3 const qVec{glm::cross(tVec, triangle.edge1)};
+            float const v{glm::dot(direction, qVec) * invDet};
+            if (v < 0.f || u + v > 1.f) {
+                return false;
+            }
+            t = glm::dot(triangle.edge2, qVec) * invDet;
+            return t >= 0.f;
+        }
+
+        // Ericson, Real-Time Collision Detection 5.1.5
+        glm::vec3 ClosestPointOnTriangle(Triangle const &triangle, glm::vec3 const &point) {
+            glm::vec3 const &a{triangle.v0};
+            glm::vec3 const &ab{triangle.edge1};
+            glm::vec3 const &ac{triangle.edge2};
+            glm::vec3 const ap{point - a};
+            float const d1{glm::dot(ab, ap)}, d2{glm::dot(ac, ap)};
+            if (d1 <= 0.f && d2 <= 0.f) {
+                return a;
+            }
+            glm::vec3 const bp{ap - ab};
+            float const d3{glm::dot(ab, bp)}, d4{glm::dot(ac, bp)};
+            if (d3 >= 0.f && d4 <= d3) {
+                return a + ab;
+            }
+            float const vc{d1 * d4 - d3 * d2};
+            if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f) {
+                return a + ab * (d1 / (d1 - d3));
+            }
+            glm::vec3 const cp{ap - ac};
+            float const d5{glm::dot(ab, cp)}, d6{glm::dot(ac, cp)};
+            if (d6 >= 0.f && d5 <= d6) {
+                return a + ac;
+            }
+            float const vb{d5 * d2 - d1 * d6};
+            if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f) {
+                return a + ac * (d2 / (d2 - d6));
+            }
+            float const va{d3 * d6 - d5 * d4};
+            if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f) {
+                return a + ab + (ac - ab) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+            }
+            float const denom{1.f / (va + vb + vc)};
+            return a + ab * (vb * denom) + ac * (vc * denom);
+        }
+
+        // Distance along a normalised ray to a sphere, or -1 on a miss
+        float IntersectSphere(glm::vec3 const &origin, glm::vec3 const &direction, glm::vec3 const &centre, float const radius) {
+            glm::vec3 const oc{origin - centre};
+            float const b{glm::dot(direction, oc)};
+            float const h{b * b - (glm::dot(oc, oc) - radius * radius)};
+            return h >= 0.f ? -b - std::sqrt(h) : -1.f;
+        }
+
+        // Distance along a normalised ray to a capsule (segment a-b swept by radius), or -1 on a miss. Inigo Quilez's formulation.
+        float IntersectCapsule(glm::vec3 const &origin, glm::vec3 const &direction, glm::vec3 const &a, glm::vec3 const &b, float const radius) {
+            glm::vec3 const ba{b - a};
+            glm::vec3 const oa{origin - a};
+            float const baba{glm::dot(ba, ba)};
+            float const bard{glm::dot(ba, direction)};
+            float const baoa{glm::dot(ba, oa)};
+            float const rdoa{glm::dot(direction, oa)};
+            float const oaoa{glm::dot(oa, oa)};
+            float const qa{baba - bard * bard};
+            float const qb{baba * rdoa - baoa * bard};
+            float const qc{baba * oaoa - baoa * baoa - radius * radius * baba};
+            float const h{qb * qb - qa * qc};
+            if (h < 0.f) {
+                return -1.f;
+            }
+            if (qa <= 1e-12f) {
+                // Ray parallel to the segment, only the end caps can be hit first
+                float const tA{IntersectSphere(origin, direction, a, radius)};
+                float const tB{IntersectSphere(origin, direction, b, radius)};
+                if (tA < 0.f || tB < 0.f) {
+                    return std::max(tA, tB);
+                }
+                return std::min(tA, tB);
+            }
+            float const t{(-qb - std::sqrt(h)) / qa};
+            float const y{baoa + t * bard};
+            if (y > 0.f && y < baba) {
+                return t;
+            }
+            return IntersectSphere(origin, direction, y <= 0.f ? a : b, radius);
+        }
+
+        glm::vec3 SafeInverse(glm::vec3 const &direction) {
+            glm::vec3 inverse;
+            for (int axis = 0; axis < 3; ++axis) {
+                float const component{std::abs(direction[axis]) < 1e-20f ? std::copysign(1e-20f, direction[axis]) : direction[axis]};
+                inverse[axis] = 1.f / component;
+            }
+            return inverse;
+        }
+    } // namespace
+
+    CollisionBVH CollisionBVH::Build(Track const &track) {
+        // One group of collidable entities per block, with global objects as a final group
+        size_t const nGroups{track.trackBlocks.size() + 1};
+        std::vector<BlockBVH> blockBVHs(nGroups);
+        Utils::ParallelFor(nGroups, [&](size_t const groupIdx) {
+            std::vector<Triangle> triangles;
+            if (groupIdx < track.trackBlocks.size()) {
+                TrackBlock const &trackBlock{track.trackBlocks[groupIdx]};
+                CollectTriangles(trackBlock.track, trackBlock.id, triangles);
+                CollectTriangles(trackBlock.objects, trackBlock.id, triangles);
+                CollectTriangles(trackBlock.lanes, trackBlock.id, triangles);
+            } else {
+                CollectTriangles(track.globalObjects, UINT32_MAX, triangles);
+            }
+            blockBVHs[groupIdx] = BuildBlockBVH(std::move(triangles));
+        });
+
+        // Top level tree with a single block per leaf
+        std::vector<AABB> blockBounds(nGroups);
+        std::vector<uint32_t> blockOrder;
+        for (uint32_t groupIdx = 0; groupIdx < nGroups; ++groupIdx) {
+            if (!blockBVHs[groupIdx].nodes.empty()) {
+                blockBounds[groupIdx] = blockBVHs[groupIdx].nodes.front().Bounds();
+                blockOrder.push_back(groupIdx);
+            }
+        }
+        CollisionBVH bvh;
+        bvh.m_nodes = BVHBuilder::Build(blockBounds, blockOrder, 1);
+
+        // Graft each block's tree in place of its top level leaf: the block root takes over the leaf's slot, the rest is appended
+        size_t const nTopLevelNodes{bvh.m_nodes.size()};
+        for (size_t topNodeIdx = 0; topNodeIdx < nTopLevelNodes; ++topNodeIdx) {
+            if (bvh.m_nodes[topNodeIdx].nPrimitives == 0) {
+                continue;
+            }
+            BlockBVH const &blockBVH{blockBVHs[blockOrder[bvh.m_nodes[topNodeIdx].leftOrFirst]]};
+            auto const nodeBase{static_cast<uint32_t>(bvh.m_nodes.size()) - 1};
+            auto const triangleBase{static_cast<uint32_t>(bvh.m_triangles.size())};
+            auto remapNode = [&](Node node) {
+                node.leftOrFirst = node.nPrimitives > 0 ? node.leftOrFirst + triangleBase : node.leftOrFirst + nodeBase;
+                return node;
+            };
+            bvh.m_nodes[topNodeIdx] = remapNode(blockBVH.nodes.front());
+            for (size_t nodeIdx = 1; nodeIdx < blockBVH.nodes.size(); ++nodeIdx) {
+                bvh.m_nodes.push_back(remapNode(blockBVH.nodes[nodeIdx]));
+            }
+            bvh.m_triangles.insert(bvh.m_triangles.end(), blockBVH.triangles.begin(), blockBVH.triangles.end());
+        }
+        LogInfo("Built collision BVH over %zu triangles in %zu blocks (%zu nodes)", bvh.m_triangles.size(), blockOrder.size(),
+                bvh.m_nodes.size());
+
+        return bvh;
+    }
+
+    bool CollisionBVH::Raycast(glm::vec3 const &origin, glm::vec3 const &direction, float const maxDistance, Hit &hit) const {
+        if (m_nodes.empty()) {
+            return false;
+        }
+        glm::vec3 const rayDirection{glm::normalize(direction)};
+        glm::vec3 const invDirection{SafeInverse(rayDirection)};
+        float closest{maxDistance};
+        bool found{false};
+
+        std::array<std::pair<uint32_t, float>, kMaxStackDepth> stack;
+        uint32_t stackSize{0};
+        float tRoot;
+        if (!m_nodes[0].Bounds().IntersectRay(origin, invDirection, closest, tRoot)) {
+            return false;
+        }
+        stack[stackSize++] = {0, tRoot};
+        while (stackSize > 0) {
+            auto const [nodeIdx, tEntry] = stack[--stackSize];
+            if (tEntry > closest) {
+                continue;
+            }
+            Node const &node{m_nodes[nodeIdx]};
+            if (node.nPrimitives > 0) {
+                for (uint32_t triIdx = node.leftOrFirst; triIdx < node.leftOrFirst + node.nPrimitives; ++triIdx) {
+                    float t;
+                    if (IntersectTriangle(m_triangles[triIdx], origin, rayDirection, t) && t <= closest) {
+                        closest = t;
+                        hit.triangleIdx = triIdx;
+                        found = true;
+                    }
+                }
+                continue;
+            }
+            // Visit the nearer child first
+            float tLeft, tRight;
+            bool const hitLeft{m_nodes[node.leftOrFirst].Bounds().IntersectRay(origin, invDirection, closest, tLeft)};
+            bool const hitRight{m_nodes[node.leftOrFirst + 1].Bounds().IntersectRay(origin, invDirection, closest, tRight)};
+            if (hitLeft && hitRight) {
+                bool const leftFirst{tLeft <= tRight};
+                stack[stackSize++] = leftFirst ? std::pair{node.leftOrFirst + 1, tRight} : std::pair{node.leftOrFirst, tLeft};
+                stack[stackSize++] = leftFirst ? std::pair{node.leftOrFirst, tLeft} : std::pair{node.leftOrFirst + 1, tRight};
+            } else if (hitLeft) {
+                stack[stackSize++] = {node.leftOrFirst, tLeft};
+            } else if (hitRight) {
+                stack[stackSize++] = {node.leftOrFirst + 1, tRight};
+            }
+        }
+        if (found) {
+            Triangle const &triangle{m_triangles[hit.triangleIdx]};
+            hit.distance = closest;
+            hit.position = origin + rayDirection * closest;
+            hit.normal = glm::normalize(glm::cross(triangle.edge1, triangle.edge2));
+            if (glm::dot(hit.normal, rayDirection) > 0.f) {
+                hit.normal = -hit.normal;
+            }
+        }
+        return found;
+    }
+
+    bool CollisionBVH::SphereSweep(glm::vec3 const &origin, glm::vec3 const &direction, float const radius, float const maxDistance,
+                                   Hit &hit) const {
+        if (m_nodes.empty()) {
+            return false;
+        }
+        glm::vec3 const sweepDirection{glm::normalize(direction)};
+        glm::vec3 const invDirection{SafeInverse(sweepDirection)};
+        float closest{maxDistance};
+        bool found{false};
+
+        std::array<uint32_t, kMaxStackDepth> stack;
+        uint32_t stackSize{0};
+        stack[stackSize++] = 0;
+        while (stackSize > 0) {
+            Node const &node{m_nodes[stack[--stackSize]]};
+            float tEntry;
+            // Sweeping a sphere against a box is conservatively a ray against the box grown by the radius
+            if (!node.Bounds().Expanded(radius).IntersectRay(origin, invDirection, closest, tEntry)) {
+                continue;
+            }
+            if (node.nPrimitives == 0) {
+                stack[stackSize++] = node.leftOrFirst + 1;
+                stack[stackSize++] = node.leftOrFirst;
+                continue;
+            }
+            for (uint32_t triIdx = node.leftOrFirst; triIdx < node.leftOrFirst + node.nPrimitives; ++triIdx) {
+                Triangle const &triangle{m_triangles[triIdx]};
+                float t{-1.f};
+                glm::vec3 const startClosest{ClosestPointOnTriangle(triangle, origin)};
+                if (glm::dot(startClosest - origin, startClosest - origin) <= radius * radius) {
+                    t = 0.f;
+                } else {
+                    // Face interior: the sphere touches the plane when its centre is radius away from it
+                    glm::vec3 normal{glm::normalize(glm::cross(triangle.edge1, triangle.edge2))};
+                    float planeDistance{glm::dot(origin - triangle.v0, normal)};
+                    if (planeDistance < 0.f) {
+                        normal = -normal;
+                        planeDistance = -planeDistance;
+                    }
+                    float const approachSpeed{-glm::dot(sweepDirection, normal)};
+                    if (approachSpeed > 0.f) {
+                        float const tPlane{(planeDistance - radius) / approachSpeed};
+                        glm::vec3 const contact{origin + sweepDirection * tPlane - normal * radius};
+                        glm::vec3 const contactOffset{ClosestPointOnTriangle(triangle, contact) - contact};
+                        if (glm::dot(contactOffset, contactOffset) < 1e-8f) {
+                            t = tPlane;
+                        }
+                    }
+                    // Edges and vertices
+                    glm::vec3 const corners[3]{triangle.v0, triangle.v0 + triangle.edge1, triangle.v0 + triangle.edge2};
+                    for (uint32_t edge = 0; edge < 3; ++edge) {
+                        float const tEdge{IntersectCapsule(origin, sweepDirection, corners[edge], corners[(edge + 1) % 3], radius)};
+                        if (tEdge >= 0.f && (t < 0.f || tEdge < t)) {
+                            t = tEdge;
+                        }
+                    }
+                }
+                if (t >= 0.f && t <= closest) {
+                    closest = t;
+                    hit.triangleIdx = triIdx;
+                    found = true;
+                }
+            }
+        }
+        if (found) {
+            glm::vec3 const centre{origin + sweepDirection * closest};
+            hit.distance = closest;
+            hit.position = ClosestPointOnTriangle(m_triangles[hit.triangleIdx], centre);
+            glm::vec3 const separation{centre - hit.position};
+            float const separationLength{glm::length(separation)};
+            hit.normal = separationLength > 0.f ? separation / separationLength
+                                                : glm::normalize(glm::cross(m_triangles[hit.triangleIdx].edge1, m_triangles[hit.triangleIdx].edge2));
+        }
+        return found;
+    }
+
+    bool CollisionBVH::ClosestPoint(glm::vec3 const &point, float const maxDistance, Hit &hit) const {
+        if (m_nodes.empty()) {
+            return false;
+        }
+        float closestSquared{maxDistance * maxDistance};
+        bool found{false};
+
+        std::array<std::pair<uint32_t, float>, kMaxStackDepth> stack;
+        uint32_t stackSize{0};
+        stack[stackSize++] = {0, m_nodes[0].Bounds().DistanceSquared(point)};
+        while (stackSize > 0) {
+            auto const [nodeIdx, nodeDistanceSquared] = stack[--stackSize];
+            if (nodeDistanceSquared > closestSquared) {
+                continue;
+            }
+            Node const &node{m_nodes[nodeIdx]};
+            if (node.nPrimitives > 0) {
+                for (uint32_t triIdx = node.leftOrFirst; triIdx < node.leftOrFirst + node.nPrimitives; ++triIdx) {
+                    glm::vec3 const candidate{ClosestPointOnTriangle(m_triangles[triIdx], point)};
+                    float const distanceSquared{glm::dot(candidate - point, candidate - point)};
+                    if (distanceSquared <= closestSquared) {
+                        closestSquared = distanceSquared;
+                        hit.position = candidate;
+                        hit.triangleIdx = triIdx;
+                        found = true;
+                    }
+                }
+                continue;
+            }
+            float const leftDistance{m_nodes[node.leftOrFirst].Bounds().DistanceSquared(point)};
+            float const rightDistance{m_nodes[node.leftOrFirst + 1].Bounds().DistanceSquared(point)};
+            bool const leftFirst{leftDistance <= rightDistance};
+            stack[stackSize++] = leftFirst ? std::pair{node.leftOrFirst + 1, rightDistance} : std::pair{node.leftOrFirst, leftDistance};
+            stack[stackSize++] = leftFirst ? std::pair{node.leftOrFirst, leftDistance} : std::pair{node.leftOrFirst + 1, rightDistance};
+        }
+        if (found) {
+            Triangle const &triangle{m_triangles[hit.triangleIdx]};
+            hit.distance = std::sqrt(closestSquared);
+            hit.normal = glm::normalize(glm::cross(triangle.edge1, triangle.edge2));
+            if (glm::dot(hit.normal, point - hit.position) < 0.f) {
+                hit.normal = -hit.normal;
+            }
+        }
+        return found;
+    }
+
+    AABB CollisionBVH::Bounds() const {
+        return m_nodes.empty() ? AABB() : m_nodes.front().Bounds();
+    }
+} // namespace LibOpenNFS
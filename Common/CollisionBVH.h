@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+#include "AABB.h"
+#include "BVHBuilder.h"
+#include "Entities/Track.h"
+
+namespace LibOpenNFS {
+    // Bounding volume hierarchy over the world space triangles of every collidable TrackEntity in a Track. Built with binned SAH,
+    // per TrackBlock in parallel, then merged under a top level tree over the blocks into a single flat node array.
+    class CollisionBVH {
+      public:
+        using Node = BVHNode;
+        struct Triangle {
+            glm::vec3 v0;
+            glm::vec3 edge1; // v1 - v0
+            glm::vec3 edge2; // v2 - v0
+            uint32_t blockId;
+            uint32_t entityId;
+            uint32_t textureId; // Lets physics tell road surfaces apart
+        };
+        struct Hit {
+            float distance{0.f};
+            glm::vec3 position{0.f};
+            // Geometric normal, facing the query origin
+            glm::vec3 normal{0.f};
+            uint32_t triangleIdx{0};
+        };
+
+        CollisionBVH() = default;
+        static CollisionBVH Build(Track const &track);
+
+        // Nearest triangle hit along the ray within maxDistance, triangles are two sided
+        bool Raycast(glm::vec3 const &origin, glm::vec3 const &direction, float maxDistance, Hit &hit) const;
+        // First contact of a sphere moving from origin along direction, hit.position is the contact point on the triangle and
+        // hit.distance how far the sphere centre travelled (0 if it starts overlapping)
+        bool SphereSweep(glm::vec3 const &origin, glm::vec3 const &direction, float radius, float maxDistance, Hit &hit) const;
+        // Closest point on any triangle within maxDistance of point
+        bool ClosestPoint(glm::vec3 const &point, float maxDistance, Hit &hit) const;
+
+        Triangle const &GetTriangle(uint32_t const triangleIdx) const {
+            return m_triangles[triangleIdx];
+        }
+        AABB Bounds() const;
+        std::vector<Node> const &Nodes() const {
+            return m_nodes;
+        }
+        std::vector<Triangle> const &Triangles() const {
+            return m_triangles;
+        }
+
+      private:
+        std::vector<Node> m_nodes;
+        std::vector<Triangle> m_triangles;
+    };
+} // namespace LibOpenNFS
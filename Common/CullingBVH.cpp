@@ -0,0 +1,123 @@
+#include "CullingBVH.h"
+
+namespace LibOpenNFS {
+    namespace {
+        // Blocks are few and their bounds overlap heavily, a single block per leaf keeps queries exact
+        constexpr uint32_t kMaxLeafBlocks{1};
+        constexpr uint32_t kAllPlanes{(1u << 6) - 1};
+    } // namespace
+
+    CullingBVH CullingBVH::Build(std::vector<TrackBlock> const &trackBlocks) {
+        CullingBVH bvh;
+        std::vector<AABB> blockBounds;
+        blockBounds.reserve(trackBlocks.size());
+        for (uint32_t blockIdx = 0; blockIdx < trackBlocks.size(); ++blockIdx) {
+            blockBounds.push_back(trackBlocks[blockIdx].bounds);
+            if (trackBlocks[blockIdx].bounds.IsValid()) {
+                bvh.m_blockOrder.push_back(blockIdx);
+            }
+        }
+        bvh.m_nodes = BVHBuilder::Build(blockBounds, bvh.m_blockOrder, kMaxLeafBlocks);
+
+        return bvh;
+    }
+
+    CullingBVH::Frustum CullingBVH::ExtractFrustum(glm::mat4 const &viewProjection) {
+        // Rows of the (column major) matrix
+        std::array<glm::vec4, 4> rows;
+        for (int row = 0; row < 4; ++row) {
+            rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]);
+        }
+        Frustum frustum{rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1], rows[3] - rows[1], rows[3] + rows[2], rows[3] - rows[2]};
+        for (auto &plane : frustum) {
+            float const normalLength{glm::length(glm::vec3(plane))};
+            if (normalLength > 0.f) {
+                plane /= normalLength;
+            }
+        }
+        return frustum;
+    }
+
+    void CullingBVH::Query(Frustum const &frustum, std::vector<uint32_t> &visibleBlocks) const {
+        if (m_nodes.empty()) {
+            return;
+        }
+        // Each entry carries the planes its parent was not already fully inside of
+        std::array<std::pair<uint32_t, uint32_t>, BVHBuilder::kMaxDepth + 2> stack;
+        uint32_t stackSize{0};
+        stack[stackSize++] = {0, kAllPlanes};
+        while (stackSize > 0) {
+            auto [nodeIdx, planeMask] = stack[--stackSize];
+            BVHNode const &node{m_nodes[nodeIdx]};
+            glm::vec3 const center{(node.min + node.max) * 0.5f};
+            glm::vec3 const halfExtent{(node.max - node.min) * 0.5f};
+            bool outside{false};
+            for (uint32_t planeIdx = 0; planeIdx < frustum.size() && !outside; ++planeIdx) {
+                if ((planeMask & (1u << planeIdx)) == 0) {
+                    continue;
+                }
+                glm::vec3 const normal{frustum[planeIdx]};
+                float const distance{glm::dot(normal, center) + frustum[planeIdx].w};
+                float const radius{glm::dot(glm::abs(normal), halfExtent)};
+                if (distance < -radius) {
+                    outside = true;
+                } else if (distance >= radius) {
+                    planeMask &= ~(1u << planeIdx);
+                }
+            }
+            if (outside) {
+                continue;
+            }
+            if (planeMask == 0) {
+                _AppendSubtree(nodeIdx, visibleBlocks);
+            } else if (node.nPrimitives > 0) {
+                for (uint32_t primIdx = node.leftOrFirst; primIdx < node.leftOrFirst + node.nPrimitives; ++primIdx) {
+                    visibleBlocks.push_back(m_blockOrder[primIdx]);
+                }
+            } else {
+                stack[stackSize++] = {node.leftOrFirst + 1, planeMask};
+                stack[stackSize++] = {node.leftOrFirst, planeMask};
+            }
+        }
+    }
+
+    void CullingBVH::Query(AABB const &region, std::vector<uint32_t> &overlappingBlocks) const {
+        if (m_nodes.empty()) {
+            return;
+        }
+        std::array<uint32_t, BVHBuilder::kMaxDepth + 2> stack;
+        uint32_t stackSize{0};
+        stack[stackSize++] = 0;
+        while (stackSize > 0) {
+            BVHNode const &node{m_nodes[stack[--stackSize]]};
+            if (!node.Bounds().Intersects(region)) {
+                continue;
+            }
+            if (node.nPrimitives > 0) {
+                for (uint32_t primIdx = node.leftOrFirst; primIdx < node.leftOrFirst + node.nPrimitives; ++primIdx) {
+                    overlappingBlocks.push_back(m_blockOrder[primIdx]);
+                }
+            } else {
+                stack[stackSize++] = node.leftOrFirst + 1;
+                stack[stackSize++] = node.leftOrFirst;
+            }
+        }
+    }
+
+    void CullingBVH::_AppendSubtree(uint32_t const nodeIdx, std::vector<uint32_t> &blocks) const {
+        std::array<uint32_t, BVHBuilder::kMaxDepth + 2> stack;
+        uint32_t stackSize{0};
+        stack[stackSize++] = nodeIdx;
+        while (stackSize > 0) {
+            BVHNode const &node{m_nodes[stack[--stackSize]]};
+            if (node.nPrimitives > 0) {
+                for (uint32_t primIdx = node.leftOrFirst; primIdx < node.leftOrFirst + node.nPrimitives; ++primIdx) {
+                    blocks.push_back(m_blockOrder[primIdx]);
+                }
+            } else {
+                stack[stackSize++] = node.leftOrFirst + 1;
+                stack[stackSize++] = node.leftOrFirst;
+            }
+        }
+    }
+} // namespace LibOpenNFS
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "BVHBuilder.h"
+#include "Entities/TrackBlock.h"
+
+namespace LibOpenNFS {
+    // Bounding volume hierarchy over TrackBlock::bounds, for finding the blocks a camera can see without testing every block
+    class CullingBVH {
+      public:
+        // Planes as (normal, distance) with normals pointing into the frustum: left, right, bottom, top, near, far
+        using Frustum = std::array<glm::vec4, 6>;
+
+        CullingBVH() = default;
+        static CullingBVH Build(std::vector<TrackBlock> const &trackBlocks);
+        // Gribb/Hartmann plane extraction from a (projection * view) matrix, with an OpenGL style [-1, 1] clip space depth range
+        static Frustum ExtractFrustum(glm::mat4 const &viewProjection);
+
+        // Append the indices into trackBlocks of every block whose bounds are at least partly inside the frustum. Subtrees fully
+        // inside are appended without testing any further planes.
+        void Query(Frustum const &frustum, std::vector<uint32_t> &visibleBlocks) const;
+        // Append the indices of every block whose bounds overlap region
+        void Query(AABB const &region, std::vector<uint32_t> &overlappingBlocks) const;
+
+        AABB Bounds() const {
+            return m_nodes.empty() ? AABB() : m_nodes.front().Bounds();
+        }
+
+      private:
+        void _AppendSubtree(uint32_t nodeIdx, std::vector<uint32_t> &blocks) const;
+
+        std::vector<BVHNode> m_nodes;
+        // Leaves index this, it maps back to indices into trackBlocks
+        std::vector<uint32_t> m_blockOrder;
+    };
+} // namespace LibOpenNFS
@@ -0,0 +1,657 @@
+#include "GeometryUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+
+#include "Logging.h"
+#include "Parallel.h"
+
+namespace LibOpenNFS {
+    namespace {
+        // Positions closer than this (after quantisation) are treated as the same vertex
+        constexpr float kPositionEpsilon{1e-4f};
+
+        using PositionKey = std::tuple<int64_t, int64_t, int64_t>;
+
+        PositionKey QuantisePosition(glm::vec3 const &position) {
+            return {std::llround(position.x / kPositionEpsilon), std::llround(position.y / kPositionEpsilon),
+                    std::llround(position.z / kPositionEpsilon)};
+        }
+
+        bool IsTriangleList(Geometry const &geometry) {
+            return geometry.m_indices.empty() && geometry.m_vertices.size() == geometry.m_normals.size() &&
+                   geometry.m_vertices.size() % 3 == 0;
+        }
+
+        // Tom Forsyth's "Linear-Speed Vertex Cache Optimisation" scoring, tuned for a 32 entry LRU cache
+        constexpr uint32_t kForsythCacheSize{32};
+        constexpr float kForsythCacheDecayPower{1.5f};
+        constexpr float kForsythLastTriScore{0.75f};
+        constexpr float kForsythValenceBoostScale{2.0f};
+        constexpr float kForsythValenceBoostPower{0.5f};
+
+        float ForsythVertexScore(int32_t const cachePosition, uint32_t const remainingTriangles) {
+            if (remainingTriangles == 0) {
+                return -1.f;
+            }
+            float score{0.f};
+            if (cachePosition >= 0) {
+                if (cachePosition < 3) {
+                    // The vertices of the last triangle get a fixed score, to avoid favouring the strip order they were in
+                    score = kForsythLastTriScore;
+                } else {
+                    float const scaler{1.f / (kForsythCacheSize - 3)};
+                    score = std::pow(1.f - static_cast<float>(cachePosition - 3) * scaler, kForsythCacheDecayPower);
+                }
+            }
+            // Boost vertices with few triangles left so that they are finished off, rather than leaving lone triangles behind
+            return score + kForsythValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -kForsythValenceBoostPower);
+        }
+
+        std::vector<uint32_t> ForsythOptimise(std::vector<uint32_t> const &indices, size_t const nVertices) {
+            size_t const nTriangles{indices.size() / 3};
+
+            // Vertex -> triangle adjacency. The live triangles of a vertex are kept at the front of its range.
+            std::vector<uint32_t> adjacencyOffsets(nVertices + 1, 0);
+            for (uint32_t const vertexIdx : indices) {
+                ++adjacencyOffsets[vertexIdx + 1];
+            }
+            for (size_t vertexIdx = 0; vertexIdx < nVertices; ++vertexIdx) {
+                adjacencyOffsets[vertexIdx + 1] += adjacencyOffsets[vertexIdx];
+            }
+            std::vector<uint32_t> remainingTriangles(nVertices, 0);
+            std::vector<uint32_t> adjacency(indices.size());
+            for (size_t cornerIdx = 0; cornerIdx < indices.size(); ++cornerIdx) {
+                uint32_t const vertexIdx{indices[cornerIdx]};
+                adjacency[adjacencyOffsets[vertexIdx] + remainingTriangles[vertexIdx]++] = static_cast<uint32_t>(cornerIdx / 3);
+            }
+
+            std::vector<int32_t> cachePositions(nVertices, -1);
+            std::vector<float> vertexScores(nVertices);
+            for (size_t vertexIdx = 0; vertexIdx < nVertices; ++vertexIdx) {
+                vertexScores[vertexIdx] = ForsythVertexScore(-1, remainingTriangles[vertexIdx]);
+            }
+            std::vector<float> triangleScores(nTriangles);
+            for (size_t triIdx = 0; triIdx < nTriangles; ++triIdx) {
+                triangleScores[triIdx] = vertexScores[indices[triIdx * 3]] + vertexScores[indices[triIdx * 3 + 1]] +
+                                         vertexScores[indices[triIdx * 3 + 2]];
+            }
+            std::vector<bool> emitted(nTriangles, false);
+
+            std::vector<uint32_t> cache, nextCache;
+            cache.reserve(kForsythCacheSize + 3);
+            nextCache.reserve(kForsythCacheSize + 3);
+
+            std::vector<uint32_t> optimisedIndices;
+            optimisedIndices.reserve(indices.size());
+            int64_t bestTriangle{nTriangles > 0 ? 0 : -1};
+            size_t scanCursor{0};
+            for (size_t nEmitted = 0; nEmitted < nTriangles; ++nEmitted) {
+                if (bestTriangle < 0) {
+                    // Nothing in the cache touches a live triangle, restart from the next unemitted triangle in file order
+                    while (emitted[scanCursor]) {
+                        ++scanCursor;
+                    }
+                    bestTriangle = static_cast<int64_t>(scanCursor);
+                }
+                auto const triIdx{static_cast<uint32_t>(bestTriangle)};
+                emitted[triIdx] = true;
+
+                nextCache.clear();
+                for (uint32_t corner = 0; corner < 3; ++corner) {
+                    uint32_t const vertexIdx{indices[triIdx * 3 + corner]};
+                    optimisedIndices.push_back(vertexIdx);
+                    // Drop the triangle from the vertex's live set
+                    uint32_t *const liveBegin{&adjacency[adjacencyOffsets[vertexIdx]]};
+                    uint32_t *const liveEnd{liveBegin + remainingTriangles[vertexIdx]};
+                    if (uint32_t *const it{std::find(liveBegin, liveEnd, triIdx)}; it != liveEnd) {
+                        std::swap(*it, *(liveEnd - 1));
+                        --remainingTriangles[vertexIdx];
+                    }
+                    if (std::find(nextCache.begin(), nextCache.end(), vertexIdx) == nextCache.end()) {
+                        nextCache.push_back(vertexIdx);
+                    }
+                }
+                for (uint32_t const vertexIdx : cache) {
+                    if (std::find(nextCache.begin(), nextCache.end(), vertexIdx) == nextCache.end()) {
+                        nextCache.push_back(vertexIdx);
+                    }
+                }
+                std::swap(cache, nextCache);
+
+                // Rescore everything that entered, moved within or fell out of the cache
+                for (size_t cachePosition = 0; cachePosition < cache.size(); ++cachePosition) {
+                    uint32_t const vertexIdx{cache[cachePosition]};
+                    cachePositions[vertexIdx] = cachePosition < kForsythCacheSize ? static_cast<int32_t>(cachePosition) : -1;
+                    float const score{ForsythVertexScore(cachePositions[vertexIdx], remainingTriangles[vertexIdx])};
+                    float const scoreDelta{score - vertexScores[vertexIdx]};
+                    vertexScores[vertexIdx] = score;
+                    for (uint32_t liveIdx = 0; liveIdx < remainingTriangles[vertexIdx]; ++liveIdx) {
+                        triangleScores[adjacency[adjacencyOffsets[vertexIdx] + liveIdx]] += scoreDelta;
+                    }
+                }
+                if (cache.size() > kForsythCacheSize) {
+                    cache.resize(kForsythCacheSize);
+                }
+
+                // The next triangle is the best scoring live triangle touching the cache
+                bestTriangle = -1;
+                float bestScore{-1.f};
+                for (uint32_t const vertexIdx : cache) {
+                    for (uint32_t liveIdx = 0; liveIdx < remainingTriangles[vertexIdx]; ++liveIdx) {
+                        uint32_t const candidateIdx{adjacency[adjacencyOffsets[vertexIdx] + liveIdx]};
+                        if (triangleScores[candidateIdx] > bestScore) {
+                            bestScore = triangleScores[candidateIdx];
+                            bestTriangle = candidateIdx;
+                        }
+                    }
+                }
+            }
+            return optimisedIndices;
+        }
+
+        // Vertex transforms needed to draw indices through a FIFO post-transform cache of cacheSize entries
+        size_t CountCacheMisses(std::vector<uint32_t> const &indices, size_t const nVertices, uint32_t const cacheSize) {
+            std::vector<size_t> cacheTimestamps(nVertices, 0);
+            size_t time{cacheSize + 1u};
+            size_t nMisses{0};
+            for (uint32_t const vertexIdx : indices) {
+                if (time - cacheTimestamps[vertexIdx] > cacheSize) {
+                    cacheTimestamps[vertexIdx] = time++;
+                    ++nMisses;
+                }
+            }
+            return nMisses;
+        }
+
+        // Split the cache optimised triangle order into clusters at hard cache boundaries (triangles where every vertex misses) and
+        // sort the clusters so that those facing away from the mesh centre, which are most likely to occlude, are drawn first.
+        // Reordering at hard boundaries costs little cache efficiency, and the result is discarded if it costs more than threshold.
+        std::vector<uint32_t> OverdrawOptimise(Geometry const &geometry, std::vector<uint32_t> const &indices, size_t const nCacheMisses,
+                                               float const threshold) {
+            size_t const nTriangles{indices.size() / 3};
+            std::vector<uint32_t> clusterStarts;
+            {
+                std::vector<size_t> cacheTimestamps(geometry.m_vertices.size(), 0);
+                size_t time{GeometryUtils::IndexStats::kCacheStatsSize + 1u};
+                for (size_t triIdx = 0; triIdx < nTriangles; ++triIdx) {
+                    uint32_t nTriMisses{0};
+                    for (uint32_t corner = 0; corner < 3; ++corner) {
+                        uint32_t const vertexIdx{indices[triIdx * 3 + corner]};
+                        if (time - cacheTimestamps[vertexIdx] > GeometryUtils::IndexStats::kCacheStatsSize) {
+                            cacheTimestamps[vertexIdx] = time++;
+                            ++nTriMisses;
+                        }
+                    }
+                    if (triIdx == 0 || nTriMisses == 3) {
+                        clusterStarts.push_back(static_cast<uint32_t>(triIdx));
+                    }
+                }
+            }
+            if (clusterStarts.size() < 2) {
+                return indices;
+            }
+
+            // Winding after the loaders' axis flips doesn't always agree with the normals, so orient by majority vote
+            std::vector<glm::vec3> faceCrosses(nTriangles);
+            glm::vec3 meshCentroid{0.f};
+            float meshArea{0.f}, windingAgreement{0.f};
+            bool const hasNormals{geometry.m_normals.size() == geometry.m_vertices.size()};
+            for (size_t triIdx = 0; triIdx < nTriangles; ++triIdx) {
+                glm::vec3 const &p0{geometry.m_vertices[indices[triIdx * 3]]};
+                glm::vec3 const &p1{geometry.m_vertices[indices[triIdx * 3 + 1]]};
+                glm::vec3 const &p2{geometry.m_vertices[indices[triIdx * 3 + 2]]};
+                faceCrosses[triIdx] = glm::cross(p1 - p0, p2 - p0);
+                float const area{glm::length(faceCrosses[triIdx])};
+                meshCentroid += (p0 + p1 + p2) * (area / 3.f);
+                meshArea += area;
+                if (hasNormals) {
+                    windingAgreement += glm::dot(faceCrosses[triIdx], geometry.m_normals[indices[triIdx * 3]]);
+                }
+            }
+            if (meshArea <= 0.f) {
+                return indices;
+            }
+            meshCentroid /= meshArea;
+            float const windingSign{windingAgreement < 0.f ? -1.f : 1.f};
+
+            struct Cluster {
+                uint32_t start;
+                uint32_t end;
+                float sortKey;
+            };
+            std::vector<Cluster> clusters;
+            clusters.reserve(clusterStarts.size());
+            for (size_t clusterIdx = 0; clusterIdx < clusterStarts.size(); ++clusterIdx) {
+                uint32_t const start{clusterStarts[clusterIdx]};
+                uint32_t const end{clusterIdx + 1 < clusterStarts.size() ? clusterStarts[clusterIdx + 1] : static_cast<uint32_t>(nTriangles)};
+                glm::vec3 centroid{0.f}, normal{0.f};
+                float area{0.f};
+                for (uint32_t triIdx = start; triIdx < end; ++triIdx) {
+                    float const triArea{glm::length(faceCrosses[triIdx])};
+                    centroid += (geometry.m_vertices[indices[triIdx * 3]] + geometry.m_vertices[indices[triIdx * 3 + 1]] +
+                                 geometry.m_vertices[indices[triIdx * 3 + 2]]) *
+                                (triArea / 3.f);
+                    normal += faceCrosses[triIdx];
+                    area += triArea;
+                }
+                float const normalLength{glm::length(normal)};
+                float sortKey{0.f};
+                if (area > 0.f && normalLength > 0.f) {
+                    sortKey = glm::dot(centroid / area - meshCentroid, normal / normalLength) * windingSign;
+                }
+                clusters.push_back({start, end, sortKey});
+            }
+            std::stable_sort(clusters.begin(), clusters.end(), [](Cluster const &a, Cluster const &b) { return a.sortKey > b.sortKey; });
+
+            std::vector<uint32_t> sortedIndices;
+            sortedIndices.reserve(indices.size());
+            for (auto const &cluster : clusters) {
+                sortedIndices.insert(sortedIndices.end(), indices.begin() + cluster.start * 3, indices.begin() + cluster.end * 3);
+            }
+            size_t const nSortedMisses{CountCacheMisses(sortedIndices, geometry.m_vertices.size(), GeometryUtils::IndexStats::kCacheStatsSize)};
+            if (static_cast<float>(nSortedMisses) > static_cast<float>(nCacheMisses) * threshold) {
+                return indices;
+            }
+            return sortedIndices;
+        }
+
+        template <typename T> void HashBytes(uint64_t &hash, std::vector<T> const &data) {
+            auto const *bytes{reinterpret_cast<unsigned char const *>(data.data())};
+            for (size_t byteIdx = 0; byteIdx < data.size() * sizeof(T); ++byteIdx) {
+                hash = (hash ^ bytes[byteIdx]) * 0x100000001B3ull;
+            }
+            // Separate the arrays, so that data moving between them changes the hash
+            hash = (hash ^ data.size()) * 0x100000001B3ull;
+        }
+
+        uint64_t HashMesh(TrackGeometry const &geometry) {
+            uint64_t hash{0xCBF29CE484222325ull};
+            HashBytes(hash, geometry.m_vertices);
+            HashBytes(hash, geometry.m_normals);
+            HashBytes(hash, geometry.m_uvs);
+            HashBytes(hash, geometry.m_textureIndices);
+            HashBytes(hash, geometry.m_shadingData);
+            HashBytes(hash, geometry.m_indices);
+            return hash;
+        }
+
+        bool MeshesEqual(TrackGeometry const &a, TrackGeometry const &b) {
+            return a.m_vertices == b.m_vertices && a.m_normals == b.m_normals && a.m_uvs == b.m_uvs &&
+                   a.m_textureIndices == b.m_textureIndices && a.m_shadingData == b.m_shadingData && a.m_indices == b.m_indices;
+        }
+
+        // Every static geometry of a track, for passes that treat meshes independently
+        std::vector<Geometry *> CollectGeometries(Track &track) {
+            std::vector<Geometry *> geometries;
+            std::set<TrackGeometry *> sharedGeometries;
+            auto addEntities = [&](std::vector<TrackEntity> &entities) {
+                for (auto &entity : entities) {
+                    if (!entity.hasGeometry) {
+                        continue;
+                    }
+                    // Shared meshes are only processed once, however many instances reference them
+                    if (!entity.sharedGeometry) {
+                        geometries.push_back(&entity.geometry);
+                    } else if (sharedGeometries.insert(entity.sharedGeometry.get()).second) {
+                        geometries.push_back(entity.sharedGeometry.get());
+                    }
+                }
+            };
+            for (auto &trackBlock : track.trackBlocks) {
+                addEntities(trackBlock.track);
+                addEntities(trackBlock.objects);
+                addEntities(trackBlock.lanes);
+                addEntities(trackBlock.lowResTrack);
+                addEntities(trackBlock.medResTrack);
+            }
+            addEntities(track.globalObjects);
+            return geometries;
+        }
+    } // namespace
+
+    float GeometryUtils::IndexStats::AcmrBefore() const {
+        return nTriangles > 0 ? static_cast<float>(cacheMissesBefore) / static_cast<float>(nTriangles) : 0.f;
+    }
+
+    float GeometryUtils::IndexStats::AcmrAfter() const {
+        return nTriangles > 0 ? static_cast<float>(cacheMissesAfter) / static_cast<float>(nTriangles) : 0.f;
+    }
+
+    GeometryUtils::IndexStats &GeometryUtils::IndexStats::operator+=(IndexStats const &other) {
+        nTriangles += other.nTriangles;
+        cacheMissesBefore += other.cacheMissesBefore;
+        cacheMissesAfter += other.cacheMissesAfter;
+        return *this;
+    }
+
+    void GeometryUtils::PostProcess(Track &track, LoadOptions const &options) {
+        if (options.instanceObjects) {
+            InstanceObjects(track);
+        }
+        if (options.smoothNormals) {
+            SmoothNormals(track, options.creaseAngle);
+        }
+        if (options.optimiseIndices) {
+            OptimiseIndices(track, options.overdrawThreshold);
+        }
+    }
+
+    void GeometryUtils::PostProcess(Car &car, LoadOptions const &options) {
+        if (options.smoothNormals) {
+            SmoothNormals(car, options.creaseAngle);
+        }
+        if (options.optimiseIndices) {
+            OptimiseIndices(car, options.overdrawThreshold);
+        }
+    }
+
+    void GeometryUtils::PostProcess(TrackBlock &trackBlock, LoadOptions const &options) {
+        if (options.smoothNormals) {
+            std::vector<Geometry *> blockGroup;
+            for (auto *entities : {&trackBlock.track, &trackBlock.objects, &trackBlock.lanes}) {
+                for (auto &entity : *entities) {
+                    if (!entity.hasGeometry || entity.sharedGeometry) {
+                        continue;
+                    }
+                    if (entity.animKeyframes.empty()) {
+                        blockGroup.push_back(&entity.geometry);
+                    } else {
+                        SmoothNormals(entity.geometry, options.creaseAngle);
+                    }
+                }
+            }
+            SmoothNormals(blockGroup, options.creaseAngle);
+            for (auto *lodEntities : {&trackBlock.lowResTrack, &trackBlock.medResTrack}) {
+                std::vector<Geometry *> lodGroup;
+                for (auto &entity : *lodEntities) {
+                    lodGroup.push_back(&entity.geometry);
+                }
+                SmoothNormals(lodGroup, options.creaseAngle);
+            }
+        }
+        if (options.optimiseIndices) {
+            for (auto *entities : {&trackBlock.track, &trackBlock.objects, &trackBlock.lanes, &trackBlock.lowResTrack,
+                                   &trackBlock.medResTrack}) {
+                for (auto &entity : *entities) {
+                    if (entity.hasGeometry && !entity.sharedGeometry) {
+                        OptimiseIndices(entity.geometry, options.overdrawThreshold);
+                    }
+                }
+            }
+        }
+    }
+
+    size_t GeometryUtils::InstanceObjects(Track &track) {
+        std::vector<TrackEntity *> candidates;
+        for (auto &trackBlock : track.trackBlocks) {
+            for (auto &entity : trackBlock.objects) {
+                if (entity.type == EntityType::XOBJ && entity.hasGeometry && !entity.sharedGeometry && entity.animKeyframes.empty() &&
+                    !entity.geometry.m_vertices.empty()) {
+                    candidates.push_back(&entity);
+                }
+            }
+        }
+        std::vector<uint64_t> meshHashes(candidates.size());
+        Utils::ParallelFor(candidates.size(),
+                           [&](size_t const candidateIdx) { meshHashes[candidateIdx] = HashMesh(candidates[candidateIdx]->geometry); });
+
+        // Bucket by hash, then split each bucket into sets of truly identical meshes
+        std::unordered_map<uint64_t, std::vector<std::vector<TrackEntity *>>> buckets;
+        for (size_t candidateIdx = 0; candidateIdx < candidates.size(); ++candidateIdx) {
+            auto &meshSets{buckets[meshHashes[candidateIdx]]};
+            auto const matchingSet{std::find_if(meshSets.begin(), meshSets.end(), [&](std::vector<TrackEntity *> const &meshSet) {
+                return MeshesEqual(meshSet.front()->geometry, candidates[candidateIdx]->geometry);
+            })};
+            if (matchingSet != meshSets.end()) {
+                matchingSet->push_back(candidates[candidateIdx]);
+            } else {
+                meshSets.push_back({candidates[candidateIdx]});
+            }
+        }
+
+        size_t nInstances{0}, nSharedMeshes{0};
+        for (auto &[hash, meshSets] : buckets) {
+            for (auto &meshSet : meshSets) {
+                if (meshSet.size() < 2) {
+                    continue;
+                }
+                auto const sharedGeometry{std::make_shared<TrackGeometry>(meshSet.front()->geometry)};
+                sharedGeometry->position = sharedGeometry->initialPosition = glm::vec3(0.f);
+                sharedGeometry->orientation_vec = glm::vec3(0.f);
+                sharedGeometry->orientation = glm::quat(sharedGeometry->orientation_vec);
+                for (TrackEntity *const instance : meshSet) {
+                    // Keep only the placement of each instance
+                    TrackGeometry placement;
+                    placement.name = sharedGeometry->name;
+                    placement.position = instance->geometry.position;
+                    placement.initialPosition = instance->geometry.initialPosition;
+                    placement.orientation_vec = instance->geometry.orientation_vec;
+                    placement.orientation = instance->geometry.orientation;
+                    instance->geometry = std::move(placement);
+                    instance->sharedGeometry = sharedGeometry;
+                }
+                nInstances += meshSet.size();
+                ++nSharedMeshes;
+            }
+        }
+        LogInfo("Instanced %zu of %zu extra objects onto %zu shared meshes", nInstances, candidates.size(), nSharedMeshes);
+
+        return nInstances;
+    }
+
+    void GeometryUtils::SmoothNormals(std::vector<Geometry *> const &geometries, float const creaseAngle) {
+        struct Corner {
+            PositionKey key;
+            uint32_t geometryIdx;
+            uint32_t cornerIdx;
+            uint32_t faceIdx;
+        };
+
+        // Flatten all triangles of the group so that faces can be addressed by a single index
+        std::vector<Corner> corners;
+        std::vector<glm::vec3> faceNormals;
+        std::vector<float> faceAreas;
+        for (uint32_t geomIdx = 0; geomIdx < geometries.size(); ++geomIdx) {
+            Geometry const &geometry{*geometries[geomIdx]};
+            if (!IsTriangleList(geometry)) {
+                continue;
+            }
+            for (uint32_t cornerIdx = 0; cornerIdx < geometry.m_vertices.size(); cornerIdx += 3) {
+                glm::vec3 const p0{geometry.m_vertices[cornerIdx] + geometry.position};
+                glm::vec3 const p1{geometry.m_vertices[cornerIdx + 1] + geometry.position};
+                glm::vec3 const p2{geometry.m_vertices[cornerIdx + 2] + geometry.position};
+                glm::vec3 const faceCross{glm::cross(p1 - p0, p2 - p0)};
+                // Keep the loaders' normal orientation (it does not always match the winding after scaling), the positions only
+                // provide the weighting
+                glm::vec3 faceNormal{geometry.m_normals[cornerIdx] + geometry.m_normals[cornerIdx + 1] + geometry.m_normals[cornerIdx + 2]};
+                float const faceNormalLength{glm::length(faceNormal)};
+                auto const faceIdx{static_cast<uint32_t>(faceNormals.size())};
+
+                faceNormals.push_back(faceNormalLength > 0.f ? faceNormal / faceNormalLength : faceNormal);
+                faceAreas.push_back(0.5f * glm::length(faceCross));
+                corners.push_back({QuantisePosition(p0), geomIdx, cornerIdx, faceIdx});
+                corners.push_back({QuantisePosition(p1), geomIdx, cornerIdx + 1, faceIdx});
+                corners.push_back({QuantisePosition(p2), geomIdx, cornerIdx + 2, faceIdx});
+            }
+        }
+        std::sort(corners.begin(), corners.end(), [](Corner const &a, Corner const &b) { return a.key < b.key; });
+
+        float const cosCrease{std::cos(glm::radians(std::clamp(creaseAngle, 0.f, 180.f)))};
+        for (size_t runStart = 0, runEnd = 0; runStart < corners.size(); runStart = runEnd) {
+            while (runEnd < corners.size() && corners[runEnd].key == corners[runStart].key) {
+                ++runEnd;
+            }
+            // Every corner in this run shares a position, accumulate the faces within the crease angle of its own face
+            for (size_t i = runStart; i < runEnd; ++i) {
+                glm::vec3 const &ownNormal{faceNormals[corners[i].faceIdx]};
+                glm::vec3 smoothNormal{0.f};
+                for (size_t j = runStart; j < runEnd; ++j) {
+                    glm::vec3 const &otherNormal{faceNormals[corners[j].faceIdx]};
+                    if (glm::dot(ownNormal, otherNormal) >= cosCrease) {
+                        smoothNormal += otherNormal * faceAreas[corners[j].faceIdx];
+                    }
+                }
+                float const smoothLength{glm::length(smoothNormal)};
+                if (smoothLength > 0.f) {
+                    geometries[corners[i].geometryIdx]->m_normals[corners[i].cornerIdx] = smoothNormal / smoothLength;
+                }
+            }
+        }
+    }
+
+    void GeometryUtils::SmoothNormals(Geometry &geometry, float const creaseAngle) {
+        SmoothNormals(std::vector<Geometry *>{&geometry}, creaseAngle);
+    }
+
+    void GeometryUtils::SmoothNormals(Track &track, float const creaseAngle) {
+        // Static block geometry is smoothed as one group, anything that moves independently is smoothed alone
+        std::vector<std::vector<Geometry *>> groups(track.trackBlocks.size());
+        std::vector<std::vector<Geometry *>> independentGroups;
+        std::set<TrackGeometry *> sharedGeometries;
+        for (size_t blockIdx = 0; blockIdx < track.trackBlocks.size(); ++blockIdx) {
+            TrackBlock &trackBlock{track.trackBlocks[blockIdx]};
+            for (auto *entities : {&trackBlock.track, &trackBlock.objects, &trackBlock.lanes}) {
+                for (auto &entity : *entities) {
+                    if (!entity.hasGeometry) {
+                        continue;
+                    }
+                    if (entity.sharedGeometry) {
+                        if (sharedGeometries.insert(entity.sharedGeometry.get()).second) {
+                            independentGroups.push_back({entity.sharedGeometry.get()});
+                        }
+                    } else if (entity.animKeyframes.empty()) {
+                        groups[blockIdx].push_back(&entity.geometry);
+                    } else {
+                        independentGroups.push_back({&entity.geometry});
+                    }
+                }
+            }
+        }
+        for (auto &entity : track.globalObjects) {
+            if (!entity.hasGeometry) {
+                continue;
+            }
+            if (!entity.sharedGeometry) {
+                independentGroups.push_back({&entity.geometry});
+            } else if (sharedGeometries.insert(entity.sharedGeometry.get()).second) {
+                independentGroups.push_back({entity.sharedGeometry.get()});
+            }
+        }
+        // Each level of detail overlaps the full resolution road, so gets its own group
+        for (auto &trackBlock : track.trackBlocks) {
+            for (auto *lodEntities : {&trackBlock.lowResTrack, &trackBlock.medResTrack}) {
+                std::vector<Geometry *> lodGroup;
+                for (auto &entity : *lodEntities) {
+                    lodGroup.push_back(&entity.geometry);
+                }
+                if (!lodGroup.empty()) {
+                    independentGroups.push_back(lodGroup);
+                }
+            }
+        }
+        groups.insert(groups.end(), independentGroups.begin(), independentGroups.end());
+
+        Utils::ParallelFor(groups.size(), [&](size_t const groupIdx) { SmoothNormals(groups[groupIdx], creaseAngle); });
+        LogInfo("Smoothed normals of %zu geometry groups (crease angle %.1f)", groups.size(), creaseAngle);
+    }
+
+    void GeometryUtils::SmoothNormals(Car &car, float const creaseAngle) {
+        std::vector<CarGeometry> &meshes{car.metadata.meshes};
+        Utils::ParallelFor(meshes.size(), [&](size_t const meshIdx) { SmoothNormals(meshes[meshIdx], creaseAngle); });
+    }
+
+    void GeometryUtils::WeldVertices(Geometry &geometry) {
+        if (!geometry.m_indices.empty() || geometry.m_vertices.size() % 3 != 0) {
+            return;
+        }
+        size_t const nVertices{geometry.m_vertices.size()};
+        // Open addressing table of unique vertices, sized to a power of two at most half full
+        size_t tableSize{1};
+        while (tableSize < nVertices * 2) {
+            tableSize <<= 1;
+        }
+        std::vector<uint32_t> table(tableSize, UINT32_MAX);
+        std::vector<uint32_t> uniqueVertices;
+        geometry.m_indices.resize(nVertices);
+        for (uint32_t vertexIdx = 0; vertexIdx < nVertices; ++vertexIdx) {
+            size_t slot{geometry.HashVertex(vertexIdx) & (tableSize - 1)};
+            while (table[slot] != UINT32_MAX && !geometry.VerticesEqual(uniqueVertices[table[slot]], vertexIdx)) {
+                slot = (slot + 1) & (tableSize - 1);
+            }
+            if (table[slot] == UINT32_MAX) {
+                table[slot] = static_cast<uint32_t>(uniqueVertices.size());
+                uniqueVertices.push_back(vertexIdx);
+            }
+            geometry.m_indices[vertexIdx] = table[slot];
+        }
+        geometry.RemapVertices(uniqueVertices);
+    }
+
+    GeometryUtils::IndexStats GeometryUtils::OptimiseIndices(Geometry &geometry, float const overdrawThreshold) {
+        IndexStats stats;
+        WeldVertices(geometry);
+        if (geometry.m_indices.empty()) {
+            return stats;
+        }
+        size_t const nVertices{geometry.m_vertices.size()};
+        stats.nTriangles = geometry.m_indices.size() / 3;
+        stats.cacheMissesBefore = CountCacheMisses(geometry.m_indices, nVertices, IndexStats::kCacheStatsSize);
+
+        std::vector<uint32_t> indices{ForsythOptimise(geometry.m_indices, nVertices)};
+        if (overdrawThreshold > 1.f) {
+            size_t const nCacheMisses{CountCacheMisses(indices, nVertices, IndexStats::kCacheStatsSize)};
+            indices = OverdrawOptimise(geometry, indices, nCacheMisses, overdrawThreshold);
+        }
+
+        // Vertex fetch: lay the vertices out in the order they are first referenced
+        std::vector<uint32_t> remap;
+        std::vector<uint32_t> newVertexIndices(nVertices, UINT32_MAX);
+        remap.reserve(nVertices);
+        for (uint32_t &vertexIdx : indices) {
+            if (newVertexIndices[vertexIdx] == UINT32_MAX) {
+                newVertexIndices[vertexIdx] = static_cast<uint32_t>(remap.size());
+                remap.push_back(vertexIdx);
+            }
+            vertexIdx = newVertexIndices[vertexIdx];
+        }
+        geometry.RemapVertices(remap);
+        geometry.m_indices = std::move(indices);
+
+        stats.cacheMissesAfter = CountCacheMisses(geometry.m_indices, geometry.m_vertices.size(), IndexStats::kCacheStatsSize);
+        return stats;
+    }
+
+    GeometryUtils::IndexStats GeometryUtils::OptimiseIndices(Track &track, float const overdrawThreshold) {
+        std::vector<Geometry *> const geometries{CollectGeometries(track)};
+        std::vector<IndexStats> geometryStats(geometries.size());
+        Utils::ParallelFor(geometries.size(),
+                           [&](size_t const geomIdx) { geometryStats[geomIdx] = OptimiseIndices(*geometries[geomIdx], overdrawThreshold); });
+
+        IndexStats stats;
+        for (auto const &geomStats : geometryStats) {
+            stats += geomStats;
+        }
+        LogInfo("Optimised %zu track meshes (%zu triangles), ACMR %.3f -> %.3f", geometries.size(), stats.nTriangles,
+                stats.AcmrBefore(), stats.AcmrAfter());
+        return stats;
+    }
+
+    GeometryUtils::IndexStats GeometryUtils::OptimiseIndices(Car &car, float const overdrawThreshold) {
+        std::vector<CarGeometry> &meshes{car.metadata.meshes};
+        std::vector<IndexStats> meshStats(meshes.size());
+        Utils::ParallelFor(meshes.size(),
+                           [&](size_t const meshIdx) { meshStats[meshIdx] = OptimiseIndices(meshes[meshIdx], overdrawThreshold); });
+
+        IndexStats stats;
+        for (auto const &partStats : meshStats) {
+            stats += partStats;
+        }
+        LogInfo("Optimised %zu car meshes (%zu triangles), ACMR %.3f -> %.3f", meshes.size(), stats.nTriangles, stats.AcmrBefore(),
+                stats.AcmrAfter());
+        return stats;
+    }
+} // namespace LibOpenNFS
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+
+#include "Entities/Car.h"
+#include "Entities/Track.h"
+#include "LoadOptions.h"
+
+namespace LibOpenNFS {
+    class GeometryUtils {
+      public:
+        // Post-transform vertex cache statistics of index buffers, for a FIFO cache of kCacheStatsSize entries
+        struct IndexStats {
+            static constexpr uint32_t kCacheStatsSize{16};
+            size_t nTriangles{0};
+            size_t cacheMissesBefore{0};
+            size_t cacheMissesAfter{0};
+            // Average cache miss ratio (vertex transforms per triangle) before/after optimisation
+            float AcmrBefore() const;
+            float AcmrAfter() const;
+            IndexStats &operator+=(IndexStats const &other);
+        };
+
+        // Run the post-processing steps enabled in options over every mesh of a freshly loaded Track/Car
+        static void PostProcess(Track &track, LoadOptions const &options);
+        static void PostProcess(Car &car, LoadOptions const &options);
+        // Smooth and optimise the meshes of a single block, grouped as SmoothNormals(Track) would. Object instancing spans blocks, so
+        // is skipped. Doesn't log, so is safe to run concurrently for distinct blocks (progressive loading).
+        static void PostProcess(TrackBlock &trackBlock, LoadOptions const &options);
+        // Find static extra objects (XOBJs) across all blocks whose local space meshes are identical, and move each such mesh into a
+        // single TrackEntity::sharedGeometry referenced by every instance. Objects with a unique mesh are left untouched.
+        // Returns the number of entities that became instances.
+        static size_t InstanceObjects(Track &track);
+        // Replace the per-corner normals of de-indexed (triangle list) geometry with area weighted smooth normals. Corners are
+        // smoothed across every triangle sharing their world space position (vertex + geometry position) within the group, unless
+        // the triangles meet at more than creaseAngle degrees.
+        static void SmoothNormals(std::vector<Geometry *> const &geometries, float creaseAngle);
+        static void SmoothNormals(Geometry &geometry, float creaseAngle);
+        // Smooths each TrackBlock as one group (so normals are continuous across road/object seams), each block LOD, global and
+        // animated objects on their own. Groups are processed in parallel.
+        static void SmoothNormals(Track &track, float creaseAngle);
+        // Smooths each car part on its own, in parallel
+        static void SmoothNormals(Car &car, float creaseAngle);
+        // Weld a de-indexed triangle list into unique vertices (compared across every per-vertex attribute) and fill m_indices
+        static void WeldVertices(Geometry &geometry);
+        // Weld if needed, then reorder m_indices for post-transform vertex cache locality (Forsyth), reorder triangle clusters
+        // outside-in to reduce overdraw as long as ACMR grows by no more than overdrawThreshold, and finally reorder the vertices
+        // into first-use order for vertex fetch locality. ACMR before is measured on the welded indices in file order.
+        static IndexStats OptimiseIndices(Geometry &geometry, float overdrawThreshold);
+        // Optimise every mesh in parallel, logging the overall ACMR
+        static IndexStats OptimiseIndices(Track &track, float overdrawThreshold);
+        static IndexStats OptimiseIndices(Car &car, float overdrawThreshold);
+
+        // Call fn(v0, v1, v2, i0, i1, i2) with the world space corners and per-vertex array indices of every triangle of the
+        // entity's mesh, whether it is de-indexed, indexed or shared between instances
+        template <typename Func> static void ForEachWorldTriangle(TrackEntity const &entity, Func &&fn) {
+            TrackGeometry const &mesh{entity.Mesh()};
+            glm::mat4 const modelMatrix{entity.ModelMatrix()};
+            auto toWorld = [&](uint32_t const vertexIdx) { return glm::vec3(modelMatrix * glm::vec4(mesh.m_vertices[vertexIdx], 1.f)); };
+            size_t const nCorners{mesh.m_indices.empty() ? mesh.m_vertices.size() : mesh.m_indices.size()};
+            for (size_t cornerIdx = 0; cornerIdx + 2 < nCorners; cornerIdx += 3) {
+                uint32_t const i0{mesh.m_indices.empty() ? static_cast<uint32_t>(cornerIdx) : mesh.m_indices[cornerIdx]};
+                uint32_t const i1{mesh.m_indices.empty() ? static_cast<uint32_t>(cornerIdx + 1) : mesh.m_indices[cornerIdx + 1]};
+                uint32_t const i2{mesh.m_indices.empty() ? static_cast<uint32_t>(cornerIdx + 2) : mesh.m_indices[cornerIdx + 2]};
+                fn(toWorld(i0), toWorld(i1), toWorld(i2), i0, i1, i2);
+            }
+        }
+    };
+} // namespace LibOpenNFS
@@ -0,0 +1,265 @@
+#include "Heightfield.h"
+
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "GeometryUtils.h"
+#include "Logging.h"
+#include "Parallel.h"
+
+namespace LibOpenNFS {
+    namespace {
+        // Faces steeper than this (|normal.y| below it) are walls or kerb sides, not drivable surface
+        constexpr float kMinSurfaceNormalY{0.1f};
+        constexpr float kInsideEpsilon{1e-5f};
+
+        struct RoadTriangle {
+            std::array<glm::vec3, 3> vertices;
+            glm::vec3 normal;
+            uint32_t textureId;
+        };
+
+        int32_t FloorDiv(int32_t const value, int32_t const divisor) {
+            int32_t const quotient{value / divisor};
+            return (value % divisor != 0 && (value < 0) != (divisor < 0)) ? quotient - 1 : quotient;
+        }
+
+        void CollectRoadTriangles(TrackBlock const &trackBlock, std::vector<RoadTriangle> &triangles) {
+            for (auto const &entity : trackBlock.track) {
+                if (entity.type != EntityType::ROAD || !entity.hasGeometry) {
+                    continue;
+                }
+                TrackGeometry const &mesh{entity.Mesh()};
+                GeometryUtils::ForEachWorldTriangle(entity, [&](glm::vec3 const &v0, glm::vec3 const &v1, glm::vec3 const &v2,
+                                                                uint32_t const i0, uint32_t, uint32_t) {
+                    glm::vec3 const cross{glm::cross(v1 - v0, v2 - v0)};
+                    float const crossLength{glm::length(cross)};
+                    if (crossLength <= 0.f) {
+                        return;
+                    }
+                    glm::vec3 normal{cross / crossLength};
+                    if (std::abs(normal.y) < kMinSurfaceNormalY) {
+                        return;
+                    }
+                    if (normal.y < 0.f) {
+                        normal = -normal;
+                    }
+                    uint32_t const textureId{i0 < mesh.m_textureIndices.size() ? mesh.m_textureIndices[i0] : 0u};
+                    triangles.push_back({{v0, v1, v2}, normal, textureId});
+                });
+            }
+        }
+    } // namespace
+
+    Heightfield Heightfield::Build(Track const &track, float const cellSize, float const layerSeparation) {
+        Heightfield heightfield;
+        heightfield.m_cellSize = cellSize;
+        heightfield.m_layerSeparation = layerSeparation;
+
+        std::vector<std::vector<RoadTriangle>> blockTriangles(track.trackBlocks.size());
+        Utils::ParallelFor(track.trackBlocks.size(),
+                           [&](size_t const blockIdx) { CollectRoadTriangles(track.trackBlocks[blockIdx], blockTriangles[blockIdx]); });
+        std::vector<RoadTriangle> triangles;
+        for (auto &block : blockTriangles) {
+            triangles.insert(triangles.end(), block.begin(), block.end());
+        }
+
+        // Bin each triangle into every tile holding a grid point it covers. Tiles share their border points, so a point on a tile
+        // edge is written by both.
+        auto const tileSize{static_cast<int32_t>(kTileSize)};
+        std::vector<std::vector<uint32_t>> tileTriangles;
+        for (uint32_t triangleIdx = 0; triangleIdx < triangles.size(); ++triangleIdx) {
+            AABB bounds;
+            for (auto const &vertex : triangles[triangleIdx].vertices) {
+                bounds.Extend(vertex);
+            }
+            heightfield.m_bounds.Extend(bounds);
+            auto const pointMinX{static_cast<int32_t>(std::ceil(bounds.min.x / cellSize))};
+            auto const pointMaxX{static_cast<int32_t>(std::floor(bounds.max.x / cellSize))};
+            auto const pointMinZ{static_cast<int32_t>(std::ceil(bounds.min.z / cellSize))};
+            auto const pointMaxZ{static_cast<int32_t>(std::floor(bounds.max.z / cellSize))};
+            for (int32_t tileX = FloorDiv(pointMinX - 1, tileSize); tileX <= FloorDiv(pointMaxX, tileSize); ++tileX) {
+                for (int32_t tileZ = FloorDiv(pointMinZ - 1, tileSize); tileZ <= FloorDiv(pointMaxZ, tileSize); ++tileZ) {
+                    auto [lookupIt, inserted]{heightfield.m_tileLookup.try_emplace(_TileKey(tileX, tileZ),
+                                                                                   static_cast<uint32_t>(heightfield.m_tiles.size()))};
+                    if (inserted) {
+                        heightfield.m_tiles.push_back({tileX, tileZ, 0, {}});
+                        tileTriangles.emplace_back();
+                    }
+                    tileTriangles[lookupIt->second].push_back(triangleIdx);
+                }
+            }
+        }
+
+        // Rasterise the tiles in parallel, they never write to each other's points
+        std::vector<size_t> droppedSurfaces(heightfield.m_tiles.size(), 0);
+        Utils::ParallelFor(heightfield.m_tiles.size(), [&](size_t const tileIdx) {
+            Tile &tile{heightfield.m_tiles[tileIdx]};
+            std::vector<std::array<Sample, kMaxLayers>> pointLayers(kTilePoints * kTilePoints);
+            std::vector<uint8_t> pointLayerCounts(kTilePoints * kTilePoints, 0);
+            int32_t const tilePointX{tile.tileX * tileSize};
+            int32_t const tilePointZ{tile.tileZ * tileSize};
+
+            auto insertSample = [&](uint32_t const pointIdx, Sample const &sample) {
+                auto &layers{pointLayers[pointIdx]};
+                uint8_t &nLayers{pointLayerCounts[pointIdx]};
+                for (uint8_t layerIdx = 0; layerIdx < nLayers; ++layerIdx) {
+                    if (std::abs(layers[layerIdx].height - sample.height) < layerSeparation) {
+                        if (sample.height > layers[layerIdx].height) {
+                            layers[layerIdx] = sample;
+                        }
+                        return;
+                    }
+                }
+                if (nLayers == kMaxLayers) {
+                    ++droppedSurfaces[tileIdx];
+                    return;
+                }
+                uint8_t insertIdx{nLayers};
+                while (insertIdx > 0 && layers[insertIdx - 1].height > sample.height) {
+                    layers[insertIdx] = layers[insertIdx - 1];
+                    --insertIdx;
+                }
+                layers[insertIdx] = sample;
+                ++nLayers;
+            };
+
+            for (uint32_t const triangleIdx : tileTriangles[tileIdx]) {
+                RoadTriangle const &triangle{triangles[triangleIdx]};
+                auto const &[v0, v1, v2]{triangle.vertices};
+                float const area{(v1.x - v0.x) * (v2.z - v0.z) - (v2.x - v0.x) * (v1.z - v0.z)};
+                if (area == 0.f) {
+                    continue;
+                }
+                AABB bounds;
+                for (auto const &vertex : triangle.vertices) {
+                    bounds.Extend(vertex);
+                }
+                int32_t const pointMinX{std::max(static_cast<int32_t>(std::ceil(bounds.min.x / cellSize)), tilePointX)};
+                int32_t const pointMaxX{std::min(static_cast<int32_t>(std::floor(bounds.max.x / cellSize)), tilePointX + tileSize)};
+                int32_t const pointMinZ{std::max(static_cast<int32_t>(std::ceil(bounds.min.z / cellSize)), tilePointZ)};
+                int32_t const pointMaxZ{std::min(static_cast<int32_t>(std::floor(bounds.max.z / cellSize)), tilePointZ + tileSize)};
+                for (int32_t pointZ = pointMinZ; pointZ <= pointMaxZ; ++pointZ) {
+                    for (int32_t pointX = pointMinX; pointX <= pointMaxX; ++pointX) {
+                        float const x{static_cast<float>(pointX) * cellSize};
+                        float const z{static_cast<float>(pointZ) * cellSize};
+                        float const w1{((x - v0.x) * (v2.z - v0.z) - (v2.x - v0.x) * (z - v0.z)) / area};
+                        float const w2{((v1.x - v0.x) * (z - v0.z) - (x - v0.x) * (v1.z - v0.z)) / area};
+                        float const w0{1.f - w1 - w2};
+                        if (w0 < -kInsideEpsilon || w1 < -kInsideEpsilon || w2 < -kInsideEpsilon) {
+                            continue;
+                        }
+                        auto const pointIdx{static_cast<uint32_t>((pointZ - tilePointZ) * kTilePoints + (pointX - tilePointX))};
+                        insertSample(pointIdx, {w0 * v0.y + w1 * v1.y + w2 * v2.y, triangle.normal, triangle.textureId});
+                    }
+                }
+            }
+
+            for (uint8_t const nLayers : pointLayerCounts) {
+                tile.nLayers = std::max<uint32_t>(tile.nLayers, nLayers);
+            }
+            Sample const emptySample{std::numeric_limits<float>::quiet_NaN(), glm::vec3(0.f, 1.f, 0.f), 0};
+            tile.samples.assign(tile.nLayers * kTilePoints * kTilePoints, emptySample);
+            for (uint32_t pointIdx = 0; pointIdx < kTilePoints * kTilePoints; ++pointIdx) {
+                for (uint32_t layerIdx = 0; layerIdx < pointLayerCounts[pointIdx]; ++layerIdx) {
+                    tile.samples[layerIdx * kTilePoints * kTilePoints + pointIdx] = pointLayers[pointIdx][layerIdx];
+                }
+            }
+        });
+
+        size_t nDroppedSurfaces{0};
+        for (size_t const dropped : droppedSurfaces) {
+            nDroppedSurfaces += dropped;
+        }
+        if (nDroppedSurfaces > 0) {
+            LogWarning("%zu heightfield samples exceeded %u layers and were dropped", nDroppedSurfaces, kMaxLayers);
+        }
+        LogInfo("Built heightfield over %zu road triangles (%zu tiles of %ux%u cells of %.2f)", triangles.size(),
+                heightfield.m_tiles.size(), kTileSize, kTileSize, cellSize);
+
+        return heightfield;
+    }
+
+    bool Heightfield::Query(float const x, float const z, float const referenceY, Sample &sample) const {
+        if (m_tiles.empty()) {
+            return false;
+        }
+        float const gridX{x / m_cellSize};
+        float const gridZ{z / m_cellSize};
+        float const cellX{std::floor(gridX)};
+        float const cellZ{std::floor(gridZ)};
+        auto const pointX{static_cast<int32_t>(cellX)};
+        auto const pointZ{static_cast<int32_t>(cellZ)};
+        auto const tileSize{static_cast<int32_t>(kTileSize)};
+        int32_t const tileX{FloorDiv(pointX, tileSize)};
+        int32_t const tileZ{FloorDiv(pointZ, tileSize)};
+        auto const lookupIt{m_tileLookup.find(_TileKey(tileX, tileZ))};
+        if (lookupIt == m_tileLookup.end()) {
+            return false;
+        }
+        Tile const &tile{m_tiles[lookupIt->second]};
+        auto const localX{static_cast<uint32_t>(pointX - tileX * tileSize)};
+        auto const localZ{static_cast<uint32_t>(pointZ - tileZ * tileSize)};
+        float const fracX{gridX - cellX};
+        float const fracZ{gridZ - cellZ};
+
+        std::array<uint32_t, 4> const cornerPoints{localZ * kTilePoints + localX, localZ * kTilePoints + localX + 1,
+                                                   (localZ + 1) * kTilePoints + localX, (localZ + 1) * kTilePoints + localX + 1};
+        std::array<float, 4> const cornerWeights{(1.f - fracX) * (1.f - fracZ), fracX * (1.f - fracZ), (1.f - fracX) * fracZ,
+                                                 fracX * fracZ};
+        float totalWeight{0.f}, height{0.f}, bestWeight{-1.f};
+        glm::vec3 normal{0.f};
+        uint32_t textureId{0};
+        for (size_t cornerIdx = 0; cornerIdx < cornerPoints.size(); ++cornerIdx) {
+            Sample const *corner{_FindLayer(tile, cornerPoints[cornerIdx], referenceY)};
+            if (corner == nullptr) {
+                continue;
+            }
+            // Keeps a corner with zero bilinear weight usable when it is the only one with road
+            float const weight{std::max(cornerWeights[cornerIdx], 1e-6f)};
+            totalWeight += weight;
+            height += corner->height * weight;
+            normal += corner->normal * weight;
+            if (weight > bestWeight) {
+                bestWeight = weight;
+                textureId = corner->textureId;
+            }
+        }
+        if (totalWeight == 0.f) {
+            return false;
+        }
+        sample.height = height / totalWeight;
+        sample.normal = glm::normalize(normal);
+        sample.textureId = textureId;
+
+        return true;
+    }
+
+    bool Heightfield::Query(float const x, float const z, Sample &sample) const {
+        return Query(x, z, std::numeric_limits<float>::max(), sample);
+    }
+
+    uint64_t Heightfield::_TileKey(int32_t const tileX, int32_t const tileZ) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(tileX)) << 32) | static_cast<uint32_t>(tileZ);
+    }
+
+    Heightfield::Sample const *Heightfield::_FindLayer(Tile const &tile, uint32_t const pointIdx, float const referenceY) const {
+        Sample const *lowest{nullptr};
+        Sample const *best{nullptr};
+        float const maxHeight{referenceY + m_layerSeparation * 0.5f};
+        for (uint32_t layerIdx = 0; layerIdx < tile.nLayers; ++layerIdx) {
+            Sample const &layer{tile.samples[layerIdx * kTilePoints * kTilePoints + pointIdx]};
+            if (std::isnan(layer.height)) {
+                break;
+            }
+            if (lowest == nullptr) {
+                lowest = &layer;
+            }
+            if (layer.height <= maxHeight) {
+                best = &layer;
+            }
+        }
+        return best != nullptr ? best : lowest;
+    }
+} // namespace LibOpenNFS
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "AABB.h"
+#include "Entities/Track.h"
+
+namespace LibOpenNFS {
+    // 2.5D height map of the ROAD entities of a Track, sampled on a regular XZ grid and stored in sparse square tiles so that
+    // only the area around the road is allocated. Each grid point keeps up to kMaxLayers surfaces (bridges over roads, tunnels),
+    // each with its height, normal and the texture ID of the road polygon it came from. Height lookups are O(1): a hash of the
+    // tile coordinate and a bilinear blend of the four surrounding grid points.
+    class Heightfield {
+      public:
+        static constexpr uint32_t kTileSize{32}; // Cells per tile side, tiles store kTileSize + 1 points so a cell never spans tiles
+        static constexpr uint32_t kMaxLayers{4};
+
+        struct Sample {
+            float height{0.f};
+            glm::vec3 normal{0.f, 1.f, 0.f};
+            uint32_t textureId{0};
+        };
+
+        Heightfield() = default;
+        // cellSize is the grid spacing in world units. Surfaces at a grid point closer than layerSeparation vertically are merged
+        // into a single layer (keeping the highest).
+        static Heightfield Build(Track const &track, float cellSize = 1.f, float layerSeparation = 2.f);
+
+        // Road surface under (x, z) that a body at referenceY would rest on: per grid point, the highest layer no more than
+        // layerSeparation / 2 above referenceY, or the lowest layer if all of them are higher. Grid points without road are left
+        // out of the blend, and false is returned if none of the four have any.
+        bool Query(float x, float z, float referenceY, Sample &sample) const;
+        // Topmost road surface under (x, z)
+        bool Query(float x, float z, Sample &sample) const;
+
+        AABB Bounds() const {
+            return m_bounds;
+        }
+        float CellSize() const {
+            return m_cellSize;
+        }
+        size_t TileCount() const {
+            return m_tiles.size();
+        }
+
+      private:
+        static constexpr uint32_t kTilePoints{kTileSize + 1};
+
+        struct Tile {
+            int32_t tileX{0};
+            int32_t tileZ{0};
+            uint32_t nLayers{0};
+            // nLayers planes of kTilePoints^2 samples. Each point's layers are sorted bottom up, unused slots have a NaN height.
+            std::vector<Sample> samples;
+        };
+
+        static uint64_t _TileKey(int32_t tileX, int32_t tileZ);
+        Sample const *_FindLayer(Tile const &tile, uint32_t pointIdx, float referenceY) const;
+
+        float m_cellSize{1.f};
+        float m_layerSeparation{2.f};
+        AABB m_bounds;
+        std::vector<Tile> m_tiles;
+        std::unordered_map<uint64_t, uint32_t> m_tileLookup;
+    };
+} // namespace LibOpenNFS
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace LibOpenNFS {
+    class TextureCache;
+
+    // Optional post-processing applied by the Track and Car loaders once parsing has finished, and how textures are loaded.
+    // Everything defaults to off, so geometry matches the raw file data unless asked otherwise.
+    struct LoadOptions {
+        // Detect track block extra objects with identical meshes and have them share a single TrackEntity::sharedGeometry. NFS3
+        // global objects built from the same COL mesh share it the same way.
+        bool instanceObjects{false};
+        // Replace the flat per-face normals produced by the loaders with area weighted smooth normals
+        bool smoothNormals{false};
+        // Faces meeting at an angle (in degrees) greater than this keep a hard edge when smoothing
+        float creaseAngle{60.f};
+        // Weld the triangle lists into indexed geometry (Geometry::m_indices), then reorder the indices for vertex cache and overdraw
+        // efficiency and the vertices for fetch locality
+        bool optimiseIndices{false};
+        // Largest relative growth in ACMR the overdraw pass may trade for front to back triangle ordering (1 disables it)
+        float overdrawThreshold{1.05f};
+        // Keep track textures in their source archive and decode them on first access through this cache, instead of decoding
+        // every texture to RGBA up front into TrackTextureAsset::data (see TrackTextureAsset::Pixels). TextureCache::Global() shares
+        // the decoded pixels with everything else loaded in the process.
+        std::shared_ptr<TextureCache> textureCache;
+        // NFS3 sfx archive holding the lane textures, defaults to gamedata/render/pc/sfx.fsh found from the track directory
+        // (gamedata/tracks/<track>)
+        std::string sfxArchivePath;
+    };
+} // namespace LibOpenNFS
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace LibOpenNFS::Utils {
+    // Invoke fn(i) for every i in [0, count), work-stealing indices across up to maxThreads threads (0 = hardware concurrency).
+    // The calling thread participates and the call blocks until all indices have been processed. fn must be safe to run concurrently
+    // for distinct indices, and must not log (the logging buffer is shared). If fn throws, the remaining indices are still processed
+    // and the first exception is rethrown on the calling thread once every thread has finished.
+    template <typename Func> void ParallelFor(size_t const count, Func &&fn, size_t const maxThreads = 0) {
+        size_t const hardwareThreads{std::max<size_t>(1u, std::thread::hardware_concurrency())};
+        size_t const nThreads{std::min(count, maxThreads == 0 ? hardwareThreads : maxThreads)};
+
+        std::mutex errorMutex;
+        std::exception_ptr error;
+        auto invoke = [&](size_t const i) {
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        };
+
+        if (nThreads <= 1) {
+            for (size_t i = 0; i < count; ++i) {
+                invoke(i);
+            }
+        } else {
+            std::atomic<size_t> nextIndex{0};
+            auto worker = [&]() {
+                for (size_t i = nextIndex.fetch_add(1, std::memory_order_relaxed); i < count;
+                     i = nextIndex.fetch_add(1, std::memory_order_relaxed)) {
+                    invoke(i);
+                }
+            };
+            std::vector<std::thread> threads;
+            threads.reserve(nThreads - 1);
+            for (size_t t = 0; t < nThreads - 1; ++t) {
+                try {
+                    threads.emplace_back(worker);
+                } catch (std::system_error const &) {
+                    // Out of threads, the ones already started (and the calling thread) take the remaining indices
+                    break;
+                }
+            }
+            worker();
+            for (auto &thread : threads) {
+                thread.join();
+            }
+        }
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+} // namespace LibOpenNFS::Utils
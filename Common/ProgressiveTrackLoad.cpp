@@ -0,0 +1,136 @@
+#include "ProgressiveTrackLoad.h"
+
+#include <algorithm>
+#include <exception>
+#include <optional>
+#include <utility>
+
+#include "Logging.h"
+#include "Parallel.h"
+
+namespace LibOpenNFS {
+    ProgressiveTrackLoad::ProgressiveTrackLoad(ProgressiveLoadOptions const &options) : m_options(options) {
+    }
+
+    ProgressiveTrackLoad::~ProgressiveTrackLoad() {
+        Cancel();
+    }
+
+    std::vector<uint32_t> ProgressiveTrackLoad::BuildOrder(Track const &track, glm::vec3 const &startPosition) {
+        std::vector<std::pair<float, uint32_t>> blockDistances;
+        blockDistances.reserve(track.trackBlocks.size());
+        for (uint32_t blockIdx = 0; blockIdx < track.trackBlocks.size(); ++blockIdx) {
+            glm::vec3 const offset{track.trackBlocks[blockIdx].position - startPosition};
+            blockDistances.emplace_back(glm::dot(offset, offset), blockIdx);
+        }
+        std::sort(blockDistances.begin(), blockDistances.end());
+
+        std::vector<uint32_t> buildOrder;
+        buildOrder.reserve(blockDistances.size());
+        for (auto const &[distance, blockIdx] : blockDistances) {
+            buildOrder.push_back(blockIdx);
+        }
+        return buildOrder;
+    }
+
+    void ProgressiveTrackLoad::Start(Track &track, std::vector<uint32_t> buildOrder, BlockBuilder blockBuilder) {
+        Cancel();
+        m_blockBuilder = std::move(blockBuilder);
+        m_buildOrder = std::move(buildOrder);
+        m_blockPublished.assign(track.trackBlocks.size(), false);
+        m_nPublished = 0;
+        m_completed.clear();
+        m_error = nullptr;
+        m_cancelled = false;
+
+        // TrackBlock has no default constructor, hence the optionals
+        size_t const nInitialBlocks{std::min<size_t>(m_options.nInitialBlocks, m_buildOrder.size())};
+        std::vector<std::optional<TrackBlock>> initialBlocks(nInitialBlocks);
+        Utils::ParallelFor(nInitialBlocks,
+                           [&](size_t const orderIdx) { initialBlocks[orderIdx] = m_blockBuilder(m_buildOrder[orderIdx]); });
+        for (size_t orderIdx = 0; orderIdx < nInitialBlocks; ++orderIdx) {
+            uint32_t const blockIdx{m_buildOrder[orderIdx]};
+            track.trackBlocks[blockIdx] = std::move(*initialBlocks[orderIdx]);
+            track.trackBlocks[blockIdx].UpdateBounds();
+            m_blockPublished[blockIdx] = true;
+            ++m_nPublished;
+        }
+        track.blockBVH = CullingBVH::Build(track.trackBlocks);
+        if (nInitialBlocks == m_buildOrder.size()) {
+            return;
+        }
+
+        uint32_t const nThreads{m_options.nThreads > 0 ? m_options.nThreads
+                                                       : std::max(1u, std::thread::hardware_concurrency()) - 1};
+        uint32_t const nBackgroundThreads{
+            std::min(std::max(nThreads, 1u), static_cast<uint32_t>(m_buildOrder.size() - nInitialBlocks))};
+        m_thread = std::thread(&ProgressiveTrackLoad::_Worker, this, nInitialBlocks, nBackgroundThreads);
+        LogInfo("Built %zu of %zu blocks nearest the start of %s, building the rest on %u background threads", nInitialBlocks,
+                m_buildOrder.size(), track.name.c_str(), nBackgroundThreads);
+    }
+
+    std::vector<uint32_t> ProgressiveTrackLoad::Poll(Track &track) {
+        std::vector<std::pair<uint32_t, TrackBlock>> completed;
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(m_completedMutex);
+            completed.swap(m_completed);
+            error = std::exchange(m_error, nullptr);
+        }
+        std::vector<uint32_t> publishedBlocks;
+        publishedBlocks.reserve(completed.size());
+        for (auto &[blockIdx, trackBlock] : completed) {
+            track.trackBlocks[blockIdx] = std::move(trackBlock);
+            m_blockPublished[blockIdx] = true;
+            ++m_nPublished;
+            publishedBlocks.push_back(blockIdx);
+        }
+        if (!publishedBlocks.empty()) {
+            track.blockBVH = CullingBVH::Build(track.trackBlocks);
+        }
+        if (error) {
+            // Only set once the background threads have finished, blocks that failed keep their placeholders
+            Wait();
+            std::rethrow_exception(error);
+        }
+        if (IsComplete() && m_thread.joinable()) {
+            Wait();
+            LogInfo("All %zu blocks of %s are built", m_nPublished, track.name.c_str());
+        }
+
+        return publishedBlocks;
+    }
+
+    void ProgressiveTrackLoad::Wait() {
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+    void ProgressiveTrackLoad::Cancel() {
+        m_cancelled = true;
+        Wait();
+    }
+
+    void ProgressiveTrackLoad::_Worker(size_t const firstOrderIdx, uint32_t const nThreads) {
+        try {
+            Utils::ParallelFor(
+                m_buildOrder.size() - firstOrderIdx,
+                [&](size_t const idx) {
+                    if (m_cancelled) {
+                        return;
+                    }
+                    uint32_t const blockIdx{m_buildOrder[firstOrderIdx + idx]};
+                    TrackBlock trackBlock{m_blockBuilder(blockIdx)};
+                    trackBlock.UpdateBounds();
+                    std::lock_guard<std::mutex> lock(m_completedMutex);
+                    m_completed.emplace_back(blockIdx, std::move(trackBlock));
+                },
+                nThreads);
+        } catch (...) {
+            // An exception escaping the thread would terminate the process, so it's handed to Poll
+            std::lock_guard<std::mutex> lock(m_completedMutex);
+            m_error = std::current_exception();
+        }
+    }
+} // namespace LibOpenNFS
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "Entities/Track.h"
+
+namespace LibOpenNFS {
+    struct ProgressiveLoadOptions {
+        // Blocks nearest the start position that are built before the loader returns
+        uint32_t nInitialBlocks{8};
+        // Background threads building the remaining blocks (0 = one less than the hardware concurrency, at least 1)
+        uint32_t nThreads{0};
+    };
+
+    // Lets a track loader return as soon as the blocks around the start position are built, while the remaining blocks are built on
+    // background threads in order of distance from the start. The loader fills Track::trackBlocks with placeholder blocks carrying
+    // only their metadata (ID, position, neighbours, virtual road range) and calls Start. Completed blocks are handed to the
+    // track by Poll, on the thread that owns it, so the track is never modified behind the caller's back.
+    class ProgressiveTrackLoad {
+      public:
+        // Builds the full block at an index into Track::trackBlocks. Called concurrently for distinct blocks, so must not log or
+        // touch state shared with the caller.
+        using BlockBuilder = std::function<TrackBlock(uint32_t blockIdx)>;
+
+        explicit ProgressiveTrackLoad(ProgressiveLoadOptions const &options = {});
+        ~ProgressiveTrackLoad();
+        ProgressiveTrackLoad(ProgressiveTrackLoad const &) = delete;
+        ProgressiveTrackLoad &operator=(ProgressiveTrackLoad const &) = delete;
+
+        // Indices into track.trackBlocks sorted by the distance of each block's position from startPosition
+        static std::vector<uint32_t> BuildOrder(Track const &track, glm::vec3 const &startPosition);
+
+        // Build the first ProgressiveLoadOptions::nInitialBlocks of buildOrder on the calling thread and put them in place, then start
+        // building the rest in the background. Cancels any load already in progress. Rethrows the first exception blockBuilder
+        // threw for an initial block.
+        void Start(Track &track, std::vector<uint32_t> buildOrder, BlockBuilder blockBuilder);
+        // Move every block completed since the last Poll into track.trackBlocks, refreshing its bounds and track.blockBVH. Returns
+        // the indices of the blocks that were put in place. If blockBuilder threw in the background, the first exception is
+        // rethrown here once every other block has been attempted and the blocks that were built are put in place.
+        std::vector<uint32_t> Poll(Track &track);
+        // Block until the background threads have attempted every block (Poll still has to be called to put them in place)
+        void Wait();
+        // Stop building once the blocks in progress complete. Blocks that were never built keep their placeholders.
+        void Cancel();
+
+        // Every block has been built and put in place by Poll
+        bool IsComplete() const {
+            return m_nPublished == m_buildOrder.size();
+        }
+        bool IsBlockBuilt(uint32_t const blockIdx) const {
+            return m_blockPublished[blockIdx];
+        }
+        size_t BuiltBlockCount() const {
+            return m_nPublished;
+        }
+
+      private:
+        void _Worker(size_t firstOrderIdx, uint32_t nThreads);
+
+        ProgressiveLoadOptions m_options;
+        BlockBuilder m_blockBuilder;
+        std::vector<uint32_t> m_buildOrder;
+        // Owned by the calling thread
+        std::vector<bool> m_blockPublished;
+        size_t m_nPublished{0};
+
+        // Shared with the background threads
+        std::thread m_thread;
+        std::atomic<bool> m_cancelled{false};
+        std::mutex m_completedMutex;
+        std::vector<std::pair<uint32_t, TrackBlock>> m_completed;
+        std::exception_ptr m_error;
+    };
+} // namespace LibOpenNFS
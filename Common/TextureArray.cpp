@@ -0,0 +1,136 @@
+#include "TextureArray.h"
+
+#include <bit>
+#include <cstring>
+#include <exception>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ONFS_SSE2
+#endif
+
+#include "Logging.h"
+#include "Parallel.h"
+
+namespace LibOpenNFS {
+    namespace {
+        // Average each 2x2 block of source texels into one destination texel. Odd source dimensions repeat the last row/column.
+        void Downsample(uint8_t const *src, uint32_t const srcWidth, uint32_t const srcHeight, uint8_t *dst, uint32_t const dstWidth,
+                        uint32_t const dstHeight) {
+            for (uint32_t y = 0; y < dstHeight; ++y) {
+                uint8_t const *row0{src + static_cast<size_t>(std::min(2 * y, srcHeight - 1)) * srcWidth * 4};
+                uint8_t const *row1{src + static_cast<size_t>(std::min(2 * y + 1, srcHeight - 1)) * srcWidth * 4};
+                uint8_t *dstRow{dst + static_cast<size_t>(y) * dstWidth * 4};
+                uint32_t x{0};
+#ifdef ONFS_SSE2
+                // Two destination texels (four source texels of each row) per iteration, summed in 16 bits
+                if (srcWidth >= 2 * dstWidth) {
+                    __m128i const zero{_mm_setzero_si128()};
+                    __m128i const rounding{_mm_set1_epi16(2)};
+                    for (; x + 2 <= dstWidth; x += 2) {
+                        __m128i const top{_mm_loadu_si128(reinterpret_cast<__m128i const *>(row0 + x * 8))};
+                        __m128i const bottom{_mm_loadu_si128(reinterpret_cast<__m128i const *>(row1 + x * 8))};
+                        __m128i const left{_mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero))};
+                        __m128i const right{_mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero))};
+                        __m128i const leftSum{_mm_add_epi16(left, _mm_srli_si128(left, 8))};
+                        __m128i const rightSum{_mm_add_epi16(right, _mm_srli_si128(right, 8))};
+                        __m128i const sums{_mm_unpacklo_epi64(leftSum, rightSum)};
+                        __m128i const averages{_mm_srli_epi16(_mm_add_epi16(sums, rounding), 2)};
+                        _mm_storel_epi64(reinterpret_cast<__m128i *>(dstRow + x * 4), _mm_packus_epi16(averages, zero));
+                    }
+                }
+#endif
+                for (; x < dstWidth; ++x) {
+                    uint32_t const x0{std::min(2 * x, srcWidth - 1) * 4};
+                    uint32_t const x1{std::min(2 * x + 1, srcWidth - 1) * 4};
+                    for (uint32_t channel = 0; channel < 4; ++channel) {
+                        uint32_t const sum{
+                            static_cast<uint32_t>(row0[x0 + channel] + row0[x1 + channel] + row1[x0 + channel] + row1[x1 + channel])};
+                        dstRow[x * 4 + channel] = static_cast<uint8_t>((sum + 2) / 4);
+                    }
+                }
+            }
+        }
+
+        // Copy texture pixels to the origin of a layer, repeating its last column and row out to the layer size
+        void CopyPadded(uint8_t const *pixels, uint32_t const textureWidth, uint32_t const textureHeight, uint8_t *layer,
+                        uint32_t const layerWidth, uint32_t const layerHeight) {
+            size_t const textureStride{static_cast<size_t>(textureWidth) * 4};
+            size_t const layerStride{static_cast<size_t>(layerWidth) * 4};
+            for (uint32_t y = 0; y < layerHeight; ++y) {
+                uint8_t const *srcRow{pixels + std::min(y, textureHeight - 1) * textureStride};
+                uint8_t *dstRow{layer + y * layerStride};
+                std::memcpy(dstRow, srcRow, textureStride);
+                for (uint32_t x = textureWidth; x < layerWidth; ++x) {
+                    std::memcpy(dstRow + x * 4, srcRow + textureStride - 4, 4);
+                }
+            }
+        }
+
+        // Texture with pixel data of a size that can be packed, which excludes the UINT32_MAX sized placeholders of missing
+        // textures. FSH stores 16-bit sizes, so anything larger is a placeholder or corrupt.
+        bool HasUsableSize(TrackTextureAsset const &textureAsset) {
+            return textureAsset.HasPixelData() && textureAsset.width > 0 && textureAsset.height > 0 &&
+                   textureAsset.width <= UINT16_MAX && textureAsset.height <= UINT16_MAX;
+        }
+    } // namespace
+
+    TextureArray TextureArray::Build(TrackTextureTable &textureAssets, bool const generateMips) {
+        TextureArray textureArray;
+        std::vector<TrackTextureAsset *> layerTextures;
+        for (auto &[id, textureAsset] : textureAssets) {
+            textureAsset.layer = static_cast<uint32_t>(layerTextures.size());
+            layerTextures.push_back(&textureAsset);
+            if (HasUsableSize(textureAsset)) {
+                textureArray.width = std::max(textureArray.width, textureAsset.width);
+                textureArray.height = std::max(textureArray.height, textureAsset.height);
+            }
+        }
+        textureArray.nLayers = static_cast<uint32_t>(layerTextures.size());
+        if (textureArray.nLayers == 0 || textureArray.width == 0 || textureArray.height == 0) {
+            return textureArray;
+        }
+        textureArray.nLevels = generateMips ? std::bit_width(std::max(textureArray.width, textureArray.height)) : 1;
+        size_t nBytes{0};
+        for (uint32_t level = 0; level < textureArray.nLevels; ++level) {
+            textureArray.levelOffsets.push_back(nBytes);
+            nBytes += textureArray.LayerSize(level) * textureArray.nLayers;
+        }
+        textureArray.data.assign(nBytes, 0);
+
+        std::vector<uint8_t> missingPixels(layerTextures.size(), 0);
+        Utils::ParallelFor(layerTextures.size(), [&](size_t const layer) {
+            TrackTextureAsset const &textureAsset{*layerTextures[layer]};
+            auto *const baseLayer{textureArray.data.data() + layer * textureArray.LayerSize(0)};
+            TextureCache::Pixels pixels;
+            if (HasUsableSize(textureAsset)) {
+                try {
+                    pixels = textureAsset.Pixels();
+                } catch (std::exception const &) {
+                    // Lazily loaded textures in a format that can't be decoded are left out like any other missing texture
+                }
+            }
+            if (!pixels || pixels->size() != static_cast<size_t>(textureAsset.width) * textureAsset.height * 4) {
+                missingPixels[layer] = 1;
+                return;
+            }
+            CopyPadded(pixels->data(), textureAsset.width, textureAsset.height, baseLayer, textureArray.width, textureArray.height);
+            for (uint32_t level = 1; level < textureArray.nLevels; ++level) {
+                Downsample(textureArray.data.data() + textureArray.levelOffsets[level - 1] + layer * textureArray.LayerSize(level - 1),
+                           textureArray.LevelWidth(level - 1), textureArray.LevelHeight(level - 1),
+                           textureArray.data.data() + textureArray.levelOffsets[level] + layer * textureArray.LayerSize(level),
+                           textureArray.LevelWidth(level), textureArray.LevelHeight(level));
+            }
+        });
+
+        size_t const nMissing{static_cast<size_t>(std::count(missingPixels.begin(), missingPixels.end(), 1))};
+        if (nMissing > 0) {
+            LogWarning("%zu of %u textures have no usable pixel data or failed to decode, their texture array layers are left empty",
+                       nMissing, textureArray.nLayers);
+        }
+        LogInfo("Built %ux%u texture array of %u layers and %u mip levels (%zu bytes)", textureArray.width, textureArray.height,
+                textureArray.nLayers, textureArray.nLevels, textureArray.data.size());
+
+        return textureArray;
+    }
+} // namespace LibOpenNFS
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "Entities/TrackTextureTable.h"
+
+namespace LibOpenNFS {
+    // Every texture of a track packed into the layers of a single RGBA8 texture array, ready for upload (e.g. one glTexImage3D /
+    // glTexSubImage3D per mip level). Each texture is placed at the origin of its own layer and padded out to the size of the
+    // largest texture by repeating its last row and column, which is what TrackTextureAsset::maxU/maxV expect. Mip levels are
+    // generated with a 2x2 box filter (SSE2 where available), in parallel across layers.
+    class TextureArray {
+      public:
+        TextureArray() = default;
+        // Assigns TrackTextureAsset::layer of every texture, in texture ID order. Textures without pixel data, placeholders and
+        // textures that fail to decode leave their layer transparent black and don't count towards the layer size.
+        static TextureArray Build(TrackTextureTable &textureAssets, bool generateMips = true);
+
+        uint32_t LevelWidth(uint32_t const level) const {
+            return std::max(1u, width >> level);
+        }
+        uint32_t LevelHeight(uint32_t const level) const {
+            return std::max(1u, height >> level);
+        }
+        // Bytes of a single layer at a mip level
+        size_t LayerSize(uint32_t const level) const {
+            return static_cast<size_t>(LevelWidth(level)) * LevelHeight(level) * 4;
+        }
+        // Every layer of a mip level, one after another
+        uint8_t const *Level(uint32_t const level) const {
+            return data.data() + levelOffsets[level];
+        }
+        uint8_t const *Layer(uint32_t const level, uint32_t const layer) const {
+            return Level(level) + layer * LayerSize(level);
+        }
+
+        uint32_t width{0};
+        uint32_t height{0};
+        uint32_t nLayers{0};
+        uint32_t nLevels{0};
+        // RGBA8 texels, ordered by mip level, then layer, then row (top to bottom)
+        std::vector<uint8_t> data;
+        std::vector<size_t> levelOffsets;
+    };
+} // namespace LibOpenNFS
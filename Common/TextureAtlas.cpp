@@ -0,0 +1,268 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+
+#include "Logging.h"
+#include "Parallel.h"
+
+namespace LibOpenNFS {
+    namespace {
+        // How far outside [0, 1] a texture's (unscaled) UVs may stray before it counts as tiled
+        constexpr float kUVTolerance{1e-3f};
+
+        // Free space of an atlas page as the heights of horizontal segments across its width
+        class Skyline {
+          public:
+            explicit Skyline(uint32_t const size) : m_size(size), m_segments{{0, 0, size}} {
+            }
+
+            // Lowest top edge position for a w x h rectangle, leftmost on ties
+            bool Find(uint32_t const w, uint32_t const h, uint32_t &bestX, uint32_t &bestY) const {
+                uint32_t bestTop{UINT32_MAX};
+                for (size_t segmentIdx = 0; segmentIdx < m_segments.size(); ++segmentIdx) {
+                    uint32_t const x{m_segments[segmentIdx].x};
+                    if (x + w > m_size) {
+                        break;
+                    }
+                    // Rests on the highest segment it spans
+                    uint32_t y{0};
+                    uint32_t remaining{w};
+                    for (size_t spanIdx = segmentIdx; remaining > 0; ++spanIdx) {
+                        y = std::max(y, m_segments[spanIdx].y);
+                        remaining -= std::min(remaining, m_segments[spanIdx].width);
+                    }
+                    if (y + h <= m_size && y + h < bestTop) {
+                        bestTop = y + h;
+                        bestX = x;
+                        bestY = y;
+                    }
+                }
+                return bestTop != UINT32_MAX;
+            }
+
+            void Insert(uint32_t const x, uint32_t const y, uint32_t const w, uint32_t const h) {
+                std::vector<Segment> segments;
+                segments.reserve(m_segments.size() + 2);
+                bool inserted{false};
+                for (auto const &segment : m_segments) {
+                    uint32_t const segmentEnd{segment.x + segment.width};
+                    if (segmentEnd <= x || segment.x >= x + w) {
+                        if (!inserted && segment.x >= x + w) {
+                            segments.push_back({x, y + h, w});
+                            inserted = true;
+                        }
+                        segments.push_back(segment);
+                        continue;
+                    }
+                    // Keep the parts of overlapped segments either side of the rectangle
+                    if (segment.x < x) {
+                        segments.push_back({segment.x, segment.y, x - segment.x});
+                    }
+                    if (!inserted) {
+                        segments.push_back({x, y + h, w});
+                        inserted = true;
+                    }
+                    if (segmentEnd > x + w) {
+                        segments.push_back({x + w, segment.y, segmentEnd - (x + w)});
+                    }
+                }
+                // Merge neighbours of equal height
+                m_segments.clear();
+                for (auto const &segment : segments) {
+                    if (!m_segments.empty() && m_segments.back().y == segment.y) {
+                        m_segments.back().width += segment.width;
+                    } else {
+                        m_segments.push_back(segment);
+                    }
+                }
+                m_usedHeight = std::max(m_usedHeight, y + h);
+            }
+
+            uint32_t UsedHeight() const {
+                return m_usedHeight;
+            }
+
+          private:
+            struct Segment {
+                uint32_t x;
+                uint32_t y;
+                uint32_t width;
+            };
+
+            uint32_t m_size;
+            uint32_t m_usedHeight{0};
+            std::vector<Segment> m_segments;
+        };
+
+        // Every unique mesh of the track, shared meshes once
+        std::vector<TrackGeometry *> CollectMeshes(Track &track) {
+            std::vector<TrackGeometry *> meshes;
+            std::set<TrackGeometry *> sharedGeometries;
+            auto addEntities = [&](std::vector<TrackEntity> &entities) {
+                for (auto &entity : entities) {
+                    if (!entity.hasGeometry) {
+                        continue;
+                    }
+                    if (!entity.sharedGeometry) {
+                        meshes.push_back(&entity.geometry);
+                    } else if (sharedGeometries.insert(entity.sharedGeometry.get()).second) {
+                        meshes.push_back(entity.sharedGeometry.get());
+                    }
+                }
+            };
+            for (auto &trackBlock : track.trackBlocks) {
+                for (auto *entities : {&trackBlock.track, &trackBlock.objects, &trackBlock.lanes, &trackBlock.lowResTrack,
+                                       &trackBlock.medResTrack}) {
+                    addEntities(*entities);
+                }
+            }
+            addEntities(track.globalObjects);
+            return meshes;
+        }
+    } // namespace
+
+    TextureAtlas TextureAtlas::Build(Track &track, uint32_t const pageSize, uint32_t const gutter) {
+        TextureAtlas atlas;
+        std::vector<TrackGeometry *> const meshes{CollectMeshes(track)};
+
+        // Loaders scale UVs by maxU/maxV for texture arrays, undo that to find the textures meshes tile
+        std::set<uint32_t> tiledTextureIds;
+        for (TrackGeometry const *mesh : meshes) {
+            for (size_t vertexIdx = 0; vertexIdx < mesh->m_uvs.size() && vertexIdx < mesh->m_textureIndices.size(); ++vertexIdx) {
+                auto const textureIt{track.trackTextureAssets.find(mesh->m_textureIndices[vertexIdx])};
+                if (textureIt == track.trackTextureAssets.end() || textureIt->second.maxU <= 0.f || textureIt->second.maxV <= 0.f) {
+                    continue;
+                }
+                glm::vec2 const uv{mesh->m_uvs[vertexIdx] / glm::vec2(textureIt->second.maxU, textureIt->second.maxV)};
+                if (uv.x < -kUVTolerance || uv.y < -kUVTolerance || uv.x > 1.f + kUVTolerance || uv.y > 1.f + kUVTolerance) {
+                    tiledTextureIds.insert(textureIt->first);
+                }
+            }
+        }
+
+        struct Candidate {
+            uint32_t textureId;
+            TrackTextureAsset const *textureAsset;
+            TextureCache::Pixels pixels;
+        };
+        std::vector<Candidate> candidates;
+        uint32_t nextTextureId{0};
+        for (auto const &[textureId, textureAsset] : track.trackTextureAssets) {
+            nextTextureId = std::max(nextTextureId, textureId + 1);
+            if (tiledTextureIds.contains(textureId) || !textureAsset.HasPixelData() || textureAsset.maxU <= 0.f ||
+                textureAsset.maxV <= 0.f || textureAsset.width == 0 || textureAsset.height == 0 ||
+                textureAsset.width + 2 * gutter > pageSize || textureAsset.height + 2 * gutter > pageSize) {
+                continue;
+            }
+            TextureCache::Pixels pixels{textureAsset.Pixels()};
+            if (pixels->size() != static_cast<size_t>(textureAsset.width) * textureAsset.height * 4) {
+                continue;
+            }
+            candidates.push_back({textureId, &textureAsset, std::move(pixels)});
+        }
+        std::sort(candidates.begin(), candidates.end(), [](Candidate const &a, Candidate const &b) {
+            return std::make_tuple(b.textureAsset->height, b.textureAsset->width, a.textureId) <
+                   std::make_tuple(a.textureAsset->height, a.textureAsset->width, b.textureId);
+        });
+
+        // First page with room, opening a new page when none has any
+        std::vector<Skyline> pages;
+        for (auto const &candidate : candidates) {
+            uint32_t const w{candidate.textureAsset->width + 2 * gutter};
+            uint32_t const h{candidate.textureAsset->height + 2 * gutter};
+            uint32_t x{0}, y{0};
+            size_t pageIdx{0};
+            for (; pageIdx < pages.size(); ++pageIdx) {
+                if (pages[pageIdx].Find(w, h, x, y)) {
+                    break;
+                }
+            }
+            if (pageIdx == pages.size()) {
+                pages.emplace_back(pageSize);
+                pages.back().Find(w, h, x, y);
+            }
+            pages[pageIdx].Insert(x, y, w, h);
+            atlas.placements[candidate.textureId] = {nextTextureId + static_cast<uint32_t>(pageIdx), x + gutter, y + gutter,
+                                                     candidate.textureAsset->width, candidate.textureAsset->height};
+        }
+
+        // Page heights are rounded up to whole 4x4 blocks, for block compression
+        std::vector<TrackTextureAsset> pageAssets;
+        for (uint32_t pageIdx = 0; pageIdx < pages.size(); ++pageIdx) {
+            uint32_t const pageHeight{(pages[pageIdx].UsedHeight() + 3) & ~3u};
+            pageAssets.emplace_back(nextTextureId + pageIdx, pageSize, pageHeight,
+                                    std::vector<uint8_t>(static_cast<size_t>(pageSize) * pageHeight * 4, 0));
+            pageAssets.back().maxU = 1.f;
+            pageAssets.back().maxV = 1.f;
+            atlas.pageTextureIds.push_back(nextTextureId + pageIdx);
+        }
+
+        // Copy each texture and its gutter, repeating the edge texels outwards. Rectangles don't overlap, so neither do the writes.
+        Utils::ParallelFor(candidates.size(), [&](size_t const candidateIdx) {
+            Candidate const &candidate{candidates[candidateIdx]};
+            Placement const &placement{atlas.placements.at(candidate.textureId)};
+            TrackTextureAsset &pageAsset{pageAssets[placement.pageTextureId - nextTextureId]};
+            auto const srcWidth{static_cast<int64_t>(placement.width)};
+            auto const srcHeight{static_cast<int64_t>(placement.height)};
+            for (int64_t y = -static_cast<int64_t>(gutter); y < srcHeight + gutter; ++y) {
+                uint8_t const *srcRow{candidate.pixels->data() + std::clamp<int64_t>(y, 0, srcHeight - 1) * srcWidth * 4};
+                uint8_t *dstRow{pageAsset.data.data() + ((placement.y + y) * pageSize + placement.x) * 4};
+                for (int64_t x = -static_cast<int64_t>(gutter); x < 0; ++x) {
+                    std::memcpy(dstRow + x * 4, srcRow, 4);
+                }
+                std::memcpy(dstRow, srcRow, srcWidth * 4);
+                for (int64_t x = srcWidth; x < srcWidth + gutter; ++x) {
+                    std::memcpy(dstRow + x * 4, srcRow + (srcWidth - 1) * 4, 4);
+                }
+            }
+        });
+
+        // Point every vertex using a packed texture at its page instead
+        struct Remap {
+            uint32_t pageTextureId;
+            glm::vec2 uvScale;  // Undoes maxU/maxV
+            glm::vec2 offset;   // Page UV of the texture's origin
+            glm::vec2 size;     // Page UV extent of the texture
+        };
+        std::unordered_map<uint32_t, Remap> remaps;
+        for (auto const &[textureId, placement] : atlas.placements) {
+            TrackTextureAsset const &textureAsset{track.trackTextureAssets.at(textureId)};
+            glm::vec2 const pageDimensions{static_cast<float>(pageSize),
+                                           static_cast<float>(pageAssets[placement.pageTextureId - nextTextureId].height)};
+            remaps[textureId] = {placement.pageTextureId, 1.f / glm::vec2(textureAsset.maxU, textureAsset.maxV),
+                                 glm::vec2(placement.x, placement.y) / pageDimensions,
+                                 glm::vec2(placement.width, placement.height) / pageDimensions};
+        }
+        Utils::ParallelFor(meshes.size(), [&](size_t const meshIdx) {
+            TrackGeometry &mesh{*meshes[meshIdx]};
+            for (size_t vertexIdx = 0; vertexIdx < mesh.m_uvs.size() && vertexIdx < mesh.m_textureIndices.size(); ++vertexIdx) {
+                auto const remapIt{remaps.find(mesh.m_textureIndices[vertexIdx])};
+                if (remapIt == remaps.end()) {
+                    continue;
+                }
+                Remap const &remap{remapIt->second};
+                glm::vec2 const uv{glm::clamp(mesh.m_uvs[vertexIdx] * remap.uvScale, glm::vec2(0.f), glm::vec2(1.f))};
+                mesh.m_uvs[vertexIdx] = remap.offset + uv * remap.size;
+                mesh.m_textureIndices[vertexIdx] = remap.pageTextureId;
+            }
+        });
+
+        size_t packedBytes{0}, pageBytes{0};
+        for (auto const &[textureId, placement] : atlas.placements) {
+            packedBytes += static_cast<size_t>(placement.width) * placement.height * 4;
+            track.trackTextureAssets.erase(textureId);
+        }
+        for (auto &pageAsset : pageAssets) {
+            pageBytes += pageAsset.data.size();
+            track.trackTextureAssets[pageAsset.id] = std::move(pageAsset);
+        }
+        LogInfo("Packed %zu textures (%zu bytes) into %zu %u texel wide atlas pages (%zu bytes), %zu tiled textures left unpacked",
+                atlas.placements.size(), packedBytes, atlas.pageTextureIds.size(), pageSize, pageBytes, tiledTextureIds.size());
+
+        return atlas;
+    }
+} // namespace LibOpenNFS
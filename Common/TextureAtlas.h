@@ -0,0 +1,35 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "Entities/Track.h"
+
+namespace LibOpenNFS {
+    // Packs the textures of a Track into a few large atlas pages, as an alternative to TextureArray that doesn't pad every texture
+    // to the size of the largest. Build replaces the packed textures in Track::trackTextureAssets with one texture per page, and
+    // rewrites the UVs and texture indices of every mesh that used them, in one pass.
+    //
+    // Textures are packed with a skyline bottom-left heuristic, tallest first, each surrounded by a gutter of repeated edge texels
+    // so that filtering (and the first few mip levels) don't bleed between neighbours. Textures a mesh tiles (UVs outside [0, 1]),
+    // textures without pixel data, and textures too large for a page are left as they are.
+    class TextureAtlas {
+      public:
+        struct Placement {
+            uint32_t pageTextureId{0}; // ID of the page in Track::trackTextureAssets
+            uint32_t x{0};             // Texel position of the texture (inside its gutter) on the page
+            uint32_t y{0};
+            uint32_t width{0};
+            uint32_t height{0};
+        };
+
+        TextureAtlas() = default;
+        // Page textures get IDs above the highest existing texture ID. Pages are pageSize wide, and as tall as their contents
+        // (rounded up to a multiple of 4 texels).
+        static TextureAtlas Build(Track &track, uint32_t pageSize = 2048, uint32_t gutter = 2);
+
+        // Where each packed texture (by its original ID) ended up
+        std::map<uint32_t, Placement> placements;
+        std::vector<uint32_t> pageTextureIds;
+    };
+} // namespace LibOpenNFS
@@ -0,0 +1,125 @@
+#include "TextureCache.h"
+
+#include "Parallel.h"
+
+namespace LibOpenNFS {
+    TextureCache::TextureCache(size_t const budgetBytes) : m_budgetBytes(budgetBytes) {
+    }
+
+    std::shared_ptr<TextureCache> const &TextureCache::Global() {
+        static std::shared_ptr<TextureCache> const globalCache{std::make_shared<TextureCache>()};
+        return globalCache;
+    }
+
+    TextureCache::Pixels TextureCache::Get(Shared::FshTexture const &texture) {
+        Key const key{texture.ContentHash(), texture.Width(), texture.Height()};
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (Pixels pixels{_Find(key)}) {
+                ++m_stats.hits;
+                return pixels;
+            }
+            ++m_stats.misses;
+        }
+
+        // Decode without holding the lock so that other textures can be fetched meanwhile. Two threads missing on the same texture
+        // both decode it, the first to finish is cached and shared.
+        Pixels pixels{std::make_shared<std::vector<uint8_t> const>(texture.ToRGBA())};
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.decodedBytes += pixels->size();
+        if (Pixels cachedPixels{_Find(key)}) {
+            return cachedPixels;
+        }
+        m_lru.push_front({key, pixels});
+        m_entries.emplace(key, m_lru.begin());
+        m_stats.residentBytes += pixels->size();
+        _Evict();
+
+        return pixels;
+    }
+
+    std::vector<TextureCache::Pixels> TextureCache::GetMany(std::vector<Shared::FshTexture const *> const &textures,
+                                                            size_t const maxThreads) {
+        std::vector<Pixels> pixels(textures.size());
+        Utils::ParallelFor(textures.size(), [&](size_t const textureIdx) { pixels[textureIdx] = Get(*textures[textureIdx]); }, maxThreads);
+        return pixels;
+    }
+
+    std::vector<std::vector<uint8_t>> TextureCache::DecodeMany(std::vector<Shared::FshTexture const *> const &textures,
+                                                               size_t const maxThreads) {
+        std::vector<std::vector<uint8_t>> pixels(textures.size());
+        Utils::ParallelFor(
+            textures.size(), [&](size_t const textureIdx) { pixels[textureIdx] = textures[textureIdx]->ToRGBA(); }, maxThreads);
+        return pixels;
+    }
+
+    void TextureCache::SetBudget(size_t const budgetBytes) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_budgetBytes = budgetBytes;
+        _Evict();
+    }
+
+    void TextureCache::Clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+        m_lru.clear();
+        m_evicted.clear();
+        m_stats.residentBytes = 0;
+    }
+
+    size_t TextureCache::Budget() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_budgetBytes;
+    }
+
+    size_t TextureCache::ResidentBytes() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats.residentBytes;
+    }
+
+    TextureCache::Stats TextureCache::GetStats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    TextureCache::Pixels TextureCache::_Find(Key const &key) {
+        auto const entryIt{m_entries.find(key)};
+        if (entryIt != m_entries.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, entryIt->second);
+            return entryIt->second->pixels;
+        }
+        // Pixels evicted while a caller still held them come back into the cache
+        auto const evictedIt{m_evicted.find(key)};
+        if (evictedIt == m_evicted.end()) {
+            return nullptr;
+        }
+        Pixels pixels{evictedIt->second.lock()};
+        m_evicted.erase(evictedIt);
+        if (pixels) {
+            m_lru.push_front({key, pixels});
+            m_entries.emplace(key, m_lru.begin());
+            m_stats.residentBytes += pixels->size();
+            _Evict();
+        }
+        return pixels;
+    }
+
+    void TextureCache::_Evict() {
+        // The most recently used texture is always kept, even if it alone exceeds the budget
+        while (m_stats.residentBytes > m_budgetBytes && m_lru.size() > 1) {
+            Entry const &entry{m_lru.back()};
+            m_stats.residentBytes -= entry.pixels->size();
+            ++m_stats.evictions;
+            if (entry.pixels.use_count() > 1) {
+                m_evicted[entry.key] = entry.pixels;
+            }
+            m_entries.erase(entry.key);
+            m_lru.pop_back();
+        }
+        // Forget evicted pixels nobody holds any more, once they outnumber the cached ones
+        if (m_evicted.size() > 2 * m_entries.size() + 64) {
+            std::erase_if(m_evicted, [](auto const &evicted) { return evicted.second.expired(); });
+        }
+    }
+} // namespace LibOpenNFS
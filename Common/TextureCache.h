@@ -0,0 +1,86 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Shared/FSH/FshArchive.h"
+
+namespace LibOpenNFS {
+    // RGBA pixels of FSH textures, decoded on demand and keyed by the content of the source texture, so that identical textures
+    // (whichever archive, track or car they come from) are decoded once and share a single buffer. Cached pixels are kept within
+    // a byte budget by evicting the least recently used. Pixels are handed out as shared pointers, so evicting a texture never
+    // invalidates pixels a caller still holds, and while any caller holds them they are still shared rather than decoded again.
+    // Safe to use from multiple threads.
+    class TextureCache {
+      public:
+        using Pixels = std::shared_ptr<std::vector<uint8_t> const>;
+
+        struct Stats {
+            size_t hits{0};
+            size_t misses{0};
+            size_t evictions{0};
+            size_t decodedBytes{0};  // RGBA bytes produced by every decode so far
+            size_t residentBytes{0}; // RGBA bytes currently cached
+        };
+
+        explicit TextureCache(size_t budgetBytes = 128u << 20);
+        // Process-wide cache, for callers sharing decoded pixels with everything else loaded in the process
+        static std::shared_ptr<TextureCache> const &Global();
+
+        // RGBA pixels of texture, decoded unless a texture with identical content is cached or still held
+        Pixels Get(Shared::FshTexture const &texture);
+        // Get for every texture, decoding in parallel across up to maxThreads threads (0 = hardware concurrency). Pixels are in the
+        // order of textures. Decode errors are rethrown on the calling thread once every texture has been attempted.
+        std::vector<Pixels> GetMany(std::vector<Shared::FshTexture const *> const &textures, size_t maxThreads = 0);
+        // RGBA pixels of every texture, decoded in parallel as by GetMany but without going through any cache, for callers that keep
+        // the only copy of the pixels
+        static std::vector<std::vector<uint8_t>> DecodeMany(std::vector<Shared::FshTexture const *> const &textures, size_t maxThreads = 0);
+        // Evict least recently used textures until the cached pixels fit in budgetBytes
+        void SetBudget(size_t budgetBytes);
+        void Clear();
+
+        size_t Budget() const;
+        size_t ResidentBytes() const;
+        Stats GetStats() const;
+
+      private:
+        // Textures are matched by their 64-bit content hash (hashed once per texture, see FshTexture::CacheContentHash) without
+        // comparing the source data, so a hit costs no pass over the texture. Textures of the same size whose hashes collide would
+        // share pixels; among n distinct textures the odds of any accidental collision are about n^2 / 2^65, around 3e-10 for a
+        // hundred thousand textures, which is accepted.
+        struct Key {
+            uint64_t contentHash;
+            uint16_t width;
+            uint16_t height;
+
+            bool operator==(Key const &other) const {
+                return contentHash == other.contentHash && width == other.width && height == other.height;
+            }
+        };
+        struct KeyHash {
+            size_t operator()(Key const &key) const {
+                return static_cast<size_t>(key.contentHash);
+            }
+        };
+        struct Entry {
+            Key key;
+            Pixels pixels;
+        };
+
+        // Caller must hold m_mutex
+        Pixels _Find(Key const &key);
+        void _Evict();
+
+        mutable std::mutex m_mutex;
+        size_t m_budgetBytes;
+        Stats m_stats;
+        // Most recently used at the front
+        std::list<Entry> m_lru;
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_entries;
+        // Evicted pixels, which can still be shared for as long as a caller holds them
+        std::unordered_map<Key, std::weak_ptr<std::vector<uint8_t> const>, KeyHash> m_evicted;
+    };
+} // namespace LibOpenNFS
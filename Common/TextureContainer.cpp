@@ -0,0 +1,324 @@
+#include "TextureContainer.h"
+
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+#include "Entities/TrackTextureTable.h"
+#include "Parallel.h"
+#include "Shared/FSH/FshArchive.h"
+
+namespace LibOpenNFS {
+    namespace {
+        // DDS_HEADER flags and caps
+        constexpr uint32_t DDSD_CAPS{0x1}, DDSD_HEIGHT{0x2}, DDSD_WIDTH{0x4}, DDSD_PITCH{0x8}, DDSD_PIXELFORMAT{0x1000},
+                           DDSD_MIPMAPCOUNT{0x20000}, DDSD_LINEARSIZE{0x80000};
+        constexpr uint32_t DDSCAPS_COMPLEX{0x8}, DDSCAPS_TEXTURE{0x1000}, DDSCAPS_MIPMAP{0x400000};
+        // DDS_PIXELFORMAT flags
+        constexpr uint32_t DDPF_ALPHAPIXELS{0x1}, DDPF_FOURCC{0x4}, DDPF_RGB{0x40};
+        constexpr uint32_t DDS_DIMENSION_TEXTURE2D{3};
+
+        // Data format descriptor values of the KTX2 basic descriptor block
+        constexpr uint32_t KHR_DF_MODEL_RGBSDA{1}, KHR_DF_MODEL_BC1A{128}, KHR_DF_MODEL_BC2{129}, KHR_DF_MODEL_BC3{130};
+        constexpr uint32_t KHR_DF_PRIMARIES_BT709{1}, KHR_DF_TRANSFER_LINEAR{1};
+        constexpr uint32_t KHR_DF_CHANNEL_RED{0}, KHR_DF_CHANNEL_GREEN{1}, KHR_DF_CHANNEL_BLUE{2}, KHR_DF_CHANNEL_ALPHA{15};
+        constexpr uint32_t KHR_DF_CHANNEL_BC1A_ALPHAPRESENT{1}, KHR_DF_CHANNEL_BC_COLOR{0}, KHR_DF_CHANNEL_BC_ALPHA{15};
+        constexpr uint8_t KTX2_IDENTIFIER[12]{0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+        struct FormatCodes {
+            uint32_t dxgiFormat;
+            char fourCC[4];
+            uint32_t vkFormat;
+            uint32_t colourModel;
+        };
+
+        FormatCodes GetFormatCodes(BlockFormat const format) {
+            switch (format) {
+            case BlockFormat::BC1:
+                return {71, {'D', 'X', 'T', '1'}, 133, KHR_DF_MODEL_BC1A}; // BC1_UNORM, VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+            case BlockFormat::BC2:
+                return {74, {'D', 'X', 'T', '3'}, 135, KHR_DF_MODEL_BC2}; // BC2_UNORM, VK_FORMAT_BC2_UNORM_BLOCK
+            case BlockFormat::BC3:
+                return {77, {'D', 'X', 'T', '5'}, 137, KHR_DF_MODEL_BC3}; // BC3_UNORM, VK_FORMAT_BC3_UNORM_BLOCK
+            default:
+                return {28, {0, 0, 0, 0}, 37, KHR_DF_MODEL_RGBSDA}; // R8G8B8A8_UNORM, VK_FORMAT_R8G8B8A8_UNORM
+            }
+        }
+
+        // Little-endian fields appended to a file under construction
+        void Put32(std::vector<uint8_t> &file, uint32_t const value) {
+            for (uint32_t byteIdx = 0; byteIdx < 4; ++byteIdx) {
+                file.push_back(static_cast<uint8_t>(value >> (byteIdx * 8)));
+            }
+        }
+        void Put64(std::vector<uint8_t> &file, uint64_t const value) {
+            Put32(file, static_cast<uint32_t>(value));
+            Put32(file, static_cast<uint32_t>(value >> 32));
+        }
+        void Set64(std::vector<uint8_t> &file, size_t const offset, uint64_t const value) {
+            for (uint32_t byteIdx = 0; byteIdx < 8; ++byteIdx) {
+                file[offset + byteIdx] = static_cast<uint8_t>(value >> (byteIdx * 8));
+            }
+        }
+
+        TextureContainer FromFshTextures(std::vector<Shared::FshTexture const *> const &textures, bool const generateMips,
+                                         BlockFormat const format, CompressionQuality const quality) {
+            if (textures.empty()) {
+                return {};
+            }
+
+            // Identical DXT textures stack into an array as stored
+            Shared::FshTexture const &first{*textures.front()};
+            BlockFormat const storedFormat{first.Format() == Shared::PixelFormat::DXT1   ? BlockFormat::BC1
+                                           : first.Format() == Shared::PixelFormat::DXT3 ? BlockFormat::BC2
+                                                                                         : BlockFormat::None};
+            bool const passthrough{storedFormat != BlockFormat::None && (format == BlockFormat::None || format == storedFormat) &&
+                                   std::all_of(textures.begin(), textures.end(), [&](Shared::FshTexture const *texture) {
+                                       return texture->Format() == first.Format() && texture->Width() == first.Width() &&
+                                              texture->Height() == first.Height() && !texture->DXTBlocks().empty();
+                                   })};
+            if (passthrough) {
+                TextureContainer container;
+                container.width = first.Width();
+                container.height = first.Height();
+                container.nLayers = static_cast<uint32_t>(textures.size());
+                container.nLevels = 1;
+                container.format = storedFormat;
+                container.levelOffsets.push_back(0);
+                size_t const layerSize{container.LayerSize(0)};
+                container.data.resize(layerSize * textures.size());
+                for (size_t layer = 0; layer < textures.size(); ++layer) {
+                    std::memcpy(container.data.data() + layer * layerSize, textures[layer]->DXTBlocks().data(), layerSize);
+                }
+                return container;
+            }
+
+            TrackTextureTable textureAssets;
+            std::vector<std::vector<uint8_t>> pixels(textures.size());
+            Utils::ParallelFor(textures.size(), [&](size_t const textureIdx) {
+                try {
+                    pixels[textureIdx] = textures[textureIdx]->ToRGBA();
+                } catch (std::exception const &) {
+                    // Left without pixels, so its layer stays empty
+                }
+            });
+            for (size_t textureIdx = 0; textureIdx < textures.size(); ++textureIdx) {
+                uint32_t const id{static_cast<uint32_t>(textureIdx)};
+                textureAssets[id] =
+                    TrackTextureAsset(id, textures[textureIdx]->Width(), textures[textureIdx]->Height(), std::move(pixels[textureIdx]));
+            }
+            return TextureContainer::FromTextureArray(TextureArray::Build(textureAssets, generateMips), format, quality);
+        }
+    } // namespace
+
+    TextureContainer TextureContainer::FromTextureArray(TextureArray const &textureArray, BlockFormat const format,
+                                                        CompressionQuality const quality) {
+        if (format != BlockFormat::None && format != BlockFormat::BC1 && format != BlockFormat::BC3) {
+            throw std::invalid_argument("Texture arrays can only be block compressed to BC1 or BC3");
+        }
+
+        TextureContainer container;
+        container.width = textureArray.width;
+        container.height = textureArray.height;
+        container.nLayers = textureArray.nLayers;
+        container.nLevels = textureArray.nLevels;
+        container.format = format;
+        if (format == BlockFormat::None) {
+            container.data = textureArray.data;
+            container.levelOffsets = textureArray.levelOffsets;
+            return container;
+        }
+
+        size_t nBytes{0};
+        for (uint32_t level = 0; level < container.nLevels; ++level) {
+            container.levelOffsets.push_back(nBytes);
+            nBytes += container.LayerSize(level) * container.nLayers;
+        }
+        container.data.resize(nBytes);
+        Utils::ParallelFor(static_cast<size_t>(container.nLevels) * container.nLayers, [&](size_t const imageIdx) {
+            uint32_t const level{static_cast<uint32_t>(imageIdx / container.nLayers)};
+            uint32_t const layer{static_cast<uint32_t>(imageIdx % container.nLayers)};
+            uint8_t const *const texels{textureArray.Layer(level, layer)};
+            std::vector<uint8_t> const rgba(texels, texels + textureArray.LayerSize(level));
+            std::vector<uint8_t> const blocks{
+                BlockCompression::Encode(rgba, container.LevelWidth(level), container.LevelHeight(level), format, quality)};
+            std::memcpy(container.data.data() + container.levelOffsets[level] + layer * container.LayerSize(level), blocks.data(),
+                        blocks.size());
+        });
+        return container;
+    }
+
+    TextureContainer TextureContainer::FromFshArchive(Shared::FshArchive const &archive, bool const generateMips,
+                                                      BlockFormat const format, CompressionQuality const quality) {
+        std::vector<Shared::FshTexture const *> textures;
+        for (Shared::FshTexture const &texture : archive.Textures()) {
+            textures.push_back(&texture);
+        }
+        return FromFshTextures(textures, generateMips, format, quality);
+    }
+
+    TextureContainer TextureContainer::FromFshTexture(Shared::FshTexture const &texture, bool const generateMips,
+                                                      BlockFormat const format, CompressionQuality const quality) {
+        return FromFshTextures({&texture}, generateMips, format, quality);
+    }
+
+    size_t TextureContainer::LayerSize(uint32_t const level) const {
+        if (format == BlockFormat::None) {
+            return static_cast<size_t>(LevelWidth(level)) * LevelHeight(level) * 4;
+        }
+        return BlockCompression::CompressedSize(format, LevelWidth(level), LevelHeight(level));
+    }
+
+    std::vector<uint8_t> TextureContainer::Serialize(TextureContainerFormat const containerFormat) const {
+        if (nLayers == 0 || nLevels == 0) {
+            return {};
+        }
+        return containerFormat == TextureContainerFormat::DDS ? _SerializeDDS() : _SerializeKTX2();
+    }
+
+    bool TextureContainer::Write(std::string const &filepath, TextureContainerFormat const containerFormat) const {
+        std::vector<uint8_t> const file{Serialize(containerFormat)};
+        if (file.empty()) {
+            return false;
+        }
+        std::ofstream outFile(filepath, std::ios::binary);
+        if (!outFile.is_open()) {
+            return false;
+        }
+        outFile.write(reinterpret_cast<char const *>(file.data()), static_cast<std::streamsize>(file.size()));
+        return outFile.good();
+    }
+
+    std::vector<uint8_t> TextureContainer::_SerializeDDS() const {
+        FormatCodes const codes{GetFormatCodes(format)};
+        bool const isArray{nLayers > 1};
+
+        std::vector<uint8_t> file;
+        file.reserve(148 + data.size());
+        file.insert(file.end(), {'D', 'D', 'S', ' '});
+        // DDS_HEADER
+        Put32(file, 124);
+        Put32(file, DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | (nLevels > 1 ? DDSD_MIPMAPCOUNT : 0) |
+                        (format == BlockFormat::None ? DDSD_PITCH : DDSD_LINEARSIZE));
+        Put32(file, height);
+        Put32(file, width);
+        Put32(file, static_cast<uint32_t>(format == BlockFormat::None ? static_cast<size_t>(width) * 4 : LayerSize(0)));
+        Put32(file, 0); // Depth
+        Put32(file, nLevels);
+        file.resize(file.size() + 11 * 4); // Reserved
+        // DDS_PIXELFORMAT, a FourCC for block formats and arrays, RGBA bit masks otherwise
+        Put32(file, 32);
+        if (isArray || format != BlockFormat::None) {
+            Put32(file, DDPF_FOURCC);
+            file.insert(file.end(), isArray ? std::initializer_list<uint8_t>{'D', 'X', '1', '0'}
+                                            : std::initializer_list<uint8_t>{static_cast<uint8_t>(codes.fourCC[0]),
+                                                                             static_cast<uint8_t>(codes.fourCC[1]),
+                                                                             static_cast<uint8_t>(codes.fourCC[2]),
+                                                                             static_cast<uint8_t>(codes.fourCC[3])});
+            file.resize(file.size() + 5 * 4);
+        } else {
+            Put32(file, DDPF_RGB | DDPF_ALPHAPIXELS);
+            Put32(file, 0);
+            Put32(file, 32);
+            Put32(file, 0x000000FF);
+            Put32(file, 0x0000FF00);
+            Put32(file, 0x00FF0000);
+            Put32(file, 0xFF000000);
+        }
+        Put32(file, DDSCAPS_TEXTURE | (nLevels > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0));
+        file.resize(file.size() + 4 * 4); // Caps2-4, reserved
+        if (isArray) {
+            // DDS_HEADER_DXT10
+            Put32(file, codes.dxgiFormat);
+            Put32(file, DDS_DIMENSION_TEXTURE2D);
+            Put32(file, 0);
+            Put32(file, nLayers);
+            Put32(file, 0);
+        }
+
+        // DDS stores each layer's complete mip chain in turn
+        for (uint32_t layer = 0; layer < nLayers; ++layer) {
+            for (uint32_t level = 0; level < nLevels; ++level) {
+                file.insert(file.end(), Layer(level, layer), Layer(level, layer) + LayerSize(level));
+            }
+        }
+        return file;
+    }
+
+    std::vector<uint8_t> TextureContainer::_SerializeKTX2() const {
+        FormatCodes const codes{GetFormatCodes(format)};
+        uint32_t const bytesPerBlock{format == BlockFormat::None ? 4u : static_cast<uint32_t>(BlockCompression::BlockSize(format))};
+
+        // Data format descriptor, a single basic block with a sample per channel (RGBA8) or per compressed component (BCn)
+        struct Sample {
+            uint32_t bitOffset, bitLength, channel, upper;
+        };
+        std::vector<Sample> samples;
+        switch (format) {
+        case BlockFormat::None:
+            samples = {{0, 8, KHR_DF_CHANNEL_RED, 255},
+                       {8, 8, KHR_DF_CHANNEL_GREEN, 255},
+                       {16, 8, KHR_DF_CHANNEL_BLUE, 255},
+                       {24, 8, KHR_DF_CHANNEL_ALPHA, 255}};
+            break;
+        case BlockFormat::BC1:
+            samples = {{0, 64, KHR_DF_CHANNEL_BC1A_ALPHAPRESENT, UINT32_MAX}};
+            break;
+        default:
+            samples = {{0, 64, KHR_DF_CHANNEL_BC_ALPHA, UINT32_MAX}, {64, 64, KHR_DF_CHANNEL_BC_COLOR, UINT32_MAX}};
+            break;
+        }
+        uint32_t const blockDimension{format == BlockFormat::None ? 0u : 3u}; // Texels per block minus one
+        std::vector<uint8_t> dfd;
+        Put32(dfd, static_cast<uint32_t>(4 + 24 + 16 * samples.size()));
+        Put32(dfd, 0); // Khronos vendor, basic descriptor type
+        Put32(dfd, 2 | static_cast<uint32_t>(24 + 16 * samples.size()) << 16);
+        Put32(dfd, codes.colourModel | KHR_DF_PRIMARIES_BT709 << 8 | KHR_DF_TRANSFER_LINEAR << 16);
+        Put32(dfd, blockDimension | blockDimension << 8);
+        Put32(dfd, bytesPerBlock);
+        Put32(dfd, 0);
+        for (Sample const &sample : samples) {
+            Put32(dfd, sample.bitOffset | (sample.bitLength - 1) << 16 | sample.channel << 24);
+            Put32(dfd, 0); // Sample position
+            Put32(dfd, 0);
+            Put32(dfd, sample.upper);
+        }
+
+        uint32_t const levelIndexOffset{80};
+        uint32_t const dfdOffset{levelIndexOffset + 24 * nLevels};
+        std::vector<uint8_t> file;
+        file.reserve(dfdOffset + dfd.size() + data.size() + 16 * nLevels);
+        file.insert(file.end(), std::begin(KTX2_IDENTIFIER), std::end(KTX2_IDENTIFIER));
+        Put32(file, codes.vkFormat);
+        Put32(file, 1); // Type size
+        Put32(file, width);
+        Put32(file, height);
+        Put32(file, 0);                        // Depth
+        Put32(file, nLayers > 1 ? nLayers : 0); // 0 for a non-array texture
+        Put32(file, 1);                        // Faces
+        Put32(file, nLevels);
+        Put32(file, 0); // No supercompression
+        Put32(file, dfdOffset);
+        Put32(file, static_cast<uint32_t>(dfd.size()));
+        Put32(file, 0); // No key/value data
+        Put32(file, 0);
+        Put64(file, 0); // No supercompression global data
+        Put64(file, 0);
+        file.resize(dfdOffset);
+        file.insert(file.end(), dfd.begin(), dfd.end());
+
+        // Levels are stored smallest first, each aligned to a multiple of the block size and 4 bytes
+        size_t const alignment{std::lcm(static_cast<size_t>(bytesPerBlock), size_t{4})};
+        for (uint32_t level = nLevels; level-- > 0;) {
+            file.resize((file.size() + alignment - 1) / alignment * alignment);
+            size_t const levelSize{LayerSize(level) * nLayers};
+            Set64(file, levelIndexOffset + 24 * level, file.size());
+            Set64(file, levelIndexOffset + 24 * level + 8, levelSize);
+            Set64(file, levelIndexOffset + 24 * level + 16, levelSize);
+            file.insert(file.end(), data.begin() + static_cast<std::ptrdiff_t>(levelOffsets[level]),
+                        data.begin() + static_cast<std::ptrdiff_t>(levelOffsets[level] + levelSize));
+        }
+        return file;
+    }
+} // namespace LibOpenNFS
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "BlockCompression.h"
+#include "TextureArray.h"
+
+namespace LibOpenNFS {
+    namespace Shared {
+        class FshArchive;
+        class FshTexture;
+    } // namespace Shared
+
+    enum class TextureContainerFormat : uint8_t {
+        DDS,  // DirectDraw Surface, with a DX10 header for arrays
+        KTX2, // Khronos texture 2.0, without supercompression
+    };
+
+    // A texture or texture array with its mip chain in the layout GPUs consume, either RGBA8 texels or BC1/BC2/BC3 blocks, that can
+    // be written out as a DDS or KTX2 file for renderers to map and upload without decoding. Rows run top to bottom, as with
+    // FshTexture::ToRGBA and TextureArray.
+    class TextureContainer {
+      public:
+        TextureContainer() = default;
+
+        // The layers and mip levels of textureArray, block compressed to format (BC1 or BC3) unless it is None. Layers are
+        // compressed in parallel.
+        static TextureContainer FromTextureArray(TextureArray const &textureArray, BlockFormat format = BlockFormat::None,
+                                                 CompressionQuality quality = CompressionQuality::Normal);
+        // Every texture of archive as a layer, in archive order. When every texture is DXT1 or DXT3 of a single size, and format
+        // is None or the matching BC1/BC2, the blocks are taken as stored without decoding (in a single mip level, as mips would
+        // need a decode). Otherwise the textures are decoded in parallel, packed as by TextureArray::Build and compressed to format.
+        static TextureContainer FromFshArchive(Shared::FshArchive const &archive, bool generateMips = true,
+                                               BlockFormat format = BlockFormat::None,
+                                               CompressionQuality quality = CompressionQuality::Normal);
+        // A single texture (one layer), as FromFshArchive
+        static TextureContainer FromFshTexture(Shared::FshTexture const &texture, bool generateMips = true,
+                                               BlockFormat format = BlockFormat::None,
+                                               CompressionQuality quality = CompressionQuality::Normal);
+
+        uint32_t LevelWidth(uint32_t const level) const {
+            return std::max(1u, width >> level);
+        }
+        uint32_t LevelHeight(uint32_t const level) const {
+            return std::max(1u, height >> level);
+        }
+        // Bytes of a single layer at a mip level
+        size_t LayerSize(uint32_t level) const;
+        uint8_t const *Layer(uint32_t const level, uint32_t const layer) const {
+            return data.data() + levelOffsets[level] + layer * LayerSize(level);
+        }
+
+        // The complete file. Arrays are written as such, a single layer as a plain 2D texture.
+        std::vector<uint8_t> Serialize(TextureContainerFormat containerFormat) const;
+        // Serialize to a file, written in one go
+        bool Write(std::string const &filepath, TextureContainerFormat containerFormat) const;
+
+        uint32_t width{0};
+        uint32_t height{0};
+        uint32_t nLayers{0};
+        uint32_t nLevels{0};
+        // None for RGBA8 texels
+        BlockFormat format{BlockFormat::None};
+        // Texels or blocks ordered by mip level, then layer, then row
+        std::vector<uint8_t> data;
+        std::vector<size_t> levelOffsets;
+
+      private:
+        std::vector<uint8_t> _SerializeDDS() const;
+        std::vector<uint8_t> _SerializeKTX2() const;
+    };
+} // namespace LibOpenNFS
@@ -173,23 +173,10 @@ namespace LibOpenNFS {
             break;
         }
 
+        // Sky textures (NFS3 sky.fsh) aren't extracted, the loader reads them in memory into Track::skyTextureAssets
         LogInfo("Extracting track textures");
         std::string onfsTrackAssetTextureDir = outPath + "/textures/";
 
-        switch (nfsVer) {
-        case NFSVersion::NFS_3: {
-            std::stringstream nfsSkyTexArchivePath;
-            nfsSkyTexArchivePath << fullTrackPath.substr(0, fullTrackPath.find_last_of('/')) << "/sky.fsh";
-            if (std::filesystem::exists(nfsSkyTexArchivePath.str())) {
-                std::string onfsTrackAssetSkyTexDir = outPath + "/sky_textures/";
-                ASSERT(ExtractQFS(nfsSkyTexArchivePath.str(), onfsTrackAssetSkyTexDir),
-                       "Unable to extract sky textures from " << nfsSkyTexArchivePath.str());
-            }
-        } break;
-        default:
-            break;
-        }
-
         return ExtractQFS(nfsTexArchivePath.str(), onfsTrackAssetTextureDir, nfsVer == NFSVersion::NFS_4);
     }
 
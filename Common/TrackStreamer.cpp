@@ -0,0 +1,214 @@
+#include "TrackStreamer.h"
+
+#include <set>
+
+#include "Logging.h"
+
+namespace LibOpenNFS {
+    bool TrackStreamer::Open(std::string const &cookedTrackPath, TrackStreamer &trackStreamer, StreamingOptions const &options) {
+        trackStreamer = {};
+        trackStreamer.m_options = options;
+        if (!Shared::CookedTrackFile::Open(cookedTrackPath, trackStreamer.m_cookedTrackFile, trackStreamer.m_track)) {
+            return false;
+        }
+        Track &track{trackStreamer.m_track};
+        trackStreamer.m_blocks.resize(track.trackBlocks.size());
+        trackStreamer.m_blockGraph = BlockGraph::Build(track.trackBlocks, options.residentHops);
+        for (uint32_t textureIdx = 0; textureIdx < trackStreamer.m_cookedTrackFile.textures.size(); ++textureIdx) {
+            trackStreamer.m_textures[trackStreamer.m_cookedTrackFile.textures[textureIdx].id].tableIdx = textureIdx;
+        }
+
+        // Global objects are always resident, so are their textures
+        std::set<uint32_t> globalTextureIds;
+        for (auto const &entity : track.globalObjects) {
+            globalTextureIds.insert(entity.Mesh().m_textureIndices.begin(), entity.Mesh().m_textureIndices.end());
+        }
+        for (uint32_t const textureId : globalTextureIds) {
+            auto const textureIt{trackStreamer.m_textures.find(textureId)};
+            if (textureIt == trackStreamer.m_textures.end()) {
+                continue;
+            }
+            if (!trackStreamer.m_cookedTrackFile.ReadTexture(textureIt->second.tableIdx, track.trackTextureAssets[textureId])) {
+                LogWarning("Failed to read texture %u of %s", textureId, cookedTrackPath.c_str());
+                track.trackTextureAssets.erase(textureId);
+                continue;
+            }
+            textureIt->second.pinned = true;
+        }
+        trackStreamer.m_meshes.resize(trackStreamer.m_cookedTrackFile.meshes.size());
+        for (uint32_t const meshIdx : trackStreamer.m_cookedTrackFile.globalMeshIndices) {
+            trackStreamer.m_meshes[meshIdx].pinned = true;
+        }
+        LogInfo("Streaming %zu blocks and %zu textures of %s with a %zu byte budget", track.trackBlocks.size(),
+                trackStreamer.m_textures.size(), track.name.c_str(), options.budgetBytes);
+
+        return true;
+    }
+
+    TrackStreamer::UpdateResult TrackStreamer::Update(glm::vec3 const &focusPosition) {
+        UpdateResult result;
+        if (m_blocks.empty()) {
+            return result;
+        }
+        ++m_updateIdx;
+        result.focusBlockIdx = _FocusBlock(focusPosition);
+        auto const wantedBlocks{m_blockGraph.WithinHops(result.focusBlockIdx, m_options.residentHops)};
+        for (uint32_t const blockIdx : wantedBlocks) {
+            m_blocks[blockIdx].lastWantedUpdate = m_updateIdx;
+        }
+
+        for (uint32_t const blockIdx : wantedBlocks) {
+            if (m_blocks[blockIdx].resident) {
+                continue;
+            }
+            // Make room by evicting the least recently wanted blocks, never ones wanted by this update
+            while (m_residentBytes + _BytesToLoad(blockIdx) > m_options.budgetBytes) {
+                uint32_t evictIdx{UINT32_MAX};
+                for (uint32_t candidateIdx = 0; candidateIdx < m_blocks.size(); ++candidateIdx) {
+                    BlockState const &candidate{m_blocks[candidateIdx]};
+                    if (candidate.resident && candidate.lastWantedUpdate < m_updateIdx &&
+                        (evictIdx == UINT32_MAX || candidate.lastWantedUpdate < m_blocks[evictIdx].lastWantedUpdate)) {
+                        evictIdx = candidateIdx;
+                    }
+                }
+                if (evictIdx == UINT32_MAX) {
+                    break;
+                }
+                _EvictBlock(evictIdx, result);
+            }
+            if (m_residentBytes + _BytesToLoad(blockIdx) > m_options.budgetBytes) {
+                LogWarning("Streaming budget of %zu bytes is too small for the blocks within %u hops of block %u", m_options.budgetBytes,
+                           m_options.residentHops, result.focusBlockIdx);
+                break;
+            }
+            _LoadBlock(blockIdx, result);
+        }
+
+        return result;
+    }
+
+    uint32_t TrackStreamer::_FocusBlock(glm::vec3 const &focusPosition) const {
+        std::vector<uint32_t> candidates;
+        m_track.blockBVH.Query(AABB(focusPosition, focusPosition), candidates);
+        if (candidates.empty()) {
+            candidates.resize(m_track.trackBlocks.size());
+            for (uint32_t blockIdx = 0; blockIdx < candidates.size(); ++blockIdx) {
+                candidates[blockIdx] = blockIdx;
+            }
+        }
+        // Closest bounds, ties (overlapping bounds) broken by the distance to the block centre
+        uint32_t focusBlockIdx{candidates.front()};
+        float bestBoundsDistance{FLT_MAX}, bestCentreDistance{FLT_MAX};
+        for (uint32_t const blockIdx : candidates) {
+            TrackBlock const &trackBlock{m_track.trackBlocks[blockIdx]};
+            float const boundsDistance{trackBlock.bounds.IsValid() ? trackBlock.bounds.DistanceSquared(focusPosition) : FLT_MAX};
+            float const centreDistance{glm::dot(trackBlock.position - focusPosition, trackBlock.position - focusPosition)};
+            if (boundsDistance < bestBoundsDistance || (boundsDistance == bestBoundsDistance && centreDistance < bestCentreDistance)) {
+                focusBlockIdx = blockIdx;
+                bestBoundsDistance = boundsDistance;
+                bestCentreDistance = centreDistance;
+            }
+        }
+        return focusBlockIdx;
+    }
+
+    size_t TrackStreamer::_BytesToLoad(uint32_t const blockIdx) const {
+        size_t bytes{m_cookedTrackFile.blocks[blockIdx].size};
+        for (uint32_t const textureId : m_cookedTrackFile.blocks[blockIdx].textureIds) {
+            auto const textureIt{m_textures.find(textureId)};
+            if (textureIt != m_textures.end() && textureIt->second.refCount == 0 && !textureIt->second.pinned) {
+                bytes += m_cookedTrackFile.textures[textureIt->second.tableIdx].size;
+            }
+        }
+        for (uint32_t const meshIdx : m_cookedTrackFile.blocks[blockIdx].meshIndices) {
+            if (m_meshes[meshIdx].refCount == 0 && !m_meshes[meshIdx].pinned) {
+                bytes += m_cookedTrackFile.meshes[meshIdx].size;
+            }
+        }
+        return bytes;
+    }
+
+    bool TrackStreamer::_LoadBlock(uint32_t const blockIdx, UpdateResult &result) {
+        TrackBlock &trackBlock{m_track.trackBlocks[blockIdx]};
+        if (!m_cookedTrackFile.ReadBlock(blockIdx, trackBlock)) {
+            LogWarning("Failed to read block %u of %s", trackBlock.id, m_track.name.c_str());
+            trackBlock.track.clear();
+            trackBlock.objects.clear();
+            trackBlock.lanes.clear();
+            trackBlock.lowResTrack.clear();
+            trackBlock.medResTrack.clear();
+            trackBlock.lights.clear();
+            trackBlock.sounds.clear();
+            return false;
+        }
+        for (uint32_t const textureId : m_cookedTrackFile.blocks[blockIdx].textureIds) {
+            _AcquireTexture(textureId, result);
+        }
+        for (uint32_t const meshIdx : m_cookedTrackFile.blocks[blockIdx].meshIndices) {
+            if (m_meshes[meshIdx].refCount++ == 0 && !m_meshes[meshIdx].pinned) {
+                m_residentBytes += m_cookedTrackFile.meshes[meshIdx].size;
+            }
+        }
+        m_blocks[blockIdx].resident = true;
+        m_residentBytes += m_cookedTrackFile.blocks[blockIdx].size;
+        result.loadedBlocks.push_back(blockIdx);
+
+        return true;
+    }
+
+    void TrackStreamer::_EvictBlock(uint32_t const blockIdx, UpdateResult &result) {
+        TrackBlock &trackBlock{m_track.trackBlocks[blockIdx]};
+        // Swap with empty vectors so that the memory is actually returned
+        std::vector<TrackEntity>().swap(trackBlock.track);
+        std::vector<TrackEntity>().swap(trackBlock.objects);
+        std::vector<TrackEntity>().swap(trackBlock.lanes);
+        std::vector<TrackEntity>().swap(trackBlock.lowResTrack);
+        std::vector<TrackEntity>().swap(trackBlock.medResTrack);
+        std::vector<TrackLight>().swap(trackBlock.lights);
+        std::vector<TrackSound>().swap(trackBlock.sounds);
+        for (uint32_t const textureId : m_cookedTrackFile.blocks[blockIdx].textureIds) {
+            _ReleaseTexture(textureId, result);
+        }
+        // Freed along with the last entity using it
+        for (uint32_t const meshIdx : m_cookedTrackFile.blocks[blockIdx].meshIndices) {
+            if (--m_meshes[meshIdx].refCount == 0 && !m_meshes[meshIdx].pinned) {
+                m_residentBytes -= m_cookedTrackFile.meshes[meshIdx].size;
+            }
+        }
+        m_blocks[blockIdx].resident = false;
+        m_residentBytes -= m_cookedTrackFile.blocks[blockIdx].size;
+        result.evictedBlocks.push_back(blockIdx);
+    }
+
+    bool TrackStreamer::_AcquireTexture(uint32_t const textureId, UpdateResult &result) {
+        auto const textureIt{m_textures.find(textureId)};
+        if (textureIt == m_textures.end()) {
+            return false;
+        }
+        TextureState &texture{textureIt->second};
+        if (texture.refCount == 0 && !texture.pinned) {
+            if (!m_cookedTrackFile.ReadTexture(texture.tableIdx, m_track.trackTextureAssets[textureId])) {
+                LogWarning("Failed to read texture %u of %s", textureId, m_track.name.c_str());
+                m_track.trackTextureAssets.erase(textureId);
+                return false;
+            }
+            m_residentBytes += m_cookedTrackFile.textures[texture.tableIdx].size;
+            result.loadedTextures.push_back(textureId);
+        }
+        ++texture.refCount;
+        return true;
+    }
+
+    void TrackStreamer::_ReleaseTexture(uint32_t const textureId, UpdateResult &result) {
+        auto const textureIt{m_textures.find(textureId)};
+        if (textureIt == m_textures.end() || textureIt->second.refCount == 0) {
+            return;
+        }
+        TextureState &texture{textureIt->second};
+        if (--texture.refCount == 0 && !texture.pinned) {
+            m_track.trackTextureAssets.erase(textureId);
+            m_residentBytes -= m_cookedTrackFile.textures[texture.tableIdx].size;
+            result.evictedTextures.push_back(textureId);
+        }
+    }
+} // namespace LibOpenNFS
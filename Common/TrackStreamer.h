@@ -0,0 +1,84 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "BlockGraph.h"
+#include "Shared/ONFS/CookedTrackFile.h"
+
+namespace LibOpenNFS {
+    struct StreamingOptions {
+        // Upper bound on the bytes of block geometry, shared meshes and textures kept resident (global objects, their meshes and
+        // their textures excepted)
+        size_t budgetBytes{256u << 20};
+        // Blocks within this many neighbour hops of the focus block are wanted resident
+        uint32_t residentHops{4};
+    };
+
+    // Keeps the blocks of a cooked track (see Shared::CookedTrackFile) around a moving focus position resident, together with the
+    // textures they use. Every Update makes the blocks within StreamingOptions::residentHops of the focus block resident, nearest
+    // first, and evicts the least recently wanted blocks whenever the resident bytes would exceed the budget. Blocks that are no
+    // longer wanted stay cached until their memory is needed. Textures are reference counted by the resident blocks using them.
+    class TrackStreamer {
+      public:
+        struct UpdateResult {
+            uint32_t focusBlockIdx{0};
+            std::vector<uint32_t> loadedBlocks;
+            std::vector<uint32_t> evictedBlocks;
+            std::vector<uint32_t> loadedTextures;  // Texture IDs
+            std::vector<uint32_t> evictedTextures; // Texture IDs
+        };
+
+        TrackStreamer() = default;
+        static bool Open(std::string const &cookedTrackPath, TrackStreamer &trackStreamer, StreamingOptions const &options = {});
+
+        UpdateResult Update(glm::vec3 const &focusPosition);
+
+        // The streamed track. Every block carries its metadata and bounds, only resident blocks have entities, and
+        // trackTextureAssets only holds resident textures.
+        Track const &GetTrack() const {
+            return m_track;
+        }
+        BlockGraph const &GetBlockGraph() const {
+            return m_blockGraph;
+        }
+        bool IsBlockResident(uint32_t const blockIdx) const {
+            return m_blocks[blockIdx].resident;
+        }
+        size_t ResidentBytes() const {
+            return m_residentBytes;
+        }
+
+      private:
+        struct BlockState {
+            bool resident{false};
+            uint64_t lastWantedUpdate{0};
+        };
+        struct TextureState {
+            uint32_t tableIdx{0};
+            uint32_t refCount{0};
+            bool pinned{false}; // Used by global objects, never evicted
+        };
+        // Meshes shared between entities are read once for all the resident blocks using them
+        struct MeshState {
+            uint32_t refCount{0};
+            bool pinned{false}; // Used by global objects
+        };
+
+        uint32_t _FocusBlock(glm::vec3 const &focusPosition) const;
+        size_t _BytesToLoad(uint32_t blockIdx) const;
+        bool _LoadBlock(uint32_t blockIdx, UpdateResult &result);
+        void _EvictBlock(uint32_t blockIdx, UpdateResult &result);
+        bool _AcquireTexture(uint32_t textureId, UpdateResult &result);
+        void _ReleaseTexture(uint32_t textureId, UpdateResult &result);
+
+        StreamingOptions m_options;
+        Shared::CookedTrackFile m_cookedTrackFile;
+        Track m_track;
+        BlockGraph m_blockGraph;
+        std::vector<BlockState> m_blocks;
+        std::unordered_map<uint32_t, TextureState> m_textures;
+        std::vector<MeshState> m_meshes;
+        uint64_t m_updateIdx{0};
+        size_t m_residentBytes{0};
+    };
+} // namespace LibOpenNFS
@@ -0,0 +1,227 @@
+#include "VirtualRoadIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Logging.h"
+
+namespace LibOpenNFS {
+    namespace {
+        // The road is treated as a circuit if the gap from the last point back to the first is no longer than this many average
+        // segments
+        constexpr float kClosedLoopGapSegments{2.f};
+        constexpr float kDefaultCellSegments{4.f};
+        // Keeps huge tracks with tiny cells from allocating unbounded grids
+        constexpr int32_t kMaxGridDimension{1024};
+    } // namespace
+
+    uint32_t VirtualRoadIndex::Projection::NearestNode(uint32_t const nVirtualRoadPositions) const {
+        if (t < 0.5f || nVirtualRoadPositions == 0) {
+            return vroadIdx;
+        }
+        return (vroadIdx + 1) % nVirtualRoadPositions;
+    }
+
+    VirtualRoadIndex VirtualRoadIndex::Build(std::vector<TrackVRoad> const &virtualRoad, float cellSize) {
+        VirtualRoadIndex index;
+        if (virtualRoad.size() < 2) {
+            return index;
+        }
+        for (auto const &vroad : virtualRoad) {
+            index.m_points.push_back(vroad.position);
+            index.m_bounds.Extend(vroad.position);
+        }
+
+        // Arc length table
+        index.m_distances.push_back(0.f);
+        for (size_t pointIdx = 1; pointIdx < index.m_points.size(); ++pointIdx) {
+            index.m_distances.push_back(index.m_distances.back() + glm::distance(index.m_points[pointIdx - 1], index.m_points[pointIdx]));
+        }
+        float const averageSegmentLength{index.m_distances.back() / static_cast<float>(index.m_points.size() - 1)};
+        float const closingGap{glm::distance(index.m_points.back(), index.m_points.front())};
+        index.m_closedLoop = closingGap <= averageSegmentLength * kClosedLoopGapSegments;
+        if (index.m_closedLoop) {
+            index.m_distances.push_back(index.m_distances.back() + closingGap);
+        }
+
+        // Bucket segments into every grid cell their XZ bounds overlap
+        if (cellSize <= 0.f) {
+            cellSize = std::max(averageSegmentLength * kDefaultCellSegments, 1e-3f);
+        }
+        glm::vec3 const size{index.m_bounds.Size()};
+        cellSize = std::max({cellSize, size.x / kMaxGridDimension, size.z / kMaxGridDimension});
+        index.m_cellSize = cellSize;
+        index.m_gridWidth = static_cast<int32_t>(size.x / cellSize) + 1;
+        index.m_gridDepth = static_cast<int32_t>(size.z / cellSize) + 1;
+
+        auto cellRange = [&](uint32_t const segmentIdx, int32_t &minX, int32_t &maxX, int32_t &minZ, int32_t &maxZ) {
+            glm::vec3 const &start{index.m_points[segmentIdx]};
+            glm::vec3 const &end{index.m_points[(segmentIdx + 1) % index.m_points.size()]};
+            minX = std::clamp(static_cast<int32_t>((std::min(start.x, end.x) - index.m_bounds.min.x) / cellSize), 0, index.m_gridWidth - 1);
+            maxX = std::clamp(static_cast<int32_t>((std::max(start.x, end.x) - index.m_bounds.min.x) / cellSize), 0, index.m_gridWidth - 1);
+            minZ = std::clamp(static_cast<int32_t>((std::min(start.z, end.z) - index.m_bounds.min.z) / cellSize), 0, index.m_gridDepth - 1);
+            maxZ = std::clamp(static_cast<int32_t>((std::max(start.z, end.z) - index.m_bounds.min.z) / cellSize), 0, index.m_gridDepth - 1);
+        };
+        index.m_cellStart.assign(static_cast<size_t>(index.m_gridWidth) * index.m_gridDepth + 1, 0);
+        for (uint32_t segmentIdx = 0; segmentIdx < index.SegmentCount(); ++segmentIdx) {
+            int32_t minX, maxX, minZ, maxZ;
+            cellRange(segmentIdx, minX, maxX, minZ, maxZ);
+            for (int32_t cellZ = minZ; cellZ <= maxZ; ++cellZ) {
+                for (int32_t cellX = minX; cellX <= maxX; ++cellX) {
+                    ++index.m_cellStart[cellZ * index.m_gridWidth + cellX + 1];
+                }
+            }
+        }
+        for (size_t cellIdx = 1; cellIdx < index.m_cellStart.size(); ++cellIdx) {
+            index.m_cellStart[cellIdx] += index.m_cellStart[cellIdx - 1];
+        }
+        index.m_cellSegments.resize(index.m_cellStart.back());
+        std::vector<uint32_t> cellFill(index.m_cellStart.begin(), index.m_cellStart.end() - 1);
+        for (uint32_t segmentIdx = 0; segmentIdx < index.SegmentCount(); ++segmentIdx) {
+            int32_t minX, maxX, minZ, maxZ;
+            cellRange(segmentIdx, minX, maxX, minZ, maxZ);
+            for (int32_t cellZ = minZ; cellZ <= maxZ; ++cellZ) {
+                for (int32_t cellX = minX; cellX <= maxX; ++cellX) {
+                    index.m_cellSegments[cellFill[cellZ * index.m_gridWidth + cellX]++] = segmentIdx;
+                }
+            }
+        }
+        LogInfo("Indexed %zu virtual road points (%s, %.1f long) into a %dx%d grid", index.m_points.size(),
+                index.m_closedLoop ? "circuit" : "point to point", index.Length(), index.m_gridWidth, index.m_gridDepth);
+
+        return index;
+    }
+
+    bool VirtualRoadIndex::Project(glm::vec3 const &position, Projection &projection) const {
+        if (m_cellStart.empty()) {
+            return false;
+        }
+        int32_t const centerX{std::clamp(static_cast<int32_t>(std::floor((position.x - m_bounds.min.x) / m_cellSize)), 0, m_gridWidth - 1)};
+        int32_t const centerZ{std::clamp(static_cast<int32_t>(std::floor((position.z - m_bounds.min.z) / m_cellSize)), 0, m_gridDepth - 1)};
+        int32_t const maxRing{std::max(m_gridWidth, m_gridDepth)};
+
+        // Search rings of cells outwards, every cell of ring r is at least (r - 1) cells away from the query
+        bool found{false};
+        for (int32_t ring = 0; ring <= maxRing; ++ring) {
+            if (found && static_cast<float>(ring - 1) * m_cellSize > projection.distance) {
+                break;
+            }
+            for (int32_t cellZ = centerZ - ring; cellZ <= centerZ + ring; ++cellZ) {
+                if (cellZ < 0 || cellZ >= m_gridDepth) {
+                    continue;
+                }
+                bool const edgeRow{cellZ == centerZ - ring || cellZ == centerZ + ring};
+                int32_t const stepX{edgeRow || ring == 0 ? 1 : 2 * ring};
+                for (int32_t cellX = centerX - ring; cellX <= centerX + ring; cellX += stepX) {
+                    if (cellX < 0 || cellX >= m_gridWidth) {
+                        continue;
+                    }
+                    size_t const cellIdx{static_cast<size_t>(cellZ) * m_gridWidth + cellX};
+                    for (uint32_t entryIdx = m_cellStart[cellIdx]; entryIdx < m_cellStart[cellIdx + 1]; ++entryIdx) {
+                        Projection const candidate{_ProjectOnSegment(position, m_cellSegments[entryIdx])};
+                        if (!found || candidate.distance < projection.distance) {
+                            projection = candidate;
+                            found = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        return found;
+    }
+
+    bool VirtualRoadIndex::AtDistance(float arcLength, Projection &projection) const {
+        if (m_distances.size() < 2) {
+            return false;
+        }
+        float const length{Length()};
+        if (m_closedLoop && length > 0.f) {
+            arcLength = std::fmod(arcLength, length);
+            if (arcLength < 0.f) {
+                arcLength += length;
+            }
+        } else {
+            arcLength = std::clamp(arcLength, 0.f, length);
+        }
+        auto const segmentIt{std::upper_bound(m_distances.begin(), m_distances.end(), arcLength)};
+        auto const segmentIdx{static_cast<uint32_t>(std::clamp<ptrdiff_t>(segmentIt - m_distances.begin() - 1, 0, SegmentCount() - 1))};
+        float const segmentLength{m_distances[segmentIdx + 1] - m_distances[segmentIdx]};
+
+        projection.vroadIdx = segmentIdx;
+        projection.t = segmentLength > 0.f ? std::clamp((arcLength - m_distances[segmentIdx]) / segmentLength, 0.f, 1.f) : 0.f;
+        projection.distanceAlong = arcLength;
+        projection.distance = 0.f;
+        projection.position = glm::mix(m_points[segmentIdx], m_points[(segmentIdx + 1) % m_points.size()], projection.t);
+
+        return true;
+    }
+
+    VirtualRoadIndex::Projection VirtualRoadIndex::_ProjectOnSegment(glm::vec3 const &position, uint32_t const segmentIdx) const {
+        glm::vec3 const &start{m_points[segmentIdx]};
+        glm::vec3 const segment{m_points[(segmentIdx + 1) % m_points.size()] - start};
+        float const lengthSquared{glm::dot(segment, segment)};
+
+        Projection projection;
+        projection.vroadIdx = segmentIdx;
+        projection.t = lengthSquared > 0.f ? std::clamp(glm::dot(position - start, segment) / lengthSquared, 0.f, 1.f) : 0.f;
+        projection.position = start + segment * projection.t;
+        projection.distance = glm::distance(position, projection.position);
+        projection.distanceAlong = glm::mix(m_distances[segmentIdx], m_distances[segmentIdx + 1], projection.t);
+        return projection;
+    }
+
+    VirtualRoadIndex::Tracker::Tracker(VirtualRoadIndex const &index) : m_index(index) {
+    }
+
+    VirtualRoadIndex::Projection const &VirtualRoadIndex::Tracker::Update(glm::vec3 const &position) {
+        uint32_t const nSegments{m_index.SegmentCount()};
+        if (nSegments == 0) {
+            return m_projection;
+        }
+        Projection const previous{m_projection};
+        bool windowHit{false};
+        if (m_hasProjection) {
+            auto const window{static_cast<int32_t>(std::min(kSearchWindow, nSegments))};
+            for (int32_t offset = -window; offset <= window; ++offset) {
+                int32_t segmentIdx{static_cast<int32_t>(previous.vroadIdx) + offset};
+                if (m_index.m_closedLoop) {
+                    segmentIdx = (segmentIdx % static_cast<int32_t>(nSegments) + static_cast<int32_t>(nSegments)) % static_cast<int32_t>(nSegments);
+                } else if (segmentIdx < 0 || segmentIdx >= static_cast<int32_t>(nSegments)) {
+                    continue;
+                }
+                Projection const candidate{m_index._ProjectOnSegment(position, static_cast<uint32_t>(segmentIdx))};
+                if (!windowHit || candidate.distance < m_projection.distance) {
+                    m_projection = candidate;
+                    windowHit = true;
+                }
+            }
+        }
+        if (!windowHit || m_projection.distance > m_index.m_cellSize) {
+            m_index.Project(position, m_projection);
+        }
+
+        // Crossing the start line wraps distanceAlong by about a whole lap
+        if (m_hasProjection && m_index.m_closedLoop) {
+            float const halfLength{m_index.Length() * 0.5f};
+            if (m_projection.distanceAlong - previous.distanceAlong < -halfLength) {
+                ++m_laps;
+            } else if (m_projection.distanceAlong - previous.distanceAlong > halfLength) {
+                --m_laps;
+            }
+        }
+        m_hasProjection = true;
+
+        return m_projection;
+    }
+
+    void VirtualRoadIndex::Tracker::Reset() {
+        m_projection = {};
+        m_hasProjection = false;
+        m_laps = 0;
+    }
+
+    float VirtualRoadIndex::Tracker::TotalDistance() const {
+        return static_cast<float>(m_laps) * m_index.Length() + m_projection.distanceAlong;
+    }
+} // namespace LibOpenNFS
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+
+#include "AABB.h"
+#include "Entities/TrackVRoad.h"
+
+namespace LibOpenNFS {
+    // Spatial and arc length index over the segments joining consecutive Track::virtualRoad points. Segments are bucketed into a
+    // uniform XZ grid for nearest point queries, and the cumulative length up to every point is kept for distance along track
+    // lookups. Circuits (last point close to the first) get a closing segment back to point 0.
+    class VirtualRoadIndex {
+      public:
+        // Closest point on the virtual road: on the segment from point vroadIdx to the next one, at parameter t in [0, 1]
+        struct Projection {
+            uint32_t vroadIdx{0};
+            float t{0.f};
+            float distanceAlong{0.f}; // Arc length from point 0
+            float distance{0.f};      // From the query position
+            glm::vec3 position{0.f};
+
+            // Whichever end of the segment is closer
+            uint32_t NearestNode(uint32_t nVirtualRoadPositions) const;
+        };
+
+        // Follows one body along the road, searching a window of segments around its last projection instead of the whole grid.
+        // Falls back to a full query when the body is first seen, or ends up further than the grid cell size from the window
+        // (respawn, teleport, cutting across the infield). Laps are counted when a circuit's start line is crossed either way.
+        class Tracker {
+          public:
+            static constexpr uint32_t kSearchWindow{16};
+
+            explicit Tracker(VirtualRoadIndex const &index);
+            Projection const &Update(glm::vec3 const &position);
+            void Reset();
+
+            Projection const &Current() const {
+                return m_projection;
+            }
+            int32_t Laps() const {
+                return m_laps;
+            }
+            // Distance along the road including completed laps, monotonic for a body driving the right way round
+            float TotalDistance() const;
+
+          private:
+            VirtualRoadIndex const &m_index;
+            Projection m_projection;
+            bool m_hasProjection{false};
+            int32_t m_laps{0};
+        };
+
+        VirtualRoadIndex() = default;
+        // cellSize of 0 picks four times the average segment length
+        static VirtualRoadIndex Build(std::vector<TrackVRoad> const &virtualRoad, float cellSize = 0.f);
+
+        // False only if the index is empty
+        bool Project(glm::vec3 const &position, Projection &projection) const;
+        // Point at arcLength along the road, wrapped around circuits and clamped to the ends otherwise (distance is left at 0)
+        bool AtDistance(float arcLength, Projection &projection) const;
+
+        bool IsClosedLoop() const {
+            return m_closedLoop;
+        }
+        float Length() const {
+            return m_distances.empty() ? 0.f : m_distances.back();
+        }
+        uint32_t SegmentCount() const {
+            return static_cast<uint32_t>(m_distances.empty() ? 0 : m_distances.size() - 1);
+        }
+        float CellSize() const {
+            return m_cellSize;
+        }
+
+      private:
+        Projection _ProjectOnSegment(glm::vec3 const &position, uint32_t segmentIdx) const;
+
+        std::vector<glm::vec3> m_points;
+        // Cumulative length at the start of each segment, with the total length as the final entry
+        std::vector<float> m_distances;
+        bool m_closedLoop{false};
+
+        AABB m_bounds;
+        float m_cellSize{1.f};
+        int32_t m_gridWidth{0};
+        int32_t m_gridDepth{0};
+        // Compressed rows: the segments of cell c are m_cellSegments[m_cellStart[c], m_cellStart[c + 1])
+        std::vector<uint32_t> m_cellStart;
+        std::vector<uint32_t> m_cellSegments;
+    };
+} // namespace LibOpenNFS
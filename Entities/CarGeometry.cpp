@@ -65,4 +65,23 @@ namespace LibOpenNFS {
             m_normals.push_back(norms[vertex_index]);
         }
     }
+
+    uint64_t CarGeometry::HashVertex(uint32_t const vertexIdx) const {
+        uint64_t hash{Geometry::HashVertex(vertexIdx)};
+        _HashAttribute(hash, m_texture_indices, vertexIdx, m_vertices.size());
+        _HashAttribute(hash, m_polygon_flags, vertexIdx, m_vertices.size());
+        return hash;
+    }
+
+    bool CarGeometry::VerticesEqual(uint32_t const vertexIdxA, uint32_t const vertexIdxB) const {
+        return Geometry::VerticesEqual(vertexIdxA, vertexIdxB) &&
+               _AttributeEqual(m_texture_indices, vertexIdxA, vertexIdxB, m_vertices.size()) &&
+               _AttributeEqual(m_polygon_flags, vertexIdxA, vertexIdxB, m_vertices.size());
+    }
+
+    void CarGeometry::RemapVertices(std::vector<uint32_t> const &remap) {
+        _RemapAttribute(m_texture_indices, remap, m_vertices.size());
+        _RemapAttribute(m_polygon_flags, remap, m_vertices.size());
+        Geometry::RemapVertices(remap);
+    }
 } // namespace LibOpenNFS
\ No newline at end of file
@@ -37,6 +37,9 @@ namespace LibOpenNFS {
                     const std::vector<uint32_t>& indices,
                     const glm::vec3& center_position);
         CarGeometry() = default;
+        uint64_t HashVertex(uint32_t vertexIdx) const override;
+        bool VerticesEqual(uint32_t vertexIdxA, uint32_t vertexIdxB) const override;
+        void RemapVertices(std::vector<uint32_t> const &remap) override;
 
         // Multitextured Car
         bool isMultiTextured = false;
@@ -8,11 +8,16 @@ namespace LibOpenNFS {
                        glm::vec3 const &centerPosition)
         : name(std::move(name)), m_normals(normals), m_uvs(uvs), m_vertexIndices(vertexIndices) {
         if (removeVertexIndexing) {
+            m_vertices.reserve(m_vertexIndices.size());
             for (auto const &vertex_index : m_vertexIndices) {
                 m_vertices.push_back(vertices[vertex_index]);
+                m_bounds.Extend(vertices[vertex_index]);
             }
         } else {
             m_vertices = vertices;
+            for (auto const &vertex : m_vertices) {
+                m_bounds.Extend(vertex);
+            }
         }
 
         position = centerPosition;
@@ -20,4 +25,28 @@ namespace LibOpenNFS {
         orientation_vec = glm::vec3(0, 0, 0);
         orientation = glm::normalize(glm::quat(orientation_vec));
     }
+
+    uint64_t Geometry::HashVertex(uint32_t const vertexIdx) const {
+        uint64_t hash{0xCBF29CE484222325ull};
+        _HashAttribute(hash, m_vertices, vertexIdx, m_vertices.size());
+        _HashAttribute(hash, m_normals, vertexIdx, m_vertices.size());
+        _HashAttribute(hash, m_uvs, vertexIdx, m_vertices.size());
+        _HashAttribute(hash, m_vertexIndices, vertexIdx, m_vertices.size());
+        return hash;
+    }
+
+    bool Geometry::VerticesEqual(uint32_t const vertexIdxA, uint32_t const vertexIdxB) const {
+        return _AttributeEqual(m_vertices, vertexIdxA, vertexIdxB, m_vertices.size()) &&
+               _AttributeEqual(m_normals, vertexIdxA, vertexIdxB, m_vertices.size()) &&
+               _AttributeEqual(m_uvs, vertexIdxA, vertexIdxB, m_vertices.size()) &&
+               _AttributeEqual(m_vertexIndices, vertexIdxA, vertexIdxB, m_vertices.size());
+    }
+
+    void Geometry::RemapVertices(std::vector<uint32_t> const &remap) {
+        size_t const nVertices{m_vertices.size()};
+        _RemapAttribute(m_normals, remap, nVertices);
+        _RemapAttribute(m_uvs, remap, nVertices);
+        _RemapAttribute(m_vertexIndices, remap, nVertices);
+        _RemapAttribute(m_vertices, remap, nVertices);
+    }
 } // namespace LibOpenNFS
@@ -5,9 +5,12 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include <cstring>
 #include <string>
 #include <vector>
 
+#include "Common/AABB.h"
+
 namespace LibOpenNFS {
     class Geometry {
       public:
@@ -16,15 +19,59 @@ namespace LibOpenNFS {
                  std::vector<glm::vec3> const &normals, std::vector<uint32_t> const &vertexIndices, bool removeVertexIndexing,
                  glm::vec3 const &centerPosition);
         virtual ~Geometry() = default;
+
+        // Per-vertex attribute hooks used to weld and reorder indexed geometry. Subclasses with their own per-vertex arrays extend
+        // these so that every attribute stays in step with m_vertices.
+        virtual uint64_t HashVertex(uint32_t vertexIdx) const;
+        virtual bool VerticesEqual(uint32_t vertexIdxA, uint32_t vertexIdxB) const;
+        // New vertex i takes the attributes of old vertex remap[i]
+        virtual void RemapVertices(std::vector<uint32_t> const &remap);
+
         std::string name;
         std::vector<glm::vec3> m_vertices;
         std::vector<glm::vec3> m_normals;
         std::vector<glm::vec2> m_uvs;
         std::vector<uint32_t> m_vertexIndices;
+        // Triangle list indices into the per-vertex arrays. Empty while the geometry is a de-indexed triangle list, as built by
+        // the loaders, only populated by GeometryUtils::OptimiseIndices.
+        std::vector<uint32_t> m_indices;
+        // Local space bounds of m_vertices, filled in as the constructor builds them (invalid for empty geometry)
+        AABB m_bounds;
 
         glm::vec3 position{};
         glm::vec3 initialPosition{};
         glm::vec3 orientation_vec{};
         glm::quat orientation{};
+
+      protected:
+        // Attribute arrays that aren't per-vertex (e.g. unused, empty buffers) are left untouched by the helpers below
+        template <typename T> static void _HashAttribute(uint64_t &hash, std::vector<T> const &attribute, uint32_t const vertexIdx,
+                                                         size_t const nVertices) {
+            if (attribute.size() != nVertices) {
+                return;
+            }
+            // FNV-1a over the attribute bytes
+            unsigned char bytes[sizeof(T)];
+            std::memcpy(bytes, &attribute[vertexIdx], sizeof(T));
+            for (unsigned char const byte : bytes) {
+                hash = (hash ^ byte) * 0x100000001B3ull;
+            }
+        }
+        template <typename T> static bool _AttributeEqual(std::vector<T> const &attribute, uint32_t const vertexIdxA,
+                                                          uint32_t const vertexIdxB, size_t const nVertices) {
+            return attribute.size() != nVertices || attribute[vertexIdxA] == attribute[vertexIdxB];
+        }
+        template <typename T> static void _RemapAttribute(std::vector<T> &attribute, std::vector<uint32_t> const &remap,
+                                                          size_t const nVertices) {
+            if (attribute.size() != nVertices) {
+                return;
+            }
+            std::vector<T> remapped;
+            remapped.reserve(remap.size());
+            for (uint32_t const vertexIdx : remap) {
+                remapped.push_back(attribute[vertexIdx]);
+            }
+            attribute = std::move(remapped);
+        }
     };
 } // namespace LibOpenNFS
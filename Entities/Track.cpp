@@ -11,4 +11,11 @@ namespace LibOpenNFS {
         }
         texturePath = TextureUtils::GetTrackTexturePath(basePath, name, nfsVersion);
     }
+
+    void Track::UpdateBounds() {
+        for (auto &trackBlock : trackBlocks) {
+            trackBlock.UpdateBounds();
+        }
+        blockBVH = CullingBVH::Build(trackBlocks);
+    }
 } // namespace LibOpenNFS
\ No newline at end of file
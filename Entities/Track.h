@@ -1,13 +1,13 @@
 #pragma once
 
 #include <cstdint>
-#include <map>
 #include <vector>
 
 #include "../Shared/CAN/CanFile.h"
+#include "Common/CullingBVH.h"
 #include "TrackBlock.h"
 #include "TrackEntity.h"
-#include "TrackTextureAsset.h"
+#include "TrackTextureTable.h"
 #include "TrackVRoad.h"
 
 namespace LibOpenNFS {
@@ -16,6 +16,9 @@ namespace LibOpenNFS {
         Track(NFSVersion _nfsVersion, std::string const &_name, std::string const &_basePath, std::string const &_tag = "");
         Track() = default;
 
+        // Refresh the bounds of every block and rebuild blockBVH, called by the loaders once all geometry is in place
+        void UpdateBounds();
+
         // Metadata
         NFSVersion nfsVersion{};
         std::string name;
@@ -24,11 +27,15 @@ namespace LibOpenNFS {
         std::string tag;
         uint32_t nBlocks{0};
         std::vector<Shared::CameraAnimPoint> cameraAnimation;
-        std::map<uint32_t, TrackTextureAsset> trackTextureAssets;
+        TrackTextureTable trackTextureAssets;
+        // Skybox textures (NFS3 sky.fsh), indexed by their position in the archive
+        TrackTextureTable skyTextureAssets;
 
         // Geometry
         std::vector<TrackVRoad> virtualRoad;
         std::vector<TrackBlock> trackBlocks;
         std::vector<TrackEntity> globalObjects;
+        // Hierarchy over trackBlocks bounds for visibility queries
+        CullingBVH blockBVH;
     };
 } // namespace LibOpenNFS
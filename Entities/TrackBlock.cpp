@@ -12,4 +12,15 @@ namespace LibOpenNFS {
         this->nVirtualRoadPositions = nVirtualRoadPositions;
         this->neighbourIds = neighbourIds;
     }
+
+    void TrackBlock::UpdateBounds() {
+        bounds = AABB();
+        for (auto const *entities : {&track, &objects, &lanes}) {
+            for (auto const &entity : *entities) {
+                if (entity.bounds.IsValid()) {
+                    bounds.Extend(entity.bounds);
+                }
+            }
+        }
+    }
 } // namespace LibOpenNFS
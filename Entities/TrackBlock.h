@@ -11,17 +11,30 @@ namespace LibOpenNFS {
     class TrackBlock {
     public:
         TrackBlock(uint32_t id, glm::vec3 position, uint32_t virtualRoadStartIndex, uint32_t nVirtualRoadPositions, const std::vector<uint32_t> &neighbourIds);
+        // Recompute bounds from the bounds of the block's track, object and lane entities
+        void UpdateBounds();
 
         uint32_t id;
         glm::vec3 position;
         uint32_t virtualRoadStartIndex;
         uint32_t nVirtualRoadPositions;
         std::vector<uint32_t> neighbourIds;
+        // World space bounds of every entity with geometry in the block (invalid if it has none)
+        AABB bounds;
 
         std::vector<TrackEntity> track;
         std::vector<TrackEntity> objects;
         std::vector<TrackEntity> lanes;
         std::vector<TrackLight> lights;
         std::vector<TrackSound> sounds;
+
+        // Reduced detail road geometry for drawing distant blocks, built from the low/medium resolution FRD polygon chunks
+        // (NFS3/NFS4 only). Never collidable, collision always uses the full resolution track.
+        std::vector<TrackEntity> lowResTrack;
+        std::vector<TrackEntity> medResTrack;
+        // Vertex counts of each level of detail, as stored in the FRD block
+        uint32_t nLowResVertices{0};
+        uint32_t nMedResVertices{0};
+        uint32_t nHighResVertices{0};
     };
 } // namespace LibOpenNFS
@@ -6,16 +6,45 @@ namespace LibOpenNFS {
         : type(entityType), geometry(geometry), entityID(entityID), flags(flags), hasGeometry(true), animDelay(animDelay),
           animKeyframes(animKeyframes) {
         this->_SetCollisionParameters();
+        this->UpdateBounds();
     }
 
     TrackEntity::TrackEntity(uint32_t const entityID, EntityType const entityType, TrackGeometry const &geometry, uint32_t const flags)
         : type(entityType), geometry(geometry), entityID(entityID), flags(flags), hasGeometry(true) {
         this->_SetCollisionParameters();
+        this->UpdateBounds();
     }
 
     TrackEntity::TrackEntity(uint32_t const entityID, EntityType const entityType, uint32_t const flags)
         : type(entityType), entityID(entityID), flags(flags) {
         this->_SetCollisionParameters();
+        this->UpdateBounds();
+    }
+
+    TrackEntity::TrackEntity(uint32_t const entityID, EntityType const entityType, std::shared_ptr<TrackGeometry> const &sharedGeometry,
+                             glm::vec3 const &position, uint32_t const flags)
+        : type(entityType), sharedGeometry(sharedGeometry), entityID(entityID), flags(flags), hasGeometry(true) {
+        geometry.name = sharedGeometry->name;
+        geometry.position = position;
+        geometry.initialPosition = position;
+        this->_SetCollisionParameters();
+        this->UpdateBounds();
+    }
+
+    TrackGeometry const &TrackEntity::Mesh() const {
+        return sharedGeometry ? *sharedGeometry : geometry;
+    }
+
+    TrackGeometry &TrackEntity::Mesh() {
+        return sharedGeometry ? *sharedGeometry : geometry;
+    }
+
+    glm::mat4 TrackEntity::ModelMatrix() const {
+        return glm::translate(glm::mat4(1.f), geometry.position) * glm::mat4_cast(geometry.orientation);
+    }
+
+    void TrackEntity::UpdateBounds() {
+        bounds = hasGeometry ? Mesh().m_bounds.Transformed(ModelMatrix()) : AABB();
     }
 
     void TrackEntity::_SetCollisionParameters() {
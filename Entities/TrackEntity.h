@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 #include "TrackGeometry.h"
 
 #include "../Shared/AnimKeyframe.h"
@@ -23,10 +25,26 @@ namespace LibOpenNFS {
                     uint16_t animDelay, uint32_t flags = 0u);
         TrackEntity(uint32_t entityID, EntityType entityType, TrackGeometry const &geometry, uint32_t flags = 0u);
         TrackEntity(uint32_t entityID, EntityType entityType, uint32_t flags = 0u);
+        // Instance of a mesh shared with other entities, placed at position
+        TrackEntity(uint32_t entityID, EntityType entityType, std::shared_ptr<TrackGeometry> const &sharedGeometry, glm::vec3 const &position,
+                    uint32_t flags = 0u);
         virtual ~TrackEntity() = default;
 
+        // The entity's mesh, whether it is owned or shared with other instances
+        TrackGeometry const &Mesh() const;
+        TrackGeometry &Mesh();
+        // Instance transform (geometry position/orientation) taking the mesh from local to world space
+        glm::mat4 ModelMatrix() const;
+        // Recompute bounds from the mesh bounds and current instance transform, needed after moving the entity
+        void UpdateBounds();
+
         EntityType type;
         TrackGeometry geometry;
+        // Set when several entities draw the same mesh. The mesh data then lives here, in local space, and `geometry` only holds
+        // this instance's placement (position/orientation) with empty vertex data.
+        std::shared_ptr<TrackGeometry> sharedGeometry;
+        // World space bounds, set on construction. Animated entities are bounded at their initial placement only.
+        AABB bounds;
         uint32_t entityID{0};
         uint32_t flags{0};
         bool hasGeometry{false};
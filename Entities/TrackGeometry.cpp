@@ -31,4 +31,25 @@ namespace LibOpenNFS {
         }
     }
 
+    uint64_t TrackGeometry::HashVertex(uint32_t const vertexIdx) const {
+        uint64_t hash{Geometry::HashVertex(vertexIdx)};
+        _HashAttribute(hash, m_textureIndices, vertexIdx, m_vertices.size());
+        _HashAttribute(hash, m_shadingData, vertexIdx, m_vertices.size());
+        _HashAttribute(hash, m_debugData, vertexIdx, m_vertices.size());
+        return hash;
+    }
+
+    bool TrackGeometry::VerticesEqual(uint32_t const vertexIdxA, uint32_t const vertexIdxB) const {
+        return Geometry::VerticesEqual(vertexIdxA, vertexIdxB) &&
+               _AttributeEqual(m_textureIndices, vertexIdxA, vertexIdxB, m_vertices.size()) &&
+               _AttributeEqual(m_shadingData, vertexIdxA, vertexIdxB, m_vertices.size()) &&
+               _AttributeEqual(m_debugData, vertexIdxA, vertexIdxB, m_vertices.size());
+    }
+
+    void TrackGeometry::RemapVertices(std::vector<uint32_t> const &remap) {
+        _RemapAttribute(m_textureIndices, remap, m_vertices.size());
+        _RemapAttribute(m_shadingData, remap, m_vertices.size());
+        _RemapAttribute(m_debugData, remap, m_vertices.size());
+        Geometry::RemapVertices(remap);
+    }
 } // namespace LibOpenNFS
@@ -11,6 +11,9 @@ namespace LibOpenNFS {
         TrackGeometry(const std::vector<glm::vec3> &vertices, const std::vector<glm::vec3> &normals, const std::vector<glm::vec2> &uvs, const std::vector<uint32_t> &textureIndices,
                       const std::vector<uint32_t> &vertexIndices, const std::vector<glm::vec4> &shadingData, glm::vec3 centerPosition);
         ~TrackGeometry() override = default;
+        uint64_t HashVertex(uint32_t vertexIdx) const override;
+        bool VerticesEqual(uint32_t vertexIdxA, uint32_t vertexIdxB) const override;
+        void RemapVertices(std::vector<uint32_t> const &remap) override;
         std::vector<uint32_t> m_textureIndices;
         std::vector<glm::vec4> m_shadingData;
         std::vector<uint32_t> m_debugData;
@@ -21,6 +21,21 @@ namespace LibOpenNFS {
         : data(std::move(pixelData)), id(id), width(width), height(height) {
     }
 
+    TrackTextureAsset::TrackTextureAsset(uint32_t const id, uint32_t const width, uint32_t const height,
+                                         std::shared_ptr<Shared::FshArchive const> archive, uint32_t const archiveIdx,
+                                         std::shared_ptr<TextureCache> textureCache)
+        : archive(std::move(archive)), archiveIdx(archiveIdx), textureCache(std::move(textureCache)), id(id), width(width),
+          height(height) {
+    }
+
+    TextureCache::Pixels TrackTextureAsset::Pixels() const {
+        if (data.empty() && archive != nullptr) {
+            return textureCache->Get(archive->GetTexture(archiveIdx));
+        }
+        // Non-owning, aliases data
+        return {std::shared_ptr<void>(), &data};
+    }
+
     std::vector<glm::vec2> TrackTextureAsset::ScaleUVs(std::vector<glm::vec2> const &uvs, bool const invertU, bool const invertV,
                                                        uint8_t const nRotate, bool const mirrorX, bool const mirrorY) const {
         std::vector<glm::vec2> temp_uvs = uvs;
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+#include "Common/BlockCompression.h"
+#include "Common/TextureCache.h"
 #include "TrackEntity.h"
 
 namespace LibOpenNFS {
@@ -15,13 +17,19 @@ namespace LibOpenNFS {
                                    std::string const &alphaFileReference);
         // Direct pixel data constructor (for FSH direct loading path)
         explicit TrackTextureAsset(uint32_t id, uint32_t width, uint32_t height, std::vector<uint8_t> pixelData);
+        // Lazily decoded texture, left in its source archive until Pixels is first called
+        explicit TrackTextureAsset(uint32_t id, uint32_t width, uint32_t height, std::shared_ptr<Shared::FshArchive const> archive,
+                                   uint32_t archiveIdx, std::shared_ptr<TextureCache> textureCache);
 
         [[nodiscard]] std::vector<glm::vec2> ScaleUVs(std::vector<glm::vec2> const &uvs, bool invertU, bool invertV, uint8_t nRotate = 0,
                                                       bool mirrorX = false, bool mirrorY = false) const;
 
         [[nodiscard]] bool HasPixelData() const {
-            return !data.empty();
+            return !data.empty() || archive != nullptr;
         }
+        // RGBA pixels, from data or decoded through the texture cache for lazily loaded textures. The pixels stay valid while the
+        // pointer is held (for textures with data, while this asset is alive and unmodified).
+        [[nodiscard]] TextureCache::Pixels Pixels() const;
 
         // Legacy file references (deprecated - use direct pixel data instead)
         std::string fileReference;
@@ -29,6 +37,13 @@ namespace LibOpenNFS {
 
         // Direct pixel data (RGBA format)
         std::vector<uint8_t> data;
+        // Source of lazily decoded textures, which have no data
+        std::shared_ptr<Shared::FshArchive const> archive;
+        uint32_t archiveIdx{0};
+        std::shared_ptr<TextureCache> textureCache;
+        // Block compressed copy of the pixels, only filled by BlockCompression::CompressTextures
+        BlockFormat compressedFormat{BlockFormat::None};
+        std::vector<uint8_t> compressedData;
 
         uint32_t id{0};
         uint32_t width{0};
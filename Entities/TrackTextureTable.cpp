@@ -0,0 +1,50 @@
+#include "TrackTextureTable.h"
+
+#include <stdexcept>
+
+namespace LibOpenNFS {
+    TrackTextureAsset &TrackTextureTable::at(uint32_t const id) {
+        if (!contains(id)) {
+            throw std::out_of_range("No track texture with ID " + std::to_string(id));
+        }
+        return m_entries[id].second;
+    }
+
+    TrackTextureAsset const &TrackTextureTable::at(uint32_t const id) const {
+        if (!contains(id)) {
+            throw std::out_of_range("No track texture with ID " + std::to_string(id));
+        }
+        return m_entries[id].second;
+    }
+
+    TrackTextureAsset &TrackTextureTable::operator[](uint32_t const id) {
+        if (contains(id)) {
+            return m_entries[id].second;
+        }
+        if (id >= m_entries.size()) {
+            m_entries.resize(static_cast<size_t>(id) + 1);
+            m_occupied.resize((m_entries.size() + 63) / 64, 0);
+        }
+        m_occupied[id / 64] |= 1ull << (id % 64);
+        m_entries[id].first = id;
+        ++m_size;
+        return m_entries[id].second;
+    }
+
+    size_t TrackTextureTable::erase(uint32_t const id) {
+        if (!contains(id)) {
+            return 0;
+        }
+        m_occupied[id / 64] &= ~(1ull << (id % 64));
+        // Release the pixels now rather than when the slot is reused
+        m_entries[id].second = TrackTextureAsset();
+        --m_size;
+        return 1;
+    }
+
+    void TrackTextureTable::clear() {
+        m_entries.clear();
+        m_occupied.clear();
+        m_size = 0;
+    }
+} // namespace LibOpenNFS
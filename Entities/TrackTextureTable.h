@@ -0,0 +1,133 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "TrackTextureAsset.h"
+
+namespace LibOpenNFS {
+    // Textures of a track indexed directly by texture ID. IDs are small dense integers (FSH/QFS indices), so textures live in a flat
+    // table with an occupancy bitmap rather than a tree, making a lookup a bounds check and a bit test. Offers the subset of the
+    // std::map interface the library uses, iterating occupied IDs in ascending order as {id, texture} pairs.
+    //
+    // As with std::vector, inserting an ID beyond the current table invalidates references to every texture.
+    class TrackTextureTable {
+      public:
+        using value_type = std::pair<uint32_t, TrackTextureAsset>;
+
+        template <bool IsConst> class Iterator {
+          public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = TrackTextureTable::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<IsConst, value_type const *, value_type *>;
+            using reference = std::conditional_t<IsConst, value_type const &, value_type &>;
+            using Table = std::conditional_t<IsConst, TrackTextureTable const, TrackTextureTable>;
+
+            Iterator() = default;
+            Iterator(Table *table, uint32_t const id) : m_table(table), m_id(id) {
+            }
+            // iterator -> const_iterator
+            template <bool WasConst, typename = std::enable_if_t<IsConst && !WasConst>>
+            Iterator(Iterator<WasConst> const &other) : m_table(other.m_table), m_id(other.m_id) {
+            }
+
+            reference operator*() const {
+                return m_table->m_entries[m_id];
+            }
+            pointer operator->() const {
+                return &m_table->m_entries[m_id];
+            }
+            Iterator &operator++() {
+                m_id = m_table->_NextOccupied(m_id + 1);
+                return *this;
+            }
+            Iterator operator++(int) {
+                Iterator const previous{*this};
+                ++*this;
+                return previous;
+            }
+            bool operator==(Iterator const &other) const {
+                return m_id == other.m_id;
+            }
+
+          private:
+            template <bool> friend class Iterator;
+            Table *m_table{nullptr};
+            uint32_t m_id{0};
+        };
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        TrackTextureTable() = default;
+
+        // Texture with the ID, or nullptr if there isn't one
+        TrackTextureAsset *Get(uint32_t const id) {
+            return contains(id) ? &m_entries[id].second : nullptr;
+        }
+        TrackTextureAsset const *Get(uint32_t const id) const {
+            return contains(id) ? &m_entries[id].second : nullptr;
+        }
+        // One past the highest ID the table has room for, every texture ID is below it
+        uint32_t IdLimit() const {
+            return static_cast<uint32_t>(m_entries.size());
+        }
+
+        bool contains(uint32_t const id) const {
+            return id < m_entries.size() && (m_occupied[id / 64] >> (id % 64) & 1u);
+        }
+        // Throws std::out_of_range if there is no texture with the ID
+        TrackTextureAsset &at(uint32_t id);
+        TrackTextureAsset const &at(uint32_t id) const;
+        // Default constructed texture if there is no texture with the ID
+        TrackTextureAsset &operator[](uint32_t id);
+        // Number of textures removed (0 or 1)
+        size_t erase(uint32_t id);
+        void clear();
+
+        iterator find(uint32_t const id) {
+            return contains(id) ? iterator(this, id) : end();
+        }
+        const_iterator find(uint32_t const id) const {
+            return contains(id) ? const_iterator(this, id) : end();
+        }
+        iterator begin() {
+            return {this, _NextOccupied(0)};
+        }
+        iterator end() {
+            return {this, IdLimit()};
+        }
+        const_iterator begin() const {
+            return {this, _NextOccupied(0)};
+        }
+        const_iterator end() const {
+            return {this, IdLimit()};
+        }
+
+        size_t size() const {
+            return m_size;
+        }
+        bool empty() const {
+            return m_size == 0;
+        }
+
+      private:
+        // First occupied ID at or after id, IdLimit if none
+        uint32_t _NextOccupied(uint32_t const id) const {
+            for (size_t wordIdx = id / 64; wordIdx < m_occupied.size(); ++wordIdx) {
+                uint64_t const word{wordIdx == id / 64 ? m_occupied[wordIdx] & (~0ull << (id % 64)) : m_occupied[wordIdx]};
+                if (word != 0) {
+                    return static_cast<uint32_t>(wordIdx * 64 + std::countr_zero(word));
+                }
+            }
+            return IdLimit();
+        }
+
+        std::vector<value_type> m_entries;
+        std::vector<uint64_t> m_occupied;
+        size_t m_size{0};
+    };
+} // namespace LibOpenNFS
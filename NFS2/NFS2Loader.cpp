@@ -1,5 +1,6 @@
 #include "NFS2Loader.h"
 
+#include "Common/GeometryUtils.h"
 #include "Common/Logging.h"
 #include "Common/TextureUtils.h"
 
@@ -7,7 +8,8 @@
 
 namespace LibOpenNFS::NFS2 {
     template <typename Platform>
-    Car Loader<Platform>::LoadCar(std::string const &carBasePath, std::string const &carOutPath, NFSVersion nfsVersion) {
+    Car Loader<Platform>::LoadCar(std::string const &carBasePath, std::string const &carOutPath, NFSVersion nfsVersion,
+                                  LoadOptions const &options) {
         std::filesystem::path p(carBasePath);
         std::string carName = p.filename().string();
 
@@ -40,10 +42,13 @@ namespace LibOpenNFS::NFS2 {
         ASSERT(GeoFile<Platform>::Load(geoPath, geoFile), "Could not load GEO file: " << geoPath);
 
         Car::MetaData const carData = _ParseGEOModels(geoFile);
-        return Car(carData, nfsVersion, carName, true);
+        Car car(carData, nfsVersion, carName, true);
+        GeometryUtils::PostProcess(car, options);
+
+        return car;
     }
 
-    template <> Track Loader<PC>::LoadTrack(NFSVersion nfsVersion, std::string const &trackBasePath) {
+    template <> Track Loader<PC>::LoadTrack(NFSVersion nfsVersion, std::string const &trackBasePath, LoadOptions const &options) {
         LogInfo("Loading Track located at %s", trackBasePath.c_str());
         std::filesystem::path p(trackBasePath);
         Track track(nfsVersion, p.filename().string(), trackBasePath);
@@ -77,17 +82,19 @@ namespace LibOpenNFS::NFS2 {
 
         track.nBlocks = trkFile.nBlocks;
         track.cameraAnimation = canFile.animPoints;
-        track.trackTextureAssets = _ParseTextures(track);
+        track.trackTextureAssets = _ParseTextures(track, options);
         track.trackBlocks = _ParseTRKModels(trkFile, colFile, track);
         track.globalObjects = _ParseCOLModels(colFile, track);
         track.virtualRoad = _ParseVirtualRoad(colFile);
+        track.UpdateBounds();
+        GeometryUtils::PostProcess(track, options);
 
         LogInfo("Track loaded successfully");
 
         return track;
     }
 
-    template <> Track Loader<PS1>::LoadTrack(NFSVersion const nfsVersion, std::string const &trackBasePath) {
+    template <> Track Loader<PS1>::LoadTrack(NFSVersion const nfsVersion, std::string const &trackBasePath, LoadOptions const &options) {
         LogInfo("Loading Track located at %s", trackBasePath.c_str());
         std::filesystem::path p(trackBasePath);
         Track track(nfsVersion, p.filename().string(), trackBasePath);
@@ -105,10 +112,12 @@ namespace LibOpenNFS::NFS2 {
                "Could not load COL file: " << colPath); // Load Catalogue file to get global (non block specific) data
 
         track.nBlocks = trkFile.nBlocks;
-        track.trackTextureAssets = _ParseTextures(track);
+        track.trackTextureAssets = _ParseTextures(track, options);
         track.trackBlocks = _ParseTRKModels(trkFile, colFile, track);
         track.globalObjects = _ParseCOLModels(colFile, track);
         track.virtualRoad = _ParseVirtualRoad(colFile);
+        track.UpdateBounds();
+        GeometryUtils::PostProcess(track, options);
 
         LogInfo("Track loaded successfully");
 
@@ -234,22 +243,36 @@ namespace LibOpenNFS::NFS2 {
         return carMetadata;
     }
 
-    template <typename Platform> std::map<uint32_t, TrackTextureAsset> Loader<Platform>::_ParseTextures(Track const &track) {
-        Shared::FshArchive archive;
-        ASSERT(archive.Load(track.texturePath), "Failed to load texture archive: " << track.texturePath << " - " << archive.LastError());
+    template <typename Platform> TrackTextureTable Loader<Platform>::_ParseTextures(Track const &track, LoadOptions const &options) {
+        std::shared_ptr<Shared::FshArchive const> archivePtr;
+        ASSERT(Shared::FshArchive::LoadShared(track.texturePath, archivePtr),
+               "Failed to load texture archive: " << track.texturePath << " - " << archivePtr->LastError());
+        Shared::FshArchive const &archive{*archivePtr};
 
-        std::map<uint32_t, TrackTextureAsset> textureAssetMap;
+        TrackTextureTable textureAssetMap;
         size_t max_width{0}, max_height{0};
 
-        uint32_t texId{0};
+        // Decode every texture up front, across threads, unless they're decoded lazily
+        std::vector<Shared::FshTexture const *> textures;
+        textures.reserve(archive.TextureCount());
         for (auto const &tex : archive.Textures()) {
+            textures.push_back(&tex);
+        }
+        std::vector<std::vector<uint8_t>> pixels{options.textureCache ? std::vector<std::vector<uint8_t>>()
+                                                                      : TextureCache::DecodeMany(textures)};
+
+        for (uint32_t texId{0}; texId < textures.size(); ++texId) {
+            auto const &tex{*textures[texId]};
             // Find the maximum width and height for UV scaling
             max_width = tex.Width() > max_width ? tex.Width() : max_width;
             max_height = tex.Height() > max_height ? tex.Height() : max_height;
 
-            // Get pixel data directly from FSH as RGBA
-            textureAssetMap[texId] = TrackTextureAsset(texId, tex.Width(), tex.Height(), tex.ToRGBA());
-            texId++;
+            if (options.textureCache) {
+                textureAssetMap[texId] = TrackTextureAsset(texId, tex.Width(), tex.Height(), archivePtr, texId, options.textureCache);
+            } else {
+                // Pixel data decoded from FSH as RGBA
+                textureAssetMap[texId] = TrackTextureAsset(texId, tex.Width(), tex.Height(), std::move(pixels[texId]));
+            }
         }
 
         // Now that maximum width/height is known, set the Max U/V for the texture
@@ -381,7 +404,7 @@ namespace LibOpenNFS::NFS2 {
                         for (uint32_t polyIdx = 0; polyIdx < structures[structureIdx].nPoly; ++polyIdx) {
                             // Remap the COL TextureID's using the COL texture block (XBID2)
                             TEXTURE_BLOCK polygonTexture = polyToQfsTexTable[structures[structureIdx].polygonTable[polyIdx].texture];
-                            TrackTextureAsset textureAsset = track.trackTextureAssets.at(polygonTexture.texNumber);
+                            TrackTextureAsset const &textureAsset{track.trackTextureAssets.at(polygonTexture.texNumber)};
                             // Convert the UV's into ONFS space, to enable tiling/mirroring etc based on NFS texture flags
                             std::vector<glm::vec2> uvs{{1.0f, 1.0f}, {0.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 0.0f}};
                             std::vector<glm::vec2> transformedUVs = textureAsset.ScaleUVs(uvs, false, std::is_same_v<Platform, PS1>, 0);
@@ -447,7 +470,7 @@ namespace LibOpenNFS::NFS2 {
                      polyIdx < (rawTrackBlock.nLowResPoly + rawTrackBlock.nMedResPoly + rawTrackBlock.nHighResPoly); ++polyIdx) {
                     // Remap the COL TextureID's using the COL texture block (XBID2)
                     TEXTURE_BLOCK polygonTexture = polyToQfsTexTable[rawTrackBlock.polygonTable[polyIdx].texture];
-                    TrackTextureAsset textureAsset = track.trackTextureAssets.at(polygonTexture.texNumber);
+                    TrackTextureAsset const &textureAsset{track.trackTextureAssets.at(polygonTexture.texNumber)};
                     // Convert the UV's into ONFS space, to enable tiling/mirroring etc based on NFS texture flags
                     std::vector<glm::vec2> uvs{{1.0f, 1.0f}, {0.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 0.0f}};
                     std::vector<glm::vec2> transformedUVs =
@@ -566,7 +589,7 @@ namespace LibOpenNFS::NFS2 {
             for (uint32_t polyIdx = 0; polyIdx < structures[structureIdx].nPoly; ++polyIdx) {
                 // Remap the COL TextureID's using the COL texture block (XBID2)
                 TEXTURE_BLOCK polygonTexture = polyToQfsTexTable[structures[structureIdx].polygonTable[polyIdx].texture];
-                TrackTextureAsset textureAsset = track.trackTextureAssets.at(polygonTexture.texNumber);
+                TrackTextureAsset const &textureAsset{track.trackTextureAssets.at(polygonTexture.texNumber)};
                 // Calculate the normal, as no provided data
                 glm::vec3 normal =
                     Utils::CalculateQuadNormal(globalStructureVertices[structures[structureIdx].polygonTable[polyIdx].vertex[0]],
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "COL/ColFile.h"
+#include "Common/LoadOptions.h"
 #include "Entities/Car.h"
 #include "Entities/Track.h"
 #include "Entities/TrackBlock.h"
@@ -14,12 +15,13 @@ namespace LibOpenNFS::NFS2 {
 
     template <typename Platform> class Loader {
       public:
-        static Car LoadCar(std::string const &carBasePath, std::string const &carOutPath, NFSVersion nfsVersion);
-        static Track LoadTrack(NFSVersion nfsVersion, std::string const &trackBasePath);
+        static Car LoadCar(std::string const &carBasePath, std::string const &carOutPath, NFSVersion nfsVersion,
+                           LoadOptions const &options = {});
+        static Track LoadTrack(NFSVersion nfsVersion, std::string const &trackBasePath, LoadOptions const &options = {});
 
       private:
         static Car::MetaData _ParseGEOModels(GeoFile<Platform> const &geoFile);
-        static std::map<uint32_t, TrackTextureAsset> _ParseTextures(Track const &track);
+        static TrackTextureTable _ParseTextures(Track const &track, LoadOptions const &options);
         static std::vector<LibOpenNFS::TrackBlock> _ParseTRKModels(TrkFile<Platform> const &trkFile, ColFile<Platform> &colFile,
                                                                    Track const &track);
         static std::vector<TrackVRoad> _ParseVirtualRoad(ColFile<Platform> &colFile);
@@ -1,5 +1,6 @@
 #include "NFS3Loader.h"
 
+#include <Common/GeometryUtils.h>
 #include <Common/Logging.h>
 #include <Common/Utils.h>
 #include <Entities/TrackEntity.h>
@@ -7,10 +8,12 @@
 #include <Entities/TrackSound.h>
 #include <Shared/FSH/FshArchive.h>
 
+#include <algorithm>
 #include <filesystem>
+#include <iterator>
 
 namespace LibOpenNFS::NFS3 {
-    Car Loader::LoadCar(std::string const &carBasePath, std::string const &carOutPath) {
+    Car Loader::LoadCar(std::string const &carBasePath, std::string const &carOutPath, LoadOptions const &options) {
         LogInfo("Loading NFS3 car from %s into %s", carBasePath.c_str(), carOutPath.c_str());
 
         std::filesystem::path p(carBasePath);
@@ -47,11 +50,13 @@ namespace LibOpenNFS::NFS3 {
         }
 
         Car::MetaData carData = _ParseAssetData(fceFile, fedataFile);
+        Car car(carData, NFSVersion::NFS_3, carName, carPhysicsData);
+        GeometryUtils::PostProcess(car, options);
 
-        return Car(carData, NFSVersion::NFS_3, carName, carPhysicsData);
+        return car;
     }
 
-    Track Loader::LoadTrack(std::string const &trackBasePath) {
+    Track Loader::LoadTrack(std::string const &trackBasePath, LoadOptions const &options, ProgressiveTrackLoad *progressiveLoad) {
         LogInfo("Loading Track located at %s", trackBasePath.c_str());
         std::filesystem::path p(trackBasePath);
         std::string trackName = p.filename().string();
@@ -88,16 +93,67 @@ namespace LibOpenNFS::NFS3 {
 
         track.nBlocks = frdFile.nBlocks;
         track.cameraAnimation = canFile.animPoints;
-        track.trackTextureAssets = _ParseTextures(frdFile, track);
-        track.trackBlocks = _ParseFRDModels(frdFile, track);
-        track.globalObjects = _ParseCOLModels(colFile, track, frdFile.textureBlocks);
+        track.trackTextureAssets = _ParseTextures(frdFile, track, options);
+        track.skyTextureAssets = _ParseSkyTextures(track, options);
+        if (progressiveLoad == nullptr) {
+            track.trackBlocks = _ParseFRDModels(frdFile, track);
+        }
+        track.globalObjects = _ParseCOLModels(colFile, track, frdFile.textureBlocks, options);
         track.virtualRoad = _ParseVirtualRoad(colFile);
+        if (progressiveLoad != nullptr) {
+            _StartProgressiveLoad(std::move(frdFile), track, options, *progressiveLoad);
+            return track;
+        }
+        track.UpdateBounds();
+        GeometryUtils::PostProcess(track, options);
 
         LogInfo("Track loaded successfully");
 
         return track;
     }
 
+    void Loader::_StartProgressiveLoad(FrdFile &&frdFile, Track &track, LoadOptions const &options,
+                                       ProgressiveTrackLoad &progressiveLoad) {
+        // Placeholders carry the block metadata until the geometry is built
+        track.trackBlocks.clear();
+        track.trackBlocks.reserve(frdFile.nBlocks);
+        for (uint32_t trackblockIdx = 0; trackblockIdx < frdFile.nBlocks; ++trackblockIdx) {
+            track.trackBlocks.emplace_back(_ParseFRDBlockHeader(frdFile, trackblockIdx));
+        }
+
+        // Only the global objects have geometry at this point, the blocks are post-processed as they are built
+        LoadOptions blockOptions{options};
+        if (blockOptions.instanceObjects) {
+            LogWarning("Object instancing needs every block, skipped when loading progressively");
+            blockOptions.instanceObjects = false;
+        }
+        GeometryUtils::PostProcess(track, blockOptions);
+
+        // The start grid is at the beginning of the virtual road, fall back to where the intro camera starts
+        glm::vec3 startPosition{track.trackBlocks.empty() ? glm::vec3(0.f) : track.trackBlocks.front().position};
+        if (!track.virtualRoad.empty()) {
+            startPosition = track.virtualRoad.front().position;
+        } else if (!track.cameraAnimation.empty()) {
+            startPosition = Utils::FixedToFloat(glm::vec3(track.cameraAnimation.front().pt)) * TRACK_SCALE_FACTOR;
+        }
+
+        // Blocks are built off the calling thread while the caller owns the track, so the builder keeps its own FRD data, and a
+        // copy of the texture table without pixel data (UV scaling only needs texture dimensions)
+        auto const sharedFrdFile{std::make_shared<FrdFile const>(std::move(frdFile))};
+        auto const textureTrack{std::make_shared<Track>(track.nfsVersion, track.name, track.basePath, track.tag)};
+        for (auto const &[textureId, textureAsset] : track.trackTextureAssets) {
+            TrackTextureAsset &textureCopy{textureTrack->trackTextureAssets[textureId]};
+            textureCopy = textureAsset;
+            std::vector<uint8_t>().swap(textureCopy.data);
+        }
+        progressiveLoad.Start(track, ProgressiveTrackLoad::BuildOrder(track, startPosition),
+                              [sharedFrdFile, textureTrack, blockOptions](uint32_t const trackblockIdx) {
+                                  TrackBlock trackBlock{_ParseFRDBlock(*sharedFrdFile, *textureTrack, trackblockIdx)};
+                                  GeometryUtils::PostProcess(trackBlock, blockOptions);
+                                  return trackBlock;
+                              });
+    }
+
     FedataFile Loader::LoadCarMenuData(std::string const &carBasePath, std::string const &carOutPath) {
         LogInfo("Loading NFS3 car menu data from %s into %s", carBasePath.c_str(), carOutPath.c_str());
 
@@ -142,10 +198,11 @@ namespace LibOpenNFS::NFS3 {
         std::stringstream archivePath;
         archivePath << artBasePath << "/slides/t" << trackId.back() << "_00.qfs";
 
-        LibOpenNFS::Shared::FshArchive archive;
-        ASSERT(archive.Load(archivePath.str()), "Failed to load track preview image archive: " << archivePath.str() << " - " << archive.LastError());
+        std::shared_ptr<LibOpenNFS::Shared::FshArchive const> archive;
+        ASSERT(LibOpenNFS::Shared::FshArchive::LoadShared(archivePath.str(), archive),
+               "Failed to load track preview image archive: " << archivePath.str() << " - " << archive->LastError());
 
-        return archive.GetTexture(0);
+        return archive->GetTexture(0);
     }
 
     Car::MetaData Loader::_ParseAssetData(FceFile const &fceFile, FedataFile const &fedataFile) {
@@ -215,42 +272,93 @@ namespace LibOpenNFS::NFS3 {
         return physicsData;
     }
 
-    std::map<uint32_t, TrackTextureAsset> Loader::_ParseTextures(FrdFile const &frdFile, Track const &track) {
-        Shared::FshArchive archive;
-        ASSERT(archive.Load(track.texturePath), "Failed to load texture archive: " << track.texturePath << " - " << archive.LastError());
+    TrackTextureTable Loader::_ParseTextures(FrdFile const &frdFile, Track const &track, LoadOptions const &options) {
+        std::shared_ptr<Shared::FshArchive const> archivePtr;
+        ASSERT(Shared::FshArchive::LoadShared(track.texturePath, archivePtr),
+               "Failed to load texture archive: " << track.texturePath << " - " << archivePtr->LastError());
+        Shared::FshArchive const &archive{*archivePtr};
 
-        std::map<uint32_t, TrackTextureAsset> textureAssetMap;
+        TrackTextureTable textureAssetMap;
         size_t max_width{0}, max_height{0};
 
-        // Load QFS texture information into ONFS texture objects
+        // Some TexBlocks don't appear to be genuine, though their QfsIndex seems sane. Skip over them, as their
+        // height is disproportionate to the rest (approaching UINT16_MAX vs <= 256). This upsets Texture Array
+        // scaling.
+        std::vector<TexBlock const *> texBlocks;
         for (auto &frdTexBlock : frdFile.textureBlocks) {
-            // Some TexBlocks don't appear to be genuine, though their QfsIndex seems sane. Skip over them, as their
-            // height is disproportionate to the rest (approaching UINT16_MAX vs <= 256). This upsets Texture Array
-            // scaling.
             if (frdTexBlock.unknown1 == 0xFF000000 && frdTexBlock.unknown2 == 0xFF000000 ||
-                frdTexBlock.qfsIndex >= archive.TextureCount()) {
+                !frdTexBlock.isLane && frdTexBlock.qfsIndex >= archive.TextureCount()) {
                 LogWarning("Skipping FRD Texture Block with QFS Index: %d as corrupted. Width: %u, Num QFS Textures: %u",
                            frdTexBlock.qfsIndex, frdTexBlock.width, frdTexBlock.qfsIndex, archive.TextureCount());
                 continue;
             }
+            texBlocks.push_back(&frdTexBlock);
+        }
+
+        // Lane textures come from the game's shared sfx archive rather than the track's, offset by 9
+        std::shared_ptr<Shared::FshArchive const> sfxArchivePtr;
+        if (std::any_of(texBlocks.begin(), texBlocks.end(), [](TexBlock const *frdTexBlock) { return frdTexBlock->isLane; })) {
+            std::string const sfxPath{options.sfxArchivePath.empty()
+                                          ? (std::filesystem::path(track.basePath) / ".." / ".." / "render" / "pc" / "sfx.fsh").string()
+                                          : options.sfxArchivePath};
+            if (!Shared::FshArchive::LoadShared(sfxPath, sfxArchivePtr)) {
+                LogWarning("Could not load lane texture archive %s (%s), falling back to extracted sfx bitmaps", sfxPath.c_str(),
+                           sfxArchivePtr->LastError().c_str());
+                sfxArchivePtr.reset();
+            }
+        }
+        auto const laneTextureIdx = [](TexBlock const *frdTexBlock) { return static_cast<uint32_t>(frdTexBlock->qfsIndex + 9); };
+
+        // Source texture of every TexBlock, nullptr for lanes missing from the sfx archive
+        std::vector<Shared::FshTexture const *> sourceTextures;
+        for (auto const *frdTexBlock : texBlocks) {
+            if (!frdTexBlock->isLane) {
+                sourceTextures.push_back(&archive.GetTexture(frdTexBlock->qfsIndex));
+            } else if (sfxArchivePtr != nullptr && laneTextureIdx(frdTexBlock) < sfxArchivePtr->TextureCount()) {
+                sourceTextures.push_back(&sfxArchivePtr->GetTexture(laneTextureIdx(frdTexBlock)));
+            } else {
+                sourceTextures.push_back(nullptr);
+            }
+        }
+
+        // Decode every source texture up front, across threads, unless they're decoded lazily
+        std::vector<Shared::FshTexture const *> textures;
+        if (!options.textureCache) {
+            std::copy_if(sourceTextures.begin(), sourceTextures.end(), std::back_inserter(textures),
+                         [](Shared::FshTexture const *texture) { return texture != nullptr; });
+        }
+        std::vector<std::vector<uint8_t>> pixels{TextureCache::DecodeMany(textures)};
+        auto nextPixels{pixels.begin()};
+
+        // Load QFS texture information into ONFS texture objects
+        for (size_t texBlockIdx = 0; texBlockIdx < texBlocks.size(); ++texBlockIdx) {
+            TexBlock const *frdTexBlock{texBlocks[texBlockIdx]};
+            Shared::FshTexture const *sourceTexture{sourceTextures[texBlockIdx]};
+            // Lane textures take the size of the sfx texture, the TexBlock describes where they're used
+            uint32_t const width{frdTexBlock->isLane && sourceTexture != nullptr ? sourceTexture->Width() : frdTexBlock->width};
+            uint32_t const height{frdTexBlock->isLane && sourceTexture != nullptr ? sourceTexture->Height() : frdTexBlock->height};
 
             // Find the maximum width and height, so we can avoid overestimating with blanket values (256x256) and
             // thereby scale UV's unnecessarily
-            max_width = frdTexBlock.width > max_width ? frdTexBlock.width : max_width;
-            max_height = frdTexBlock.height > max_height ? frdTexBlock.height : max_height;
+            max_width = width > max_width ? width : max_width;
+            max_height = height > max_height ? height : max_height;
 
-            if (frdTexBlock.isLane) {
-                // Lane textures come from a separate sfx archive - use legacy file path for now
+            if (sourceTexture == nullptr) {
+                // No sfx archive, reference the lane texture as previously extracted to disk
                 std::stringstream fileReference, alphaFileReference;
-                fileReference << "../resources/sfx/" << std::setfill('0') << std::setw(4) << frdTexBlock.qfsIndex + 9 << ".BMP";
-                alphaFileReference << "../resources/sfx/" << std::setfill('0') << std::setw(4) << frdTexBlock.qfsIndex + 9 << "-a.BMP";
-                textureAssetMap[frdTexBlock.qfsIndex] = TrackTextureAsset(frdTexBlock.qfsIndex, frdTexBlock.width, frdTexBlock.height,
-                                                                          fileReference.str(), alphaFileReference.str());
+                fileReference << "../resources/sfx/" << std::setfill('0') << std::setw(4) << laneTextureIdx(frdTexBlock) << ".BMP";
+                alphaFileReference << "../resources/sfx/" << std::setfill('0') << std::setw(4) << laneTextureIdx(frdTexBlock) << "-a.BMP";
+                textureAssetMap[frdTexBlock->qfsIndex] =
+                    TrackTextureAsset(frdTexBlock->qfsIndex, width, height, fileReference.str(), alphaFileReference.str());
+            } else if (options.textureCache) {
+                textureAssetMap[frdTexBlock->qfsIndex] =
+                    frdTexBlock->isLane
+                        ? TrackTextureAsset(frdTexBlock->qfsIndex, width, height, sfxArchivePtr, laneTextureIdx(frdTexBlock),
+                                            options.textureCache)
+                        : TrackTextureAsset(frdTexBlock->qfsIndex, width, height, archivePtr, frdTexBlock->qfsIndex, options.textureCache);
             } else {
-                // Get pixel data directly from FSH archive
-                auto const &fshTexture = archive.GetTexture(frdTexBlock.qfsIndex);
-                textureAssetMap[frdTexBlock.qfsIndex] =
-                    TrackTextureAsset(frdTexBlock.qfsIndex, frdTexBlock.width, frdTexBlock.height, fshTexture.ToRGBA());
+                // Pixel data decoded from the FSH archive as RGBA
+                textureAssetMap[frdTexBlock->qfsIndex] = TrackTextureAsset(frdTexBlock->qfsIndex, width, height, std::move(*nextPixels++));
             }
         }
 
@@ -264,6 +372,43 @@ namespace LibOpenNFS::NFS3 {
         return textureAssetMap;
     }
 
+    TrackTextureTable Loader::_ParseSkyTextures(Track const &track, LoadOptions const &options) {
+        std::string const skyPath{track.basePath + "/sky.fsh"};
+        if (!std::filesystem::exists(skyPath)) {
+            return {};
+        }
+        std::shared_ptr<Shared::FshArchive const> archivePtr;
+        if (!Shared::FshArchive::LoadShared(skyPath, archivePtr)) {
+            LogWarning("Could not load sky texture archive %s (%s)", skyPath.c_str(), archivePtr->LastError().c_str());
+            return {};
+        }
+        Shared::FshArchive const &archive{*archivePtr};
+
+        std::vector<Shared::FshTexture const *> textures;
+        for (auto const &tex : archive.Textures()) {
+            textures.push_back(&tex);
+        }
+        std::vector<std::vector<uint8_t>> pixels{options.textureCache ? std::vector<std::vector<uint8_t>>()
+                                                                      : TextureCache::DecodeMany(textures)};
+
+        // Sky textures are mapped whole, so unlike track textures their UVs aren't scaled to a shared maximum size
+        TrackTextureTable skyTextureAssets;
+        for (uint32_t texId{0}; texId < textures.size(); ++texId) {
+            auto const &tex{*textures[texId]};
+            TrackTextureAsset &textureAsset{skyTextureAssets[texId]};
+            if (options.textureCache) {
+                textureAsset = TrackTextureAsset(texId, tex.Width(), tex.Height(), archivePtr, texId, options.textureCache);
+            } else {
+                textureAsset = TrackTextureAsset(texId, tex.Width(), tex.Height(), std::move(pixels[texId]));
+            }
+            textureAsset.maxU = 1.f;
+            textureAsset.maxV = 1.f;
+        }
+        LogInfo("Loaded %zu sky textures from %s", skyTextureAssets.size(), skyPath.c_str());
+
+        return skyTextureAssets;
+    }
+
     std::vector<TrackBlock> Loader::_ParseFRDModels(FrdFile const &frdFile, Track const &track) {
         LogInfo("Parsing TRK file into ONFS GL structures");
         std::vector<TrackBlock> trackBlocks;
@@ -271,202 +416,261 @@ namespace LibOpenNFS::NFS3 {
 
         /* TRKBLOCKS - BASE TRACK GEOMETRY */
         for (uint32_t trackblockIdx = 0; trackblockIdx < frdFile.nBlocks; ++trackblockIdx) {
-            // Get Verts from Trk block, indices from associated polygon block
-            TrkBlock rawTrackBlock{frdFile.trackBlocks[trackblockIdx]};
-            PolyBlock trackPolygonBlock{frdFile.polygonBlocks[trackblockIdx]};
-
-            glm::vec3 rawTrackBlockCenter{rawTrackBlock.ptCentre * TRACK_SCALE_FACTOR};
-            std::vector<uint32_t> trackBlockNeighbourIds;
-            std::vector<glm::vec3> trackBlockVerts;
-            std::vector<glm::vec4> trackBlockShadingData;
-
-            // Get neighbouring block IDs
-            for (auto &[blk, unknown] : rawTrackBlock.nbdData) {
-                if (blk == -1) {
-                    break;
-                }
-                trackBlockNeighbourIds.emplace_back(blk);
-            }
+            trackBlocks.emplace_back(_ParseFRDBlock(frdFile, track, trackblockIdx));
+        }
+        return trackBlocks;
+    }
 
-            // Build the base OpenNFS trackblock, to hold all the geometry and virtual road data, lights, sounds etc.
-            // for this portion of track
-            TrackBlock trackBlock(trackblockIdx, rawTrackBlockCenter, rawTrackBlock.nStartPos, rawTrackBlock.nPositions,
-                                  trackBlockNeighbourIds);
+    TrackBlock Loader::_ParseFRDBlockHeader(FrdFile const &frdFile, uint32_t const trackblockIdx) {
+        TrkBlock const &rawTrackBlock{frdFile.trackBlocks[trackblockIdx]};
+        glm::vec3 rawTrackBlockCenter{rawTrackBlock.ptCentre * TRACK_SCALE_FACTOR};
+        std::vector<uint32_t> trackBlockNeighbourIds;
 
-            // Light and sound sources
-            for (uint32_t lightNum = 0; lightNum < rawTrackBlock.nLightsrc; ++lightNum) {
-                glm::vec3 lightCenter{Utils::FixedToFloat(rawTrackBlock.lightsrc[lightNum].refpoint) * TRACK_SCALE_FACTOR};
-                trackBlock.lights.emplace_back(lightNum, lightCenter, rawTrackBlock.lightsrc[lightNum].type);
-            }
-            for (uint32_t soundNum = 0; soundNum < rawTrackBlock.nSoundsrc; ++soundNum) {
-                glm::vec3 soundCenter{Utils::FixedToFloat(rawTrackBlock.soundsrc[soundNum].refpoint) * TRACK_SCALE_FACTOR};
-                trackBlock.sounds.emplace_back(soundNum, soundCenter, rawTrackBlock.soundsrc[soundNum].type);
+        // Get neighbouring block IDs
+        for (auto &[blk, unknown] : rawTrackBlock.nbdData) {
+            if (blk == -1) {
+                break;
             }
+            trackBlockNeighbourIds.emplace_back(blk);
+        }
 
-            // Get Trackblock roadVertices and per-vertex shading data
-            for (uint32_t vertIdx = 0; vertIdx < rawTrackBlock.nObjectVert; ++vertIdx) {
-                trackBlockVerts.emplace_back((rawTrackBlock.vert[vertIdx] * TRACK_SCALE_FACTOR) - rawTrackBlockCenter);
-                trackBlockShadingData.emplace_back(TextureUtils::ShadingDataToVec4(rawTrackBlock.vertShading[vertIdx]));
-            }
+        return TrackBlock(trackblockIdx, rawTrackBlockCenter, rawTrackBlock.nStartPos, rawTrackBlock.nPositions, trackBlockNeighbourIds);
+    }
 
-            // 4 OBJ Poly blocks
-            for (uint32_t j = 0; j < 4; ++j) {
-                ObjectPolyBlock polygonBlock{trackPolygonBlock.obj[j]};
-
-                if (polygonBlock.n1 > 0) {
-                    // Iterate through objects in objpoly block up to num objects
-                    for (uint32_t objectIdx = 0; objectIdx < polygonBlock.nobj; ++objectIdx) {
-                        // Mesh Data
-                        std::vector<uint32_t> vertexIndices;
-                        std::vector<uint32_t> textureIndices;
-                        std::vector<glm::vec2> uvs;
-                        std::vector<glm::vec3> normals;
-                        uint32_t accumulatedObjectFlags{0u};
-
-                        // Get Polygons in object
-                        std::vector<PolygonData> objectPolygons{polygonBlock.poly[objectIdx]};
-
-                        for (uint32_t polyIdx = 0; polyIdx < polygonBlock.numpoly[objectIdx]; ++polyIdx) {
-                            // Texture for this polygon and it's loaded OpenGL equivalent
-                            TexBlock polygonTexture{frdFile.textureBlocks[objectPolygons[polyIdx].textureId]};
-                            // Convert the UV's into ONFS space, to enable tiling/mirroring etc based on NFS texture
-                            // flags
-                            TrackTextureAsset trackTextureAsset{track.trackTextureAssets.at(polygonTexture.qfsIndex)};
-                            std::vector<glm::vec2> transformedUVs{trackTextureAsset.ScaleUVs(polygonTexture.GetUVs(), false, false)};
-                            uvs.insert(uvs.end(), transformedUVs.begin(), transformedUVs.end());
-
-                            // Calculate the normal, as the provided data is a little suspect
-                            glm::vec3 normal{Utils::CalculateQuadNormal(rawTrackBlock.vert[objectPolygons[polyIdx].vertex[0]],
-                                                                        rawTrackBlock.vert[objectPolygons[polyIdx].vertex[1]],
-                                                                        rawTrackBlock.vert[objectPolygons[polyIdx].vertex[2]],
-                                                                        rawTrackBlock.vert[objectPolygons[polyIdx].vertex[3]])};
-
-                            // Two triangles per raw quad, hence 6 vertices. Normal data and texture index required
-                            // per-vertex.
-                            for (auto &quadToTriVertNumber : quadToTriVertNumbers) {
-                                normals.emplace_back(normal);
-                                vertexIndices.emplace_back(objectPolygons[polyIdx].vertex[quadToTriVertNumber]);
-                                textureIndices.emplace_back(polygonTexture.qfsIndex);
-                            }
-
-                            accumulatedObjectFlags |= objectPolygons[polyIdx].flags;
-                        }
-                        TrackGeometry trackBlockModel(trackBlockVerts, normals, uvs, textureIndices, vertexIndices, trackBlockShadingData,
-                                                      rawTrackBlockCenter);
-                        trackBlock.objects.emplace_back((j + 1) * (objectIdx + 1), EntityType::OBJ_POLY, trackBlockModel,
-                                                        accumulatedObjectFlags);
-                    }
-                }
-            }
+    TrackBlock Loader::_ParseFRDBlock(FrdFile const &frdFile, Track const &track, uint32_t const trackblockIdx) {
+        // Get Verts from Trk block, indices from associated polygon block
+        TrkBlock const &rawTrackBlock{frdFile.trackBlocks[trackblockIdx]};
+        PolyBlock const &trackPolygonBlock{frdFile.polygonBlocks[trackblockIdx]};
+
+        glm::vec3 rawTrackBlockCenter{rawTrackBlock.ptCentre * TRACK_SCALE_FACTOR};
+        std::vector<glm::vec3> trackBlockVerts;
+        std::vector<glm::vec4> trackBlockShadingData;
+
+        // Build the base OpenNFS trackblock, to hold all the geometry and virtual road data, lights, sounds etc.
+        // for this portion of track
+        TrackBlock trackBlock{_ParseFRDBlockHeader(frdFile, trackblockIdx)};
+
+        // Light and sound sources
+        for (uint32_t lightNum = 0; lightNum < rawTrackBlock.nLightsrc; ++lightNum) {
+            glm::vec3 lightCenter{Utils::FixedToFloat(rawTrackBlock.lightsrc[lightNum].refpoint) * TRACK_SCALE_FACTOR};
+            trackBlock.lights.emplace_back(lightNum, lightCenter, rawTrackBlock.lightsrc[lightNum].type);
+        }
+        for (uint32_t soundNum = 0; soundNum < rawTrackBlock.nSoundsrc; ++soundNum) {
+            glm::vec3 soundCenter{Utils::FixedToFloat(rawTrackBlock.soundsrc[soundNum].refpoint) * TRACK_SCALE_FACTOR};
+            trackBlock.sounds.emplace_back(soundNum, soundCenter, rawTrackBlock.soundsrc[soundNum].type);
+        }
+
+        // Get Trackblock roadVertices and per-vertex shading data
+        for (uint32_t vertIdx = 0; vertIdx < rawTrackBlock.nObjectVert; ++vertIdx) {
+            trackBlockVerts.emplace_back((rawTrackBlock.vert[vertIdx] * TRACK_SCALE_FACTOR) - rawTrackBlockCenter);
+            trackBlockShadingData.emplace_back(TextureUtils::ShadingDataToVec4(rawTrackBlock.vertShading[vertIdx]));
+        }
+
+        // 4 OBJ Poly blocks
+        for (uint32_t j = 0; j < 4; ++j) {
+            ObjectPolyBlock polygonBlock{trackPolygonBlock.obj[j]};
 
-            /* XOBJS - EXTRA OBJECTS */
-            for (uint32_t l = (trackblockIdx * 4); l < (trackblockIdx * 4) + 5; ++l) {
-                for (uint32_t j = 0; j < frdFile.extraObjectBlocks.at(l).nobj; ++j) {
+            if (polygonBlock.n1 > 0) {
+                // Iterate through objects in objpoly block up to num objects
+                for (uint32_t objectIdx = 0; objectIdx < polygonBlock.nobj; ++objectIdx) {
                     // Mesh Data
-                    std::vector<glm::vec3> extraObjectVerts;
-                    std::vector<glm::vec4> extraObjectShadingData;
                     std::vector<uint32_t> vertexIndices;
                     std::vector<uint32_t> textureIndices;
                     std::vector<glm::vec2> uvs;
                     std::vector<glm::vec3> normals;
                     uint32_t accumulatedObjectFlags{0u};
 
-                    // Get the Extra object data for this trackblock object from the global xobj table
-                    ExtraObjectData extraObjectData{frdFile.extraObjectBlocks[l].obj[j]};
+                    // Get Polygons in object
+                    std::vector<PolygonData> objectPolygons{polygonBlock.poly[objectIdx]};
 
-                    for (uint32_t vertIdx = 0; vertIdx < extraObjectData.nVertices; vertIdx++) {
-                        extraObjectVerts.emplace_back(extraObjectData.vert[vertIdx] * TRACK_SCALE_FACTOR);
-                        extraObjectShadingData.emplace_back(TextureUtils::ShadingDataToVec4(extraObjectData.vertShading[vertIdx]));
-                    }
-
-                    for (uint32_t k = 0; k < extraObjectData.nPolygons; k++) {
-                        TexBlock blockTexture{frdFile.textureBlocks[extraObjectData.polyData[k].textureId]};
-                        TrackTextureAsset trackTextureAsset{track.trackTextureAssets.at(blockTexture.qfsIndex)};
-                        std::vector<glm::vec2> transformedUVs{trackTextureAsset.ScaleUVs(blockTexture.GetUVs(), true, false)};
+                    for (uint32_t polyIdx = 0; polyIdx < polygonBlock.numpoly[objectIdx]; ++polyIdx) {
+                        // Texture for this polygon and it's loaded OpenGL equivalent
+                        TexBlock polygonTexture{frdFile.textureBlocks[objectPolygons[polyIdx].textureId]};
+                        // Convert the UV's into ONFS space, to enable tiling/mirroring etc based on NFS texture
+                        // flags
+                        TrackTextureAsset const &trackTextureAsset{track.trackTextureAssets.at(polygonTexture.qfsIndex)};
+                        std::vector<glm::vec2> transformedUVs{trackTextureAsset.ScaleUVs(polygonTexture.GetUVs(), false, false)};
                         uvs.insert(uvs.end(), transformedUVs.begin(), transformedUVs.end());
 
-                        glm::vec3 normal = Utils::CalculateQuadNormal(extraObjectVerts[extraObjectData.polyData[k].vertex[0]],
-                                                                      extraObjectVerts[extraObjectData.polyData[k].vertex[1]],
-                                                                      extraObjectVerts[extraObjectData.polyData[k].vertex[2]],
-                                                                      extraObjectVerts[extraObjectData.polyData[k].vertex[3]]);
+                        // Calculate the normal, as the provided data is a little suspect
+                        glm::vec3 normal{Utils::CalculateQuadNormal(rawTrackBlock.vert[objectPolygons[polyIdx].vertex[0]],
+                                                                    rawTrackBlock.vert[objectPolygons[polyIdx].vertex[1]],
+                                                                    rawTrackBlock.vert[objectPolygons[polyIdx].vertex[2]],
+                                                                    rawTrackBlock.vert[objectPolygons[polyIdx].vertex[3]])};
 
                         // Two triangles per raw quad, hence 6 vertices. Normal data and texture index required
                         // per-vertex.
                         for (auto &quadToTriVertNumber : quadToTriVertNumbers) {
                             normals.emplace_back(normal);
-                            vertexIndices.emplace_back(extraObjectData.polyData[k].vertex[quadToTriVertNumber]);
-                            textureIndices.emplace_back(blockTexture.qfsIndex);
+                            vertexIndices.emplace_back(objectPolygons[polyIdx].vertex[quadToTriVertNumber]);
+                            textureIndices.emplace_back(polygonTexture.qfsIndex);
                         }
 
-                        accumulatedObjectFlags |= extraObjectData.polyData[k].flags;
-                    }
-                    glm::vec3 extraObjectCenter{extraObjectData.ptRef * TRACK_SCALE_FACTOR};
-                    auto extraObjectModel{TrackGeometry(extraObjectVerts, normals, uvs, textureIndices, vertexIndices,
-                                                        extraObjectShadingData, extraObjectCenter)};
-                    if (extraObjectData.crosstype == 3) {
-                        auto extraObjectEntity{TrackEntity(l, EntityType::XOBJ, extraObjectModel, extraObjectData.animKeyframes,
-                                                           extraObjectData.AnimDelay, accumulatedObjectFlags)};
-                        trackBlock.objects.emplace_back(extraObjectEntity);
-                    } else {
-                        auto extraObjectEntity{TrackEntity(l, EntityType::XOBJ, extraObjectModel, accumulatedObjectFlags)};
-                        trackBlock.objects.emplace_back(extraObjectEntity);
+                        accumulatedObjectFlags |= objectPolygons[polyIdx].flags;
                     }
+                    TrackGeometry trackBlockModel(trackBlockVerts, normals, uvs, textureIndices, vertexIndices, trackBlockShadingData,
+                                                  rawTrackBlockCenter);
+                    trackBlock.objects.emplace_back((j + 1) * (objectIdx + 1), EntityType::OBJ_POLY, trackBlockModel,
+                                                    accumulatedObjectFlags);
                 }
             }
+        }
 
-            // Road Mesh data
-            std::vector<glm::vec3> roadVertices;
-            std::vector<glm::vec4> roadShadingData;
-            std::vector<uint32_t> vertexIndices;
-            std::vector<uint32_t> textureIndices;
-            std::vector<glm::vec2> uvs;
-            std::vector<glm::vec3> normals;
-            uint32_t accumulatedObjectFlags{0u};
-
-            for (uint32_t vertIdx = 0; vertIdx < rawTrackBlock.nVertices; ++vertIdx) {
-                roadVertices.emplace_back((rawTrackBlock.vert[vertIdx] * TRACK_SCALE_FACTOR) - rawTrackBlockCenter);
-                roadShadingData.emplace_back(TextureUtils::ShadingDataToVec4(rawTrackBlock.vertShading[vertIdx]));
-            }
-            // Get indices from Chunk 4 and 5 for High Res polys, Chunk 6 for Road Lanes
-            for (uint32_t lodChunkIdx = 4; lodChunkIdx <= 6; lodChunkIdx++) {
-                // If there are no lane markers in the lane chunk, skip
-                if ((lodChunkIdx == 6) && (rawTrackBlock.nVertices <= rawTrackBlock.nHiResVert)) {
-                    continue;
+        /* XOBJS - EXTRA OBJECTS */
+        for (uint32_t l = (trackblockIdx * 4); l < (trackblockIdx * 4) + 5; ++l) {
+            for (uint32_t j = 0; j < frdFile.extraObjectBlocks.at(l).nobj; ++j) {
+                // Mesh Data
+                std::vector<glm::vec3> extraObjectVerts;
+                std::vector<glm::vec4> extraObjectShadingData;
+                std::vector<uint32_t> vertexIndices;
+                std::vector<uint32_t> textureIndices;
+                std::vector<glm::vec2> uvs;
+                std::vector<glm::vec3> normals;
+                uint32_t accumulatedObjectFlags{0u};
+
+                // Get the Extra object data for this trackblock object from the global xobj table
+                ExtraObjectData extraObjectData{frdFile.extraObjectBlocks[l].obj[j]};
+
+                for (uint32_t vertIdx = 0; vertIdx < extraObjectData.nVertices; vertIdx++) {
+                    extraObjectVerts.emplace_back(extraObjectData.vert[vertIdx] * TRACK_SCALE_FACTOR);
+                    extraObjectShadingData.emplace_back(TextureUtils::ShadingDataToVec4(extraObjectData.vertShading[vertIdx]));
                 }
 
-                // Get the polygon data for this road section
-                std::vector<PolygonData> chunkPolygonData{trackPolygonBlock.poly[lodChunkIdx]};
-
-                for (uint32_t polyIdx = 0; polyIdx < trackPolygonBlock.sz[lodChunkIdx]; polyIdx++) {
-                    TexBlock polygonTexture{frdFile.textureBlocks[chunkPolygonData[polyIdx].textureId]};
-                    TrackTextureAsset trackTextureAsset{track.trackTextureAssets.at(polygonTexture.qfsIndex)};
-                    std::vector<glm::vec2> transformedUVs{trackTextureAsset.ScaleUVs(polygonTexture.GetUVs(), false, false)};
+                for (uint32_t k = 0; k < extraObjectData.nPolygons; k++) {
+                    TexBlock blockTexture{frdFile.textureBlocks[extraObjectData.polyData[k].textureId]};
+                    TrackTextureAsset const &trackTextureAsset{track.trackTextureAssets.at(blockTexture.qfsIndex)};
+                    std::vector<glm::vec2> transformedUVs{trackTextureAsset.ScaleUVs(blockTexture.GetUVs(), true, false)};
                     uvs.insert(uvs.end(), transformedUVs.begin(), transformedUVs.end());
 
-                    glm::vec3 normal = Utils::CalculateQuadNormal(
-                        rawTrackBlock.vert[chunkPolygonData[polyIdx].vertex[0]], rawTrackBlock.vert[chunkPolygonData[polyIdx].vertex[1]],
-                        rawTrackBlock.vert[chunkPolygonData[polyIdx].vertex[2]], rawTrackBlock.vert[chunkPolygonData[polyIdx].vertex[3]]);
+                    glm::vec3 normal = Utils::CalculateQuadNormal(extraObjectVerts[extraObjectData.polyData[k].vertex[0]],
+                                                                  extraObjectVerts[extraObjectData.polyData[k].vertex[1]],
+                                                                  extraObjectVerts[extraObjectData.polyData[k].vertex[2]],
+                                                                  extraObjectVerts[extraObjectData.polyData[k].vertex[3]]);
 
-                    // Two triangles per raw quad, hence 6 vertices. Normal data and texture index required per-vertex.
+                    // Two triangles per raw quad, hence 6 vertices. Normal data and texture index required
+                    // per-vertex.
                     for (auto &quadToTriVertNumber : quadToTriVertNumbers) {
                         normals.emplace_back(normal);
-                        vertexIndices.emplace_back(chunkPolygonData[polyIdx].vertex[quadToTriVertNumber]);
-                        textureIndices.emplace_back(polygonTexture.qfsIndex);
+                        vertexIndices.emplace_back(extraObjectData.polyData[k].vertex[quadToTriVertNumber]);
+                        textureIndices.emplace_back(blockTexture.qfsIndex);
                     }
 
-                    accumulatedObjectFlags |= chunkPolygonData[polyIdx].flags;
+                    accumulatedObjectFlags |= extraObjectData.polyData[k].flags;
                 }
-                auto roadModel{
-                    TrackGeometry(roadVertices, normals, uvs, textureIndices, vertexIndices, roadShadingData, rawTrackBlockCenter)};
-                if (lodChunkIdx == 6) {
-                    trackBlock.lanes.emplace_back(-1, EntityType::LANE, roadModel, accumulatedObjectFlags);
+                glm::vec3 extraObjectCenter{extraObjectData.ptRef * TRACK_SCALE_FACTOR};
+                auto extraObjectModel{TrackGeometry(extraObjectVerts, normals, uvs, textureIndices, vertexIndices,
+                                                    extraObjectShadingData, extraObjectCenter)};
+                if (extraObjectData.crosstype == 3) {
+                    auto extraObjectEntity{TrackEntity(l, EntityType::XOBJ, extraObjectModel, extraObjectData.animKeyframes,
+                                                       extraObjectData.AnimDelay, accumulatedObjectFlags)};
+                    trackBlock.objects.emplace_back(extraObjectEntity);
                 } else {
-                    trackBlock.track.emplace_back(-1, EntityType::ROAD, roadModel, accumulatedObjectFlags);
+                    auto extraObjectEntity{TrackEntity(l, EntityType::XOBJ, extraObjectModel, accumulatedObjectFlags)};
+                    trackBlock.objects.emplace_back(extraObjectEntity);
                 }
             }
-            trackBlocks.emplace_back(trackBlock);
         }
-        return trackBlocks;
+
+        // Road Mesh data
+        std::vector<glm::vec3> roadVertices;
+        std::vector<glm::vec4> roadShadingData;
+        std::vector<uint32_t> vertexIndices;
+        std::vector<uint32_t> textureIndices;
+        std::vector<glm::vec2> uvs;
+        std::vector<glm::vec3> normals;
+        uint32_t accumulatedObjectFlags{0u};
+
+        for (uint32_t vertIdx = 0; vertIdx < rawTrackBlock.nVertices; ++vertIdx) {
+            roadVertices.emplace_back((rawTrackBlock.vert[vertIdx] * TRACK_SCALE_FACTOR) - rawTrackBlockCenter);
+            roadShadingData.emplace_back(TextureUtils::ShadingDataToVec4(rawTrackBlock.vertShading[vertIdx]));
+        }
+        // Get indices from Chunk 4 and 5 for High Res polys, Chunk 6 for Road Lanes
+        for (uint32_t lodChunkIdx = 4; lodChunkIdx <= 6; lodChunkIdx++) {
+            // If there are no lane markers in the lane chunk, skip
+            if ((lodChunkIdx == 6) && (rawTrackBlock.nVertices <= rawTrackBlock.nHiResVert)) {
+                continue;
+            }
+
+            // Get the polygon data for this road section
+            std::vector<PolygonData> chunkPolygonData{trackPolygonBlock.poly[lodChunkIdx]};
+
+            for (uint32_t polyIdx = 0; polyIdx < trackPolygonBlock.sz[lodChunkIdx]; polyIdx++) {
+                TexBlock polygonTexture{frdFile.textureBlocks[chunkPolygonData[polyIdx].textureId]};
+                TrackTextureAsset const &trackTextureAsset{track.trackTextureAssets.at(polygonTexture.qfsIndex)};
+                std::vector<glm::vec2> transformedUVs{trackTextureAsset.ScaleUVs(polygonTexture.GetUVs(), false, false)};
+                uvs.insert(uvs.end(), transformedUVs.begin(), transformedUVs.end());
+
+                glm::vec3 normal = Utils::CalculateQuadNormal(
+                    rawTrackBlock.vert[chunkPolygonData[polyIdx].vertex[0]], rawTrackBlock.vert[chunkPolygonData[polyIdx].vertex[1]],
+                    rawTrackBlock.vert[chunkPolygonData[polyIdx].vertex[2]], rawTrackBlock.vert[chunkPolygonData[polyIdx].vertex[3]]);
+
+                // Two triangles per raw quad, hence 6 vertices. Normal data and texture index required per-vertex.
+                for (auto &quadToTriVertNumber : quadToTriVertNumbers) {
+                    normals.emplace_back(normal);
+                    vertexIndices.emplace_back(chunkPolygonData[polyIdx].vertex[quadToTriVertNumber]);
+                    textureIndices.emplace_back(polygonTexture.qfsIndex);
+                }
+
+                accumulatedObjectFlags |= chunkPolygonData[polyIdx].flags;
+            }
+            auto roadModel{
+                TrackGeometry(roadVertices, normals, uvs, textureIndices, vertexIndices, roadShadingData, rawTrackBlockCenter)};
+            if (lodChunkIdx == 6) {
+                trackBlock.lanes.emplace_back(-1, EntityType::LANE, roadModel, accumulatedObjectFlags);
+            } else {
+                trackBlock.track.emplace_back(-1, EntityType::ROAD, roadModel, accumulatedObjectFlags);
+            }
+        }
+
+        // Chunks 0/1 hold the low res, 2/3 the medium res versions of the road
+        trackBlock.nLowResVertices = rawTrackBlock.nLoResVert;
+        trackBlock.nMedResVertices = rawTrackBlock.nMedResVert;
+        trackBlock.nHighResVertices = rawTrackBlock.nHiResVert;
+        for (uint32_t lodChunkIdx = 0; lodChunkIdx < 4; ++lodChunkIdx) {
+            if (trackPolygonBlock.sz[lodChunkIdx] == 0) {
+                continue;
+            }
+            auto &lodEntities{lodChunkIdx < 2 ? trackBlock.lowResTrack : trackBlock.medResTrack};
+            lodEntities.push_back(_ParseLODChunk(frdFile, track, rawTrackBlock, trackPolygonBlock.poly[lodChunkIdx],
+                                                 trackPolygonBlock.sz[lodChunkIdx], roadVertices, roadShadingData));
+        }
+        return trackBlock;
+    }
+
+    TrackEntity Loader::_ParseLODChunk(FrdFile const &frdFile, Track const &track, TrkBlock const &rawTrackBlock,
+                                       std::vector<PolygonData> const &chunkPolygonData, uint32_t const nPolygons,
+                                       std::vector<glm::vec3> const &roadVertices, std::vector<glm::vec4> const &roadShadingData) {
+        std::vector<uint32_t> vertexIndices;
+        std::vector<uint32_t> textureIndices;
+        std::vector<glm::vec2> uvs;
+        std::vector<glm::vec3> normals;
+        uint32_t accumulatedObjectFlags{0u};
+
+        for (uint32_t polyIdx = 0; polyIdx < nPolygons; ++polyIdx) {
+            PolygonData const &polygon{chunkPolygonData[polyIdx]};
+            TexBlock polygonTexture{frdFile.textureBlocks[polygon.textureId]};
+            TrackTextureAsset const &trackTextureAsset{track.trackTextureAssets.at(polygonTexture.qfsIndex)};
+            std::vector<glm::vec2> transformedUVs{trackTextureAsset.ScaleUVs(polygonTexture.GetUVs(), false, false)};
+            uvs.insert(uvs.end(), transformedUVs.begin(), transformedUVs.end());
+
+            glm::vec3 normal = Utils::CalculateQuadNormal(rawTrackBlock.vert[polygon.vertex[0]], rawTrackBlock.vert[polygon.vertex[1]],
+                                                          rawTrackBlock.vert[polygon.vertex[2]], rawTrackBlock.vert[polygon.vertex[3]]);
+
+            // Two triangles per raw quad, hence 6 vertices. Normal data and texture index required per-vertex.
+            for (auto &quadToTriVertNumber : quadToTriVertNumbers) {
+                normals.emplace_back(normal);
+                vertexIndices.emplace_back(polygon.vertex[quadToTriVertNumber]);
+                textureIndices.emplace_back(polygonTexture.qfsIndex);
+            }
+
+            accumulatedObjectFlags |= polygon.flags;
+        }
+        TrackGeometry lodModel(roadVertices, normals, uvs, textureIndices, vertexIndices, roadShadingData,
+                               rawTrackBlock.ptCentre * TRACK_SCALE_FACTOR);
+        TrackEntity lodEntity(-1, EntityType::ROAD, lodModel, accumulatedObjectFlags);
+        lodEntity.collidable = false;
+
+        return lodEntity;
     }
 
     std::vector<TrackVRoad> Loader::_ParseVirtualRoad(ColFile const &colFile) {
@@ -493,46 +697,61 @@ namespace LibOpenNFS::NFS3 {
         return virtualRoad;
     }
 
-    std::vector<TrackEntity> Loader::_ParseCOLModels(ColFile const &colFile, Track const &track, std::vector<TexBlock> &texBlocks) {
+    std::vector<TrackEntity> Loader::_ParseCOLModels(ColFile const &colFile, Track const &track, std::vector<TexBlock> &texBlocks,
+                                                     LoadOptions const &options) {
         LogInfo("Parsing COL file into ONFS GL structures");
         std::vector<TrackEntity> colEntities;
 
+        // Many objects reference the same struct3D, so build each mesh once (in local space). With instancing the objects share it,
+        // otherwise each gets its own copy.
+        std::vector<std::shared_ptr<TrackGeometry>> struct3DMeshes(colFile.struct3D.size());
         for (uint32_t i = 0; i < colFile.objectHead.nrec; ++i) {
-            std::vector<uint32_t> indices;
-            std::vector<glm::vec2> uvs;
-            std::vector<uint32_t> texture_indices;
-            std::vector<glm::vec3> verts;
-            std::vector<glm::vec4> shading_data;
-            std::vector<glm::vec3> norms;
-
-            ColStruct3D s{colFile.struct3D[colFile.object[i].struct3D]};
-
-            for (uint32_t vertIdx = 0; vertIdx < s.nVert; ++vertIdx) {
-                verts.emplace_back(s.vertex[vertIdx].pt * TRACK_SCALE_FACTOR);
-                shading_data.emplace_back(TextureUtils::ShadingDataToVec4(s.vertex[vertIdx].unknown));
-            }
-            for (uint32_t polyIdx = 0; polyIdx < s.nPoly; ++polyIdx) {
-                // Remap the COL TextureID's using the COL texture block (XBID2)
-                ColTextureInfo colTexture{colFile.texture[s.polygon[polyIdx].texture]};
-                TexBlock frdTexture{texBlocks.at(colTexture.id)};
-                // Retrieve the GL texture for it so can scale UVs into texture array
-                TrackTextureAsset trackTextureAsset{track.trackTextureAssets.at(colTexture.id)};
-                std::vector<glm::vec2> transformedUVs{trackTextureAsset.ScaleUVs(frdTexture.GetUVs(), false, true)};
-                uvs.insert(uvs.end(), transformedUVs.begin(), transformedUVs.end());
+            ColObject const &object{colFile.object[i]};
+            std::shared_ptr<TrackGeometry> &struct3DMesh{struct3DMeshes.at(object.struct3D)};
+            if (!struct3DMesh) {
+                std::vector<uint32_t> indices;
+                std::vector<glm::vec2> uvs;
+                std::vector<uint32_t> texture_indices;
+                std::vector<glm::vec3> verts;
+                std::vector<glm::vec4> shading_data;
+                std::vector<glm::vec3> norms;
+
+                ColStruct3D const &s{colFile.struct3D[object.struct3D]};
+
+                for (uint32_t vertIdx = 0; vertIdx < s.nVert; ++vertIdx) {
+                    verts.emplace_back(s.vertex[vertIdx].pt * TRACK_SCALE_FACTOR);
+                    shading_data.emplace_back(TextureUtils::ShadingDataToVec4(s.vertex[vertIdx].unknown));
+                }
+                for (uint32_t polyIdx = 0; polyIdx < s.nPoly; ++polyIdx) {
+                    // Remap the COL TextureID's using the COL texture block (XBID2)
+                    ColTextureInfo colTexture{colFile.texture[s.polygon[polyIdx].texture]};
+                    TexBlock frdTexture{texBlocks.at(colTexture.id)};
+                    // Retrieve the GL texture for it so can scale UVs into texture array
+                    TrackTextureAsset const &trackTextureAsset{track.trackTextureAssets.at(colTexture.id)};
+                    std::vector<glm::vec2> transformedUVs{trackTextureAsset.ScaleUVs(frdTexture.GetUVs(), false, true)};
+                    uvs.insert(uvs.end(), transformedUVs.begin(), transformedUVs.end());
 
-                glm::vec3 normal{Utils::CalculateQuadNormal(verts[s.polygon[polyIdx].v[0]], verts[s.polygon[polyIdx].v[1]],
-                                                            verts[s.polygon[polyIdx].v[2]], verts[s.polygon[polyIdx].v[3]])};
+                    glm::vec3 normal{Utils::CalculateQuadNormal(verts[s.polygon[polyIdx].v[0]], verts[s.polygon[polyIdx].v[1]],
+                                                                verts[s.polygon[polyIdx].v[2]], verts[s.polygon[polyIdx].v[3]])};
 
-                // Two triangles per raw quad, hence 6 vertices. Normal data and texture index required per-vertex.
-                for (auto &quadToTriVertNumber : quadToTriVertNumbers) {
-                    indices.emplace_back(s.polygon[polyIdx].v[quadToTriVertNumber]);
-                    norms.emplace_back(normal);
-                    texture_indices.emplace_back(trackTextureAsset.id);
+                    // Two triangles per raw quad, hence 6 vertices. Normal data and texture index required per-vertex.
+                    for (auto &quadToTriVertNumber : quadToTriVertNumbers) {
+                        indices.emplace_back(s.polygon[polyIdx].v[quadToTriVertNumber]);
+                        norms.emplace_back(normal);
+                        texture_indices.emplace_back(trackTextureAsset.id);
+                    }
                 }
+                struct3DMesh =
+                    std::make_shared<TrackGeometry>(verts, norms, uvs, texture_indices, indices, shading_data, glm::vec3(0, 0, 0));
+            }
+            glm::vec3 position{glm::vec3(object.ptRef) * TRACK_SCALE_FACTOR};
+            if (options.instanceObjects) {
+                colEntities.emplace_back(i, EntityType::GLOBAL, struct3DMesh, position, 0);
+            } else {
+                TrackGeometry geometry{*struct3DMesh};
+                geometry.position = geometry.initialPosition = position;
+                colEntities.emplace_back(i, EntityType::GLOBAL, geometry, 0);
             }
-            glm::vec3 position{glm::vec3(colFile.object[i].ptRef) * TRACK_SCALE_FACTOR};
-            colEntities.emplace_back(i, EntityType::GLOBAL,
-                                     TrackGeometry(verts, norms, uvs, texture_indices, indices, shading_data, position), 0);
         }
 
         return colEntities;
@@ -9,6 +9,8 @@
 #include "../Shared/VIV/VivArchive.h"
 #include "../Shared/FSH/FshTexture.h"
 #include "COL/ColFile.h"
+#include "Common/LoadOptions.h"
+#include "Common/ProgressiveTrackLoad.h"
 #include "Common/TextureUtils.h"
 #include "Entities/Car.h"
 #include "Entities/Track.h"
@@ -29,8 +31,11 @@ namespace LibOpenNFS::NFS3 {
 
     class Loader {
       public:
-        static Car LoadCar(std::string const &carBasePath, std::string const &carOutPath);
-        static Track LoadTrack(std::string const &trackBasePath);
+        static Car LoadCar(std::string const &carBasePath, std::string const &carOutPath, LoadOptions const &options = {});
+        // With a progressiveLoad, returns once the blocks nearest the start grid are built, the rest of the blocks being placeholders
+        // that progressiveLoad builds in the background and hands over through ProgressiveTrackLoad::Poll
+        static Track LoadTrack(std::string const &trackBasePath, LoadOptions const &options = {},
+                               ProgressiveTrackLoad *progressiveLoad = nullptr);
 
         static FedataFile LoadCarMenuData(std::string const &carBasePath, std::string const &carOutPath);
         static TextFile LoadMenuText(std::string const &textBasePath);
@@ -39,9 +44,18 @@ namespace LibOpenNFS::NFS3 {
       private:
         static Car::MetaData _ParseAssetData(FceFile const &fceFile, FedataFile const &fedataFile);
         static Car::PhysicsData _ParsePhysicsData(Shared::CarpFile const &carpFile);
-        static std::map<uint32_t, TrackTextureAsset> _ParseTextures(FrdFile const &frdFile, Track const &track);
+        static TrackTextureTable _ParseTextures(FrdFile const &frdFile, Track const &track, LoadOptions const &options);
+        static TrackTextureTable _ParseSkyTextures(Track const &track, LoadOptions const &options);
         static std::vector<TrackBlock> _ParseFRDModels(FrdFile const &frdFile, Track const &track);
+        static TrackBlock _ParseFRDBlockHeader(FrdFile const &frdFile, uint32_t trackblockIdx);
+        static TrackBlock _ParseFRDBlock(FrdFile const &frdFile, Track const &track, uint32_t trackblockIdx);
+        static void _StartProgressiveLoad(FrdFile &&frdFile, Track &track, LoadOptions const &options,
+                                          ProgressiveTrackLoad &progressiveLoad);
+        static TrackEntity _ParseLODChunk(FrdFile const &frdFile, Track const &track, TrkBlock const &rawTrackBlock,
+                                          std::vector<PolygonData> const &chunkPolygonData, uint32_t nPolygons,
+                                          std::vector<glm::vec3> const &roadVertices, std::vector<glm::vec4> const &roadShadingData);
         static std::vector<TrackVRoad> _ParseVirtualRoad(ColFile const &colFile);
-        static std::vector<TrackEntity> _ParseCOLModels(ColFile const &colFile, Track const &track, std::vector<TexBlock> &texBlocks);
+        static std::vector<TrackEntity> _ParseCOLModels(ColFile const &colFile, Track const &track, std::vector<TexBlock> &texBlocks,
+                                                        LoadOptions const &options);
     };
 } // namespace LibOpenNFS::NFS3
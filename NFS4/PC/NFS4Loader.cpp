@@ -4,6 +4,7 @@
 #include "FRD/AnimBlock.h"
 
 #include <../../Shared/VIV/VivArchive.h>
+#include <Common/GeometryUtils.h>
 #include <Common/Logging.h>
 #include <Common/Utils.h>
 #include <Shared/FSH/FshArchive.h>
@@ -11,7 +12,8 @@
 #include <sstream>
 
 namespace LibOpenNFS::NFS4 {
-    Car Loader::LoadCar(std::string const &carBasePath, std::string const &carOutPath, NFSVersion version) {
+    Car Loader::LoadCar(std::string const &carBasePath, std::string const &carOutPath, NFSVersion version,
+                        LoadOptions const &options) {
         LogInfo("Loading NFS4 car from %s into %s", carBasePath.c_str(), carOutPath.c_str());
 
         std::filesystem::path p(carBasePath);
@@ -67,11 +69,13 @@ namespace LibOpenNFS::NFS4 {
         }
 
         Car::MetaData const carData{_ParseAssetData(fceFile, fedataFile, version)};
+        Car car(carData, version, carName, carPhysicsData);
+        GeometryUtils::PostProcess(car, options);
 
-        return Car(carData, version, carName, carPhysicsData);
+        return car;
     }
 
-    Track Loader::LoadTrack(std::string const &trackBasePath) {
+    Track Loader::LoadTrack(std::string const &trackBasePath, LoadOptions const &options) {
         LogInfo("Loading Track located at %s", trackBasePath.c_str());
         std::filesystem::path p(trackBasePath);
         std::string trackName = p.filename().string();
@@ -96,9 +100,11 @@ namespace LibOpenNFS::NFS4 {
 
         track.nBlocks = frdFile.nBlocks;
         track.cameraAnimation = canFile.animPoints;
-        track.trackTextureAssets = _ParseTextures(track);
+        track.trackTextureAssets = _ParseTextures(track, options);
         std::tie(track.trackBlocks, track.globalObjects) = _ParseFRDModels(frdFile, track);
         track.virtualRoad = _ParseVirtualRoad(frdFile);
+        track.UpdateBounds();
+        GeometryUtils::PostProcess(track, options);
 
         LogInfo("Track loaded successfully");
 
@@ -324,23 +330,36 @@ namespace LibOpenNFS::NFS4 {
         return physicsData;
     }
 
-    std::map<uint32_t, TrackTextureAsset> Loader::_ParseTextures(Track const &track) {
-        Shared::FshArchive archive;
-        ASSERT(archive.Load(track.texturePath, true),
-               "Failed to load texture archive: " << track.texturePath << " - " << archive.LastError());
+    TrackTextureTable Loader::_ParseTextures(Track const &track, LoadOptions const &options) {
+        std::shared_ptr<Shared::FshArchive const> archivePtr;
+        ASSERT(Shared::FshArchive::LoadShared(track.texturePath, archivePtr, true),
+               "Failed to load texture archive: " << track.texturePath << " - " << archivePtr->LastError());
+        Shared::FshArchive const &archive{*archivePtr};
 
-        std::map<uint32_t, TrackTextureAsset> textureAssetMap;
+        TrackTextureTable textureAssetMap;
         size_t max_width{0}, max_height{0};
 
-        uint32_t texId{0};
+        // Decode every texture up front, across threads, unless they're decoded lazily
+        std::vector<Shared::FshTexture const *> textures;
+        textures.reserve(archive.TextureCount());
         for (auto const &tex : archive.Textures()) {
+            textures.push_back(&tex);
+        }
+        std::vector<std::vector<uint8_t>> pixels{options.textureCache ? std::vector<std::vector<uint8_t>>()
+                                                                      : TextureCache::DecodeMany(textures)};
+
+        for (uint32_t texId{0}; texId < textures.size(); ++texId) {
+            auto const &tex{*textures[texId]};
             // Find the maximum width and height for UV scaling
             max_width = tex.Width() > max_width ? tex.Width() : max_width;
             max_height = tex.Height() > max_height ? tex.Height() : max_height;
 
-            // Get pixel data directly from FSH as RGBA
-            textureAssetMap[texId] = TrackTextureAsset(texId, tex.Width(), tex.Height(), tex.ToRGBA());
-            texId++;
+            if (options.textureCache) {
+                textureAssetMap[texId] = TrackTextureAsset(texId, tex.Width(), tex.Height(), archivePtr, texId, options.textureCache);
+            } else {
+                // Pixel data decoded from FSH as RGBA
+                textureAssetMap[texId] = TrackTextureAsset(texId, tex.Width(), tex.Height(), std::move(pixels[texId]));
+            }
         }
 
         // Now that maximum width/height is known, set the Max U/V for the texture
@@ -431,7 +450,7 @@ namespace LibOpenNFS::NFS4 {
 
                         /// Convert the UV's into ONFS space, to enable tiling/mirroring etc based on NFS texture
                         // flags
-                        TrackTextureAsset trackTextureAsset{track.trackTextureAssets.at(polygon.texture_id())};
+                        TrackTextureAsset const &trackTextureAsset{track.trackTextureAssets[polygon.texture_id()]};
                         std::vector<glm::vec2> temp_uvs{{1.0f, 1.0f}, {0.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 0.0f}};
                         std::vector<glm::vec2> transformedUVs{trackTextureAsset.ScaleUVs(
                             temp_uvs, false, !polygon.invert(), polygon.rotate(), polygon.mirror_x(), polygon.mirror_y())};
@@ -483,7 +502,7 @@ namespace LibOpenNFS::NFS4 {
                     if (!track.trackTextureAssets.contains(polygon.texture_id())) {
                         track.trackTextureAssets[polygon.texture_id()] = TrackTextureAsset(polygon.texture_id(), 64, 64, "", "");
                     }
-                    TrackTextureAsset trackTextureAsset{track.trackTextureAssets.at(polygon.texture_id())};
+                    TrackTextureAsset const &trackTextureAsset{track.trackTextureAssets[polygon.texture_id()]};
                     std::vector<glm::vec2> temp_uvs{{1.0f, 1.0f}, {0.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 0.0f}};
                     std::vector<glm::vec2> transformedUVs{trackTextureAsset.ScaleUVs(temp_uvs, false, !polygon.invert(), polygon.rotate(),
                                                                                      polygon.mirror_x(), polygon.mirror_y())};
@@ -511,6 +530,19 @@ namespace LibOpenNFS::NFS4 {
                 }
             }
 
+            // Low and medium resolution versions of the road
+            trackBlock.nLowResVertices = rawTrackBlock.header.nLoResVert;
+            trackBlock.nMedResVertices = rawTrackBlock.header.nMedResVert;
+            trackBlock.nHighResVertices = rawTrackBlock.header.nHiResVert;
+            for (uint32_t lodChunkIdx = PolygonChunkType::LOW_RES_TRACK; lodChunkIdx <= PolygonChunkType::MED_RES_MISC; ++lodChunkIdx) {
+                if (rawTrackBlock.header.sz[lodChunkIdx] == 0) {
+                    continue;
+                }
+                auto &lodEntities{lodChunkIdx <= PolygonChunkType::LOW_RES_MISC ? trackBlock.lowResTrack : trackBlock.medResTrack};
+                lodEntities.push_back(
+                    _ParseLODChunk(rawTrackBlock, static_cast<PolygonChunkType>(lodChunkIdx), roadVertices, roadShadingData, track));
+            }
+
             trackBlocks.push_back(trackBlock);
         }
 
@@ -557,7 +589,7 @@ namespace LibOpenNFS::NFS4 {
 
                         /// Convert the UV's into ONFS space, to enable tiling/mirroring etc based on NFS texture
                         // flags
-                        TrackTextureAsset trackTextureAsset{track.trackTextureAssets.at(polygon.texture_id())};
+                        TrackTextureAsset const &trackTextureAsset{track.trackTextureAssets[polygon.texture_id()]};
                         std::vector<glm::vec2> temp_uvs{{1.0f, 1.0f}, {0.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 0.0f}};
                         std::vector<glm::vec2> transformedUVs{trackTextureAsset.ScaleUVs(
                             temp_uvs, false, !polygon.invert(), polygon.rotate(), polygon.mirror_x(), polygon.mirror_y())};
@@ -593,6 +625,49 @@ namespace LibOpenNFS::NFS4 {
         return {trackBlocks, globalObjects};
     }
 
+    TrackEntity Loader::_ParseLODChunk(TrkBlock const &rawTrackBlock, PolygonChunkType const chunkType,
+                                       std::vector<glm::vec3> const &roadVertices, std::vector<glm::vec4> const &roadShadingData,
+                                       Track &track) {
+        std::vector<uint32_t> vertexIndices;
+        std::vector<uint32_t> textureIndices;
+        std::vector<glm::vec2> uvs;
+        std::vector<glm::vec3> normals;
+        uint32_t accumulatedObjectFlags{0u};
+
+        auto const &chunkPolygonData{rawTrackBlock.polygonData.at(chunkType)};
+        for (uint32_t polyIdx{0}; polyIdx < rawTrackBlock.header.sz[chunkType]; ++polyIdx) {
+            auto const &polygon{chunkPolygonData[polyIdx]};
+            // Convert the UV's into ONFS space, to enable tiling/mirroring etc based on NFS texture flags
+            if (!track.trackTextureAssets.contains(polygon.texture_id())) {
+                track.trackTextureAssets[polygon.texture_id()] =
+                    TrackTextureAsset(polygon.texture_id(), UINT32_MAX, UINT32_MAX, "", "");
+            }
+            TrackTextureAsset const &trackTextureAsset{track.trackTextureAssets[polygon.texture_id()]};
+            std::vector<glm::vec2> temp_uvs{{1.0f, 1.0f}, {0.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 0.0f}};
+            std::vector<glm::vec2> transformedUVs{trackTextureAsset.ScaleUVs(temp_uvs, false, !polygon.invert(), polygon.rotate(),
+                                                                             polygon.mirror_x(), polygon.mirror_y())};
+            uvs.insert(uvs.end(), transformedUVs.begin(), transformedUVs.end());
+
+            glm::vec3 const normal{Utils::CalculateQuadNormal(rawTrackBlock.vertices[polygon.vertex[0]], rawTrackBlock.vertices[polygon.vertex[1]],
+                                                              rawTrackBlock.vertices[polygon.vertex[2]], rawTrackBlock.vertices[polygon.vertex[3]])};
+
+            // Two triangles per raw quad, hence 6 vertices. Normal data and texture index required per-vertex.
+            for (auto &quadToTriVertNumber : quadToTriVertNumbers) {
+                normals.emplace_back(normal);
+                vertexIndices.emplace_back(polygon.vertex[quadToTriVertNumber]);
+                textureIndices.emplace_back(polygon.texture_id());
+            }
+
+            accumulatedObjectFlags |= polygon.texflags;
+        }
+        TrackGeometry lodModel(roadVertices, normals, uvs, textureIndices, vertexIndices, roadShadingData,
+                               rawTrackBlock.header.ptCentre * TRACK_SCALE_FACTOR);
+        TrackEntity lodEntity(-1, EntityType::ROAD, lodModel, accumulatedObjectFlags);
+        lodEntity.collidable = false;
+
+        return lodEntity;
+    }
+
     std::vector<TrackVRoad> Loader::_ParseVirtualRoad(FrdFile const &frdFile) {
         std::vector<TrackVRoad> virtualRoad;
 
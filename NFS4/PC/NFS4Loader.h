@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Common/LoadOptions.h"
 #include "Common/TextureUtils.h"
 #include "Entities/Car.h"
 #include "Entities/Track.h"
@@ -15,8 +16,9 @@ namespace LibOpenNFS::NFS4 {
 
     class Loader {
       public:
-        static Car LoadCar(std::string const &carBasePath, std::string const &carOutPath, NFSVersion version);
-        static Track LoadTrack(std::string const &trackBasePath);
+        static Car LoadCar(std::string const &carBasePath, std::string const &carOutPath, NFSVersion version,
+                           LoadOptions const &options = {});
+        static Track LoadTrack(std::string const &trackBasePath, LoadOptions const &options = {});
 
         static FedataFile LoadCarMenuData(std::string const &carBasePath, std::string const &carOutPath, NFSVersion version);
         static TextFile LoadMenuText(std::string const &textBasePath);
@@ -24,8 +26,10 @@ namespace LibOpenNFS::NFS4 {
       private:
         static Car::MetaData _ParseAssetData(FceFile const &fceFile, FedataFile const &fedataFile, NFSVersion version);
         static Car::PhysicsData _ParsePhysicsData(Shared::CarpFile const &carpFile);
-        static std::map<uint32_t, TrackTextureAsset> _ParseTextures(Track const &track);
+        static TrackTextureTable _ParseTextures(Track const &track, LoadOptions const &options);
         static std::pair<std::vector<TrackBlock>, std::vector<TrackEntity>> _ParseFRDModels(FrdFile const &frdFile, Track &track);
+        static TrackEntity _ParseLODChunk(TrkBlock const &rawTrackBlock, PolygonChunkType chunkType, std::vector<glm::vec3> const &roadVertices,
+                                          std::vector<glm::vec4> const &roadShadingData, Track &track);
         static std::vector<TrackVRoad> _ParseVirtualRoad(FrdFile const &frdFile);
     };
 
@@ -1,6 +1,12 @@
 #include "FshArchive.h"
+#include <atomic>
 #include <cstring>
 #include <filesystem>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#include "Common/Parallel.h"
 
 namespace LibOpenNFS::Shared {
     bool FshArchive::Load(std::string const &filepath, bool const skipMirroredImages) {
@@ -38,6 +44,53 @@ namespace LibOpenNFS::Shared {
         return ParseData();
     }
 
+    bool FshArchive::LoadShared(std::string const &filepath, std::shared_ptr<FshArchive const> &archive, bool const skipMirroredImages) {
+        using ArchiveKey = std::tuple<std::string, std::filesystem::file_time_type, bool>;
+        static std::mutex sharedArchivesMutex;
+        static std::map<ArchiveKey, std::weak_ptr<FshArchive const>> sharedArchives;
+
+        std::error_code ec;
+        auto const modificationTime{std::filesystem::last_write_time(filepath, ec)};
+        if (ec) {
+            auto failedArchive{std::make_shared<FshArchive>()};
+            failedArchive->m_lastError = "Failed to open file: " + filepath;
+            archive = std::move(failedArchive);
+            return false;
+        }
+        ArchiveKey const key{std::filesystem::absolute(filepath).lexically_normal().string(), modificationTime, skipMirroredImages};
+        {
+            std::lock_guard<std::mutex> lock(sharedArchivesMutex);
+            auto const archiveIt{sharedArchives.find(key)};
+            if (archiveIt != sharedArchives.end()) {
+                if ((archive = archiveIt->second.lock())) {
+                    return true;
+                }
+                sharedArchives.erase(archiveIt);
+            }
+        }
+
+        // Parse outside the lock, if another thread loads the same file meanwhile the first to finish is shared
+        auto loadedArchive{std::make_shared<FshArchive>()};
+        if (!loadedArchive->Load(filepath, skipMirroredImages)) {
+            archive = std::move(loadedArchive);
+            return false;
+        }
+        loadedArchive->ReleaseSourceData();
+
+        std::lock_guard<std::mutex> lock(sharedArchivesMutex);
+        auto &sharedArchive{sharedArchives[key]};
+        if (!(archive = sharedArchive.lock())) {
+            archive = std::move(loadedArchive);
+            sharedArchive = archive;
+        }
+        return true;
+    }
+
+    void FshArchive::ReleaseSourceData() {
+        std::vector<uint8_t>().swap(m_rawData);
+        std::vector<uint8_t>().swap(m_fshData);
+    }
+
     FshTexture const *FshArchive::GetTexture(std::string const &name) const {
         auto const it = m_textureMap.find(name);
         return it != m_textureMap.end() ? &m_textures[it->second] : nullptr;
@@ -47,41 +100,61 @@ namespace LibOpenNFS::Shared {
         return m_textures.at(index);
     }
 
-    bool FshArchive::ExtractAll(std::string const &outputDir, bool const preserveNames, bool const combineAlpha) const {
+    bool FshArchive::ExtractAll(std::string const &outputDir, bool const preserveNames, bool const combineAlpha,
+                                size_t const maxThreads) const {
         if (!std::filesystem::exists(outputDir)) {
             std::filesystem::create_directories(outputDir);
         }
 
-        for (size_t i = 0; i < m_textures.size(); ++i) {
-            auto const &tex = m_textures[i];
-
-            std::string filename;
-            if (preserveNames && IsValidFilename(tex.Name())) {
-                filename = tex.Name() + ".BMP";
-            } else {
-                char buf[16];
-                std::snprintf(buf, sizeof(buf), "%04zu.BMP", i);
-                filename = buf;
+        auto const fileBaseName = [&](size_t const i) -> std::string {
+            if (preserveNames && IsValidFilename(m_textures[i].Name())) {
+                return m_textures[i].Name();
             }
-
-            std::string const filepath = outputDir + "/" + filename;
-            if (!tex.ExportToBmp(filepath, combineAlpha)) {
-                m_lastError = "Failed to export texture: " + filepath;
-                return false;
+            char buf[16];
+            std::snprintf(buf, sizeof(buf), "%04zu", i);
+            return buf;
+        };
+
+        // Each texture is decoded once for both of its files, and each file is built in memory and written in one go
+        // Report the lowest failing index, as the sequential export did
+        std::atomic<size_t> firstFailure{m_textures.size()};
+        auto const recordFailure = [&](size_t const i) {
+            size_t failure = firstFailure.load();
+            while (i < failure && !firstFailure.compare_exchange_weak(failure, i)) {
             }
+        };
+        Utils::ParallelFor(
+            m_textures.size(),
+            [&](size_t const i) {
+                auto const &tex = m_textures[i];
+                std::string const baseName = fileBaseName(i);
+
+                std::vector<uint32_t> pixels;
+                try {
+                    pixels = tex.ToARGB32();
+                } catch (std::exception const &) {
+                    recordFailure(i);
+                    return;
+                }
+                std::vector<uint8_t> const bmp = tex.BuildBmp(pixels, combineAlpha);
+                std::ofstream file(outputDir + "/" + baseName + ".BMP", std::ios::binary);
+                if (!file || !file.write(reinterpret_cast<char const *>(bmp.data()), static_cast<std::streamsize>(bmp.size()))) {
+                    recordFailure(i);
+                    return;
+                }
 
-            // Export separate alpha channel if requested and texture has alpha
-            if (!combineAlpha && tex.HasAlpha()) {
-                std::string alphaFilename;
-                if (preserveNames && IsValidFilename(tex.Name())) {
-                    alphaFilename = tex.Name() + "-a.BMP";
-                } else {
-                    char buf[16];
-                    std::snprintf(buf, sizeof(buf), "%04zu-a.BMP", i);
-                    alphaFilename = buf;
+                // Export separate alpha channel if requested and texture has alpha
+                if (!combineAlpha && tex.HasAlpha()) {
+                    std::vector<uint8_t> const alphaBmp = tex.BuildAlphaBmp(pixels);
+                    std::ofstream alphaFile(outputDir + "/" + baseName + "-a.BMP", std::ios::binary);
+                    alphaFile.write(reinterpret_cast<char const *>(alphaBmp.data()), static_cast<std::streamsize>(alphaBmp.size()));
                 }
-                tex.ExportAlphaToBmp(outputDir + "/" + alphaFilename);
-            }
+            },
+            maxThreads);
+
+        if (firstFailure < m_textures.size()) {
+            m_lastError = "Failed to export texture: " + outputDir + "/" + fileBaseName(firstFailure) + ".BMP";
+            return false;
         }
 
         return true;
@@ -283,34 +356,7 @@ namespace LibOpenNFS::Shared {
         auto const format = static_cast<PixelFormat>(code);
         FshTexture texture(name, header->width, header->height, format);
 
-        // Calculate pixel data size
-        size_t dataSize = 0;
-        switch (format) {
-        case PixelFormat::Indexed4Bit:
-        case PixelFormat::Indexed8Bit:
-        case PixelFormat::Indexed8BitPSH:
-            dataSize = static_cast<size_t>(header->width) * header->height;
-            break;
-        case PixelFormat::ARGB32:
-            dataSize = static_cast<size_t>(header->width) * header->height * 4;
-            break;
-        case PixelFormat::RGB24:
-            dataSize = static_cast<size_t>(header->width) * header->height * 3;
-            break;
-        case PixelFormat::ARGB16_1555:
-        case PixelFormat::RGB16_565:
-        case PixelFormat::ARGB16_4444:
-            dataSize = static_cast<size_t>(header->width) * header->height * 2;
-            break;
-        case PixelFormat::DXT1:
-            dataSize = static_cast<size_t>((header->width + 3) / 4) * ((header->height + 3) / 4) * 8;
-            break;
-        case PixelFormat::DXT3:
-            dataSize = static_cast<size_t>((header->width + 3) / 4) * ((header->height + 3) / 4) * 16;
-            break;
-        default:
-            break;
-        }
+        size_t const dataSize = GetPixelDataSize(format, static_cast<size_t>(header->width), static_cast<size_t>(header->height));
 
         // Extract pixel data
         size_t const pixelDataOffset = offset + 16;
@@ -338,6 +384,7 @@ namespace LibOpenNFS::Shared {
         // Parse attachments (local palette, alpha, etc.)
         size_t attachOffset = offset;
         auto const *attachHeader = header;
+        bool hasLocalPalette = false;
 
         while (attachHeader->GetNextOffset() > 0) {
             attachOffset += static_cast<size_t>(attachHeader->GetNextOffset());
@@ -350,16 +397,19 @@ namespace LibOpenNFS::Shared {
             // Check for local palette
             if (IsPaletteCode(attachCode) && texture.HasPalette()) {
                 ParsePalette(attachOffset, texture.GetPalette());
+                hasLocalPalette = true;
             }
         }
 
         // Apply global palette if no local palette and format requires it
-        if (texture.HasPalette() && m_hasGlobalPalette) {
+        if (texture.HasPalette() && !hasLocalPalette && m_hasGlobalPalette) {
             texture.GetPalette() = m_globalPalette;
         }
 
         // Set alpha flag based on format
         texture.SetHasAlphaAttachment(HasAlphaChannel(format));
+        // Hashed once here rather than on every texture cache lookup
+        texture.CacheContentHash();
 
         return texture;
     }
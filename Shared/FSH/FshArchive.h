@@ -4,6 +4,7 @@
 #include "FshTypes.h"
 #include "QfsCompression.h"
 
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -46,6 +47,16 @@ namespace LibOpenNFS::Shared {
         bool Load(std::vector<uint8_t> const &data, bool skipMirroredImages = false);
         bool Load(std::vector<uint8_t> &&data, bool skipMirroredImages = false);
 
+        /**
+         * Load an FSH or QFS archive from file, sharing it with everything else in the process that loaded the same file (same
+         * path and modification time) and still holds it. Shared archives have their source data released.
+         * @param filepath Path to the archive file
+         * @param archive Set to the shared archive, or on failure to the archive that failed to load (for LastError)
+         * @param skipMirroredImages If true, skip mirrored/duplicate images (used for NFS4 track textures)
+         * @return true on success
+         */
+        static bool LoadShared(std::string const &filepath, std::shared_ptr<FshArchive const> &archive, bool skipMirroredImages = false);
+
         /**
          * Check if archive was compressed (QFS)
          */
@@ -91,9 +102,15 @@ namespace LibOpenNFS::Shared {
          * @param outputDir Output directory path
          * @param preserveNames If true, use original 4-char names; if false, use numbered names
          * @param combineAlpha If true, export as 32-bit BGRA with alpha embedded; if false, export separate alpha files
+         * @param maxThreads Textures are decoded and written in parallel across up to this many threads (0 = hardware concurrency)
          * @return true on success
          */
-        bool ExtractAll(std::string const &outputDir, bool preserveNames = false, bool combineAlpha = true) const;
+        bool ExtractAll(std::string const &outputDir, bool preserveNames = false, bool combineAlpha = true, size_t maxThreads = 0) const;
+
+        /**
+         * Free the file and decompressed FSH bytes kept from Load. Only parsing needs them, the textures hold their own data.
+         */
+        void ReleaseSourceData();
 
         /**
          * Get the last error message
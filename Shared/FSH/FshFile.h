@@ -45,9 +45,15 @@
  *   - 32-bit ARGB
  *   - DXT1 compressed
  *   - DXT3 compressed (with alpha)
+ *
+ * Archives are written back with FshWriter, optionally QFS compressed:
+ *
+ *   FshWriter writer = FshWriter::FromArchive(archive);
+ *   writer.Save("track0.qfs", true);
  */
 
 #include "FshArchive.h"
 #include "FshTexture.h"
 #include "FshTypes.h"
+#include "FshWriter.h"
 #include "QfsCompression.h"
\ No newline at end of file
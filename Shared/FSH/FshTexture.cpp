@@ -1,16 +1,52 @@
 #include "FshTexture.h"
 
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ONFS_FSH_SSE2
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "Common/Parallel.h"
+
 namespace LibOpenNFS::Shared {
+    namespace {
+        template <typename T> void HashBytes(uint64_t &hash, T const *data, size_t const count) {
+            auto const *bytes{reinterpret_cast<unsigned char const *>(data)};
+            for (size_t byteIdx = 0; byteIdx < count * sizeof(T); ++byteIdx) {
+                hash = (hash ^ bytes[byteIdx]) * 0x100000001B3ull;
+            }
+            // Separate the arrays, so that data moving between them changes the hash
+            hash = (hash ^ count) * 0x100000001B3ull;
+        }
+    } // namespace
+
+    uint64_t FshTexture::ComputeContentHash() const {
+        uint64_t hash{0xCBF29CE484222325ull};
+        uint16_t const header[]{m_width, m_height, static_cast<uint16_t>(m_format), static_cast<uint16_t>(m_hasAlphaAttachment)};
+        HashBytes(hash, header, std::size(header));
+        HashBytes(hash, m_rawData.data(), m_rawData.size());
+        HashBytes(hash, m_alphaData.data(), m_alphaData.size());
+        if (HasPalette()) {
+            for (auto const &colour : m_palette.Colors()) {
+                uint8_t const channels[]{colour.r, colour.g, colour.b, colour.a};
+                HashBytes(hash, channels, std::size(channels));
+            }
+        }
+        return hash;
+    }
+
     std::vector<uint32_t> FshTexture::ToARGB32() const {
         std::vector<uint32_t> pixels(static_cast<size_t>(m_width) * m_height);
 
         switch (m_format) {
         case PixelFormat::Indexed4Bit:
-            ConvertIndexed4ToARGB32(pixels);
-            break;
         case PixelFormat::Indexed8Bit:
         case PixelFormat::Indexed8BitPSH:
-            ConvertIndexed8ToARGB32(pixels);
+            DecodeIndexed(reinterpret_cast<uint8_t *>(pixels.data()), false);
             break;
         case PixelFormat::ARGB32:
             ConvertARGB32(pixels);
@@ -31,11 +67,15 @@ namespace LibOpenNFS::Shared {
             ConvertARGB16_4444ToARGB32(pixels);
             break;
         case PixelFormat::DXT1:
-            DecompressDXT1ToARGB32(pixels);
-            break;
-        case PixelFormat::DXT3:
-            DecompressDXT3ToARGB32(pixels);
+        case PixelFormat::DXT3: {
+            std::vector<uint8_t> rgba;
+            DecodeDXTToRGBA(rgba);
+            for (size_t i = 0; i < pixels.size(); ++i) {
+                pixels[i] = (static_cast<uint32_t>(rgba[i * 4 + 3]) << 24) | (static_cast<uint32_t>(rgba[i * 4 + 0]) << 16) |
+                            (static_cast<uint32_t>(rgba[i * 4 + 1]) << 8) | rgba[i * 4 + 2];
+            }
             break;
+        }
         default:
             throw std::runtime_error("Unsupported pixel format for conversion");
         }
@@ -44,6 +84,16 @@ namespace LibOpenNFS::Shared {
     }
 
     std::vector<uint8_t> FshTexture::ToRGBA() const {
+        std::vector<uint8_t> dxtRgba;
+        if (DecodeDXTToRGBA(dxtRgba)) {
+            return dxtRgba;
+        }
+        if (HasPalette()) {
+            std::vector<uint8_t> rgba(static_cast<size_t>(m_width) * m_height * 4);
+            DecodeIndexed(rgba.data(), true);
+            return rgba;
+        }
+
         auto const argb = ToARGB32();
         std::vector<uint8_t> rgba(argb.size() * 4);
 
@@ -58,145 +108,156 @@ namespace LibOpenNFS::Shared {
         return rgba;
     }
 
-    bool FshTexture::ExportToBmp(std::string const &filepath, bool includeAlpha) const {
-        std::ofstream file(filepath, std::ios::binary);
-        if (!file)
-            return false;
-
-        // Convert to ARGB32
-        std::vector<uint32_t> pixels = ToARGB32();
-
-        if (includeAlpha && HasAlpha()) {
-            // Export as 32-bit BGRA BMP
-            size_t const rowStride = static_cast<size_t>(m_width) * 4;
-
-            // BMP file header
-            file.put('B');
-            file.put('M');
-
+    namespace {
+        // 'BM' followed by the rest of the headers, with the pixel data after dataOffset left for the caller
+        std::vector<uint8_t> StartBmp(uint16_t const width, uint16_t const height, int16_t const bitsPerPixel, size_t const rowStride,
+                                      int32_t const paletteSize) {
             BmpFileHeader header{};
             header.headerSize = 40;
-            header.size = static_cast<int32_t>(54 + rowStride * m_height);
-            header.dataOffset = 54;
-            header.width = m_width;
-            header.height = m_height;
+            header.dataOffset = static_cast<int32_t>(2 + sizeof(BmpFileHeader)) + paletteSize;
+            header.size = static_cast<int32_t>(header.dataOffset + rowStride * height);
+            header.width = width;
+            header.height = height;
             header.planes = 1;
-            header.bitsPerPixel = 32;
-            header.imageSize = static_cast<int32_t>(rowStride * m_height);
-
-            file.write(reinterpret_cast<char const *>(&header), sizeof(header));
-
-            // Write pixel data (bottom-to-top) as BGRA
-            std::vector<uint8_t> row(rowStride);
-            for (int y = m_height - 1; y >= 0; --y) {
-                for (int x = 0; x < m_width; ++x) {
-                    uint32_t const pixel = pixels[y * m_width + x];
-                    row[x * 4 + 0] = static_cast<uint8_t>(pixel & 0xFF);         // B
-                    row[x * 4 + 1] = static_cast<uint8_t>((pixel >> 8) & 0xFF);  // G
-                    row[x * 4 + 2] = static_cast<uint8_t>((pixel >> 16) & 0xFF); // R
-                    row[x * 4 + 3] = static_cast<uint8_t>((pixel >> 24) & 0xFF); // A
-                }
-                file.write(reinterpret_cast<char const *>(row.data()), static_cast<std::streamsize>(rowStride));
-            }
-        } else {
-            // Export as 24-bit RGB BMP (no alpha)
-            size_t const rowStride = ((m_width * 3 + 3) / 4) * 4;
-
-            // BMP file header
-            file.put('B');
-            file.put('M');
+            header.bitsPerPixel = bitsPerPixel;
+            header.colorsUsed = paletteSize / 4;
+            header.imageSize = static_cast<int32_t>(rowStride * height);
+
+            std::vector<uint8_t> bmp(static_cast<size_t>(header.size), 0);
+            bmp[0] = 'B';
+            bmp[1] = 'M';
+            std::memcpy(bmp.data() + 2, &header, sizeof(header));
+            return bmp;
+        }
 
-            BmpFileHeader header{};
-            header.headerSize = 40;
-            header.size = static_cast<int32_t>(54 + rowStride * m_height);
-            header.dataOffset = 54;
-            header.width = m_width;
-            header.height = m_height;
-            header.planes = 1;
-            header.bitsPerPixel = 24;
-            header.imageSize = static_cast<int32_t>(rowStride * m_height);
-
-            file.write(reinterpret_cast<char const *>(&header), sizeof(header));
-
-            // Write pixel data (bottom-to-top)
-            std::vector<uint8_t> row(rowStride, 0);
-            for (int y = m_height - 1; y >= 0; --y) {
-                for (int x = 0; x < m_width; ++x) {
-                    uint32_t const pixel = pixels[y * m_width + x];
-                    row[x * 3 + 0] = static_cast<uint8_t>(pixel & 0xFF);         // B
-                    row[x * 3 + 1] = static_cast<uint8_t>((pixel >> 8) & 0xFF);  // G
-                    row[x * 3 + 2] = static_cast<uint8_t>((pixel >> 16) & 0xFF); // R
-                }
-                file.write(reinterpret_cast<char const *>(row.data()), static_cast<std::streamsize>(rowStride));
-            }
+        bool WriteFile(std::string const &filepath, std::vector<uint8_t> const &data) {
+            std::ofstream file(filepath, std::ios::binary);
+            if (!file)
+                return false;
+            file.write(reinterpret_cast<char const *>(data.data()), static_cast<std::streamsize>(data.size()));
+            return file.good();
         }
+    } // namespace
 
-        return file.good();
+    bool FshTexture::ExportToBmp(std::string const &filepath, bool includeAlpha) const {
+        return WriteFile(filepath, BuildBmp(ToARGB32(), includeAlpha));
     }
 
     bool FshTexture::ExportAlphaToBmp(std::string const &filepath) const {
         if (!HasAlpha())
             return false;
+        return WriteFile(filepath, BuildAlphaBmp(ToARGB32()));
+    }
 
-        std::ofstream file(filepath, std::ios::binary);
-        if (!file)
-            return false;
+    std::vector<uint8_t> FshTexture::BuildBmp(std::vector<uint32_t> const &pixels, bool const includeAlpha) const {
+        // 32-bit BGRA with alpha, otherwise 24-bit BGR with rows padded to 4 bytes
+        bool const withAlpha = includeAlpha && HasAlpha();
+        size_t const bytesPerPixel = withAlpha ? 4 : 3;
+        size_t const rowStride = ((m_width * bytesPerPixel + 3) / 4) * 4;
+        std::vector<uint8_t> bmp = StartBmp(m_width, m_height, static_cast<int16_t>(bytesPerPixel * 8), rowStride, 0);
+        uint8_t *const pixelData = bmp.data() + bmp.size() - rowStride * m_height;
+
+        // Pixel data is bottom-to-top
+        for (size_t y = 0; y < m_height; ++y) {
+            uint32_t const *src = pixels.data() + y * m_width;
+            uint8_t *dst = pixelData + (m_height - 1 - y) * rowStride;
+            if (withAlpha) {
+                // ARGB32 words are BGRA bytes in little-endian memory
+                std::memcpy(dst, src, static_cast<size_t>(m_width) * 4);
+            } else {
+                for (size_t x = 0; x < m_width; ++x, dst += 3) {
+                    uint32_t const pixel = src[x];
+                    dst[0] = static_cast<uint8_t>(pixel & 0xFF);         // B
+                    dst[1] = static_cast<uint8_t>((pixel >> 8) & 0xFF);  // G
+                    dst[2] = static_cast<uint8_t>((pixel >> 16) & 0xFF); // R
+                }
+            }
+        }
 
-        // Get alpha channel from ARGB data
-        auto const pixels = ToARGB32();
+        return bmp;
+    }
 
-        // Calculate row stride (BMP rows must be 4-byte aligned)
+    std::vector<uint8_t> FshTexture::BuildAlphaBmp(std::vector<uint32_t> const &pixels) const {
+        // 8-bit with a grayscale palette, rows padded to 4 bytes
         size_t const rowStride = ((m_width + 3) / 4) * 4;
+        std::vector<uint8_t> bmp = StartBmp(m_width, m_height, 8, rowStride, 1024);
+        uint8_t *const paletteData = bmp.data() + 2 + sizeof(BmpFileHeader);
+        for (size_t i = 0; i < 256; ++i) {
+            paletteData[i * 4 + 0] = static_cast<uint8_t>(i); // B
+            paletteData[i * 4 + 1] = static_cast<uint8_t>(i); // G
+            paletteData[i * 4 + 2] = static_cast<uint8_t>(i); // R
+        }
 
-        // BMP file header
-        file.put('B');
-        file.put('M');
-
-        BmpFileHeader header{};
-        header.headerSize = 40;
-        header.size = static_cast<int32_t>(54 + 1024 + rowStride * m_height);
-        header.dataOffset = 54 + 1024;
-        header.width = m_width;
-        header.height = m_height;
-        header.planes = 1;
-        header.bitsPerPixel = 8;
-        header.colorsUsed = 256;
-        header.imageSize = static_cast<int32_t>(rowStride * m_height);
-
-        file.write(reinterpret_cast<char const *>(&header), sizeof(header));
-
-        // Write grayscale palette
-        for (int i = 0; i < 256; ++i) {
-            uint8_t const gray = static_cast<uint8_t>(i);
-            file.put(static_cast<char>(gray)); // B
-            file.put(static_cast<char>(gray)); // G
-            file.put(static_cast<char>(gray)); // R
-            file.put(0);                       // Reserved
-        }
-
-        // Write alpha data (bottom-to-top)
-        std::vector<uint8_t> row(rowStride, 0);
-        for (int y = m_height - 1; y >= 0; --y) {
-            for (int x = 0; x < m_width; ++x) {
-                row[x] = static_cast<uint8_t>((pixels[y * m_width + x] >> 24) & 0xFF);
+        // Alpha data is bottom-to-top
+        uint8_t *const pixelData = paletteData + 1024;
+        for (size_t y = 0; y < m_height; ++y) {
+            uint32_t const *src = pixels.data() + y * m_width;
+            uint8_t *dst = pixelData + (m_height - 1 - y) * rowStride;
+            for (size_t x = 0; x < m_width; ++x) {
+                dst[x] = static_cast<uint8_t>((src[x] >> 24) & 0xFF);
             }
-            file.write(reinterpret_cast<char const *>(row.data()), static_cast<std::streamsize>(rowStride));
         }
 
-        return file.good();
+        return bmp;
     }
 
-    void FshTexture::ConvertIndexed4ToARGB32(std::vector<uint32_t> &output) const {
-        // For PSH 4-bit indexed, raw data is already unpacked to 1 byte per pixel
-        for (size_t i = 0; i < m_rawData.size() && i < output.size(); ++i) {
-            uint8_t const index = m_rawData[i] & 0x0F; // Ensure index is in valid range
-            output[i] = m_palette[index].ToARGB32();
+    void FshTexture::DecodeIndexed(uint8_t *const output, bool const rgbaOrder) const {
+        // Pack the palette once, so that every pixel is a single table lookup. Indices past the end of the palette read transparent
+        // black. Palettes can be modified through GetPalette and textures are decoded from several threads, so the table is built
+        // per decode rather than cached on the palette (256 packs, against one per texel before).
+        alignas(32) uint32_t lut[Palette::MAX_COLORS]{};
+        for (size_t colourIdx = 0; colourIdx < std::min(m_palette.Size(), Palette::MAX_COLORS); ++colourIdx) {
+            Colour const &colour = m_palette[colourIdx];
+            lut[colourIdx] = rgbaOrder ? static_cast<uint32_t>(colour.r) | (static_cast<uint32_t>(colour.g) << 8) |
+                                             (static_cast<uint32_t>(colour.b) << 16) | (static_cast<uint32_t>(colour.a) << 24)
+                                       : colour.ToARGB32();
+        }
+
+        size_t const nPixels = static_cast<size_t>(m_width) * m_height;
+        if (m_format != PixelFormat::Indexed4Bit) {
+            LookupIndices(m_rawData.data(), std::min(m_rawData.size(), nPixels), lut, output);
+            return;
+        }
+
+        // 4-bit indices are nibble packed, low nibble first, each row starting on a byte boundary
+        size_t const rowStride = (m_width + 1) / 2;
+        size_t const nRows = std::min<size_t>(m_height, rowStride == 0 ? 0 : m_rawData.size() / rowStride);
+        std::vector<uint8_t> rowIndices(m_width);
+        for (size_t row = 0; row < nRows; ++row) {
+            UnpackNibbles(m_rawData.data() + row * rowStride, m_width, rowIndices.data());
+            LookupIndices(rowIndices.data(), m_width, lut, output + row * m_width * 4);
         }
     }
 
-    void FshTexture::ConvertIndexed8ToARGB32(std::vector<uint32_t> &output) const {
-        for (size_t i = 0; i < m_rawData.size(); ++i) {
-            output[i] = m_palette[m_rawData[i]].ToARGB32();
+    void FshTexture::LookupIndices(uint8_t const *indices, size_t const count, uint32_t const (&lut)[Palette::MAX_COLORS],
+                                   uint8_t *output) {
+        size_t i = 0;
+#ifdef __AVX2__
+        for (; i + 8 <= count; i += 8) {
+            __m256i const lutIndices = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(indices + i)));
+            __m256i const pixels = _mm256_i32gather_epi32(reinterpret_cast<int const *>(lut), lutIndices, 4);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i * 4), pixels);
+        }
+#endif
+        for (; i < count; ++i) {
+            std::memcpy(output + i * 4, &lut[indices[i]], 4);
+        }
+    }
+
+    void FshTexture::UnpackNibbles(uint8_t const *packed, size_t const count, uint8_t *indices) {
+        size_t i = 0;
+#ifdef ONFS_FSH_SSE2
+        __m128i const lowMask = _mm_set1_epi8(0x0F);
+        for (; i + 32 <= count; i += 32) {
+            __m128i const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(packed + i / 2));
+            __m128i const low = _mm_and_si128(bytes, lowMask);
+            __m128i const high = _mm_and_si128(_mm_srli_epi16(bytes, 4), lowMask);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(indices + i), _mm_unpacklo_epi8(low, high));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(indices + i + 16), _mm_unpackhi_epi8(low, high));
+        }
+#endif
+        for (; i < count; ++i) {
+            indices[i] = (i & 1) ? (packed[i / 2] >> 4) : (packed[i / 2] & 0x0F);
         }
     }
 
@@ -257,82 +318,151 @@ namespace LibOpenNFS::Shared {
         }
     }
 
-    void FshTexture::DecompressDXT1ToARGB32(std::vector<uint32_t> &output) const {
-        DecompressDXTBlock(output, false);
+    size_t FshTexture::DXTBlockSize() const {
+        switch (m_format) {
+        case PixelFormat::DXT1:
+            return 8;
+        case PixelFormat::DXT3:
+            return 16;
+        default:
+            return 0;
+        }
     }
 
-    void FshTexture::DecompressDXT3ToARGB32(std::vector<uint32_t> &output) const {
-        DecompressDXTBlock(output, true);
+    std::span<uint8_t const> FshTexture::DXTBlocks() const {
+        size_t const size = static_cast<size_t>((m_width + 3) / 4) * ((m_height + 3) / 4) * DXTBlockSize();
+        if (size == 0 || m_rawData.size() < size) {
+            return {};
+        }
+        return {m_rawData.data(), size};
     }
 
-    void FshTexture::DecompressDXTBlock(std::vector<uint32_t> &output, bool const hasDXT3Alpha) const {
-        size_t const blockWidth = (m_width + 3) / 4;
-        size_t const blockHeight = (m_height + 3) / 4;
-        size_t const blockSize = hasDXT3Alpha ? 16 : 8;
+    bool FshTexture::DecodeDXTToRGBA(std::vector<uint8_t> &rgba, size_t const maxThreads) const {
+        if (!IsCompressed()) {
+            return false;
+        }
+        rgba.assign(static_cast<size_t>(m_width) * m_height * 4, 0);
+        // Only decode the block rows that are actually present in truncated data, leaving the rest transparent black
+        size_t const blockRowSize = static_cast<size_t>((m_width + 3) / 4) * DXTBlockSize();
+        if (blockRowSize == 0) {
+            // Zero width, nothing to decode
+            return true;
+        }
+        size_t const nBlockRows = std::min<size_t>((m_height + 3) / 4, m_rawData.size() / blockRowSize);
+        Utils::ParallelFor(nBlockRows, [&](size_t const blockRow) { DecompressDXTBlockRow(blockRow, rgba.data()); }, maxThreads);
+        return true;
+    }
 
-        for (size_t by = 0; by < blockHeight; ++by) {
-            for (size_t bx = 0; bx < blockWidth; ++bx) {
-                uint8_t const *blockData = m_rawData.data() + (by * blockWidth + bx) * blockSize;
+    void FshTexture::DecompressDXTBlockRow(size_t const blockRow, uint8_t *const rgba) const {
+        bool const hasDXT3Alpha = m_format == PixelFormat::DXT3;
+        size_t const blockSize = DXTBlockSize();
+        size_t const blockWidth = (m_width + 3) / 4;
+        uint8_t const *const rowData = m_rawData.data() + blockRow * blockWidth * blockSize;
 
-                // DXT3: First 8 bytes are alpha, then colour
-                uint8_t const *alphaData = hasDXT3Alpha ? blockData : nullptr;
-                uint8_t const *colorData = hasDXT3Alpha ? blockData + 8 : blockData;
+        for (size_t firstBlock = 0; firstBlock < blockWidth; firstBlock += 8) {
+            size_t const nBlocks = std::min<size_t>(8, blockWidth - firstBlock);
 
-                // Decode 2 16-bit colors
-                uint16_t const c0 = static_cast<uint16_t>(colorData[0]) | (static_cast<uint16_t>(colorData[1]) << 8);
-                uint16_t const c1 = static_cast<uint16_t>(colorData[2]) | (static_cast<uint16_t>(colorData[3]) << 8);
-
-                Colour colors[4];
-                colors[0] = Colour::FromRGB16_565(c0);
-                colors[1] = Colour::FromRGB16_565(c1);
-
-                if (c0 > c1) {
-                    // 4-color mode
-                    colors[2].r = static_cast<uint8_t>((2 * colors[0].r + colors[1].r) / 3);
-                    colors[2].g = static_cast<uint8_t>((2 * colors[0].g + colors[1].g) / 3);
-                    colors[2].b = static_cast<uint8_t>((2 * colors[0].b + colors[1].b) / 3);
-                    colors[2].a = 255;
-                    colors[3].r = static_cast<uint8_t>((colors[0].r + 2 * colors[1].r) / 3);
-                    colors[3].g = static_cast<uint8_t>((colors[0].g + 2 * colors[1].g) / 3);
-                    colors[3].b = static_cast<uint8_t>((colors[0].b + 2 * colors[1].b) / 3);
-                    colors[3].a = 255;
-                } else {
-                    // 3-color + transparent mode
-                    colors[2].r = static_cast<uint8_t>((colors[0].r + colors[1].r) / 2);
-                    colors[2].g = static_cast<uint8_t>((colors[0].g + colors[1].g) / 2);
-                    colors[2].b = static_cast<uint8_t>((colors[0].b + colors[1].b) / 2);
-                    colors[2].a = 255;
-                    colors[3] = Colour(0, 0, 0, 0); // Transparent
-                }
+            // Four colour palettes of up to eight blocks at once. DXT3 stores its 8 bytes of alpha ahead of the colour block.
+            uint16_t c0s[8]{}, c1s[8]{};
+            for (size_t blockIdx = 0; blockIdx < nBlocks; ++blockIdx) {
+                uint8_t const *colorData = rowData + (firstBlock + blockIdx) * blockSize + (hasDXT3Alpha ? 8 : 0);
+                c0s[blockIdx] = static_cast<uint16_t>(colorData[0] | (colorData[1] << 8));
+                c1s[blockIdx] = static_cast<uint16_t>(colorData[2] | (colorData[3] << 8));
+            }
+            uint32_t palettes[8][4];
+            DecodeDXTPalettes(c0s, c1s, palettes);
 
-                // Decode 4x4 pixel block
+            for (size_t blockIdx = 0; blockIdx < nBlocks; ++blockIdx) {
+                uint8_t const *blockData = rowData + (firstBlock + blockIdx) * blockSize;
+                uint8_t const *colorData = hasDXT3Alpha ? blockData + 8 : blockData;
                 uint32_t const colorIndices = static_cast<uint32_t>(colorData[4]) | (static_cast<uint32_t>(colorData[5]) << 8) |
                                               (static_cast<uint32_t>(colorData[6]) << 16) | (static_cast<uint32_t>(colorData[7]) << 24);
-
-                for (size_t py = 0; py < 4; ++py) {
-                    for (size_t px = 0; px < 4; ++px) {
-                        size_t const x = bx * 4 + px;
-                        size_t const y = by * 4 + py;
-
-                        if (x < m_width && y < m_height) {
-                            size_t const bitOffset = (py * 4 + px) * 2;
-                            uint8_t const colorIndex = (colorIndices >> bitOffset) & 0x03;
-
-                            Colour pixel = colors[colorIndex];
-
-                            // Apply DXT3 alpha if present
-                            if (hasDXT3Alpha) {
-                                size_t const alphaByteIdx = py * 2 + (px / 2);
-                                uint8_t const alphaNibble = (px & 1) ? (alphaData[alphaByteIdx] >> 4) : (alphaData[alphaByteIdx] & 0x0F);
-                                pixel.a = static_cast<uint8_t>(alphaNibble * 17);
-                            }
-
-                            output[y * m_width + x] = pixel.ToARGB32();
+                size_t const x0 = (firstBlock + blockIdx) * 4;
+                size_t const y0 = blockRow * 4;
+                size_t const nX = std::min<size_t>(4, m_width - x0);
+                size_t const nY = std::min<size_t>(4, m_height - y0);
+
+                for (size_t py = 0; py < nY; ++py) {
+                    uint8_t *out = rgba + ((y0 + py) * m_width + x0) * 4;
+                    for (size_t px = 0; px < nX; ++px, out += 4) {
+                        uint32_t pixel = palettes[blockIdx][(colorIndices >> ((py * 4 + px) * 2)) & 0x03];
+                        if (hasDXT3Alpha) {
+                            uint8_t const alphaByte = blockData[py * 2 + (px / 2)];
+                            uint32_t const alphaNibble = (px & 1) ? (alphaByte >> 4) : (alphaByte & 0x0F);
+                            pixel = (pixel & 0x00FFFFFFu) | ((alphaNibble * 17) << 24);
                         }
+                        std::memcpy(out, &pixel, 4);
                     }
                 }
             }
         }
     }
 
+    void FshTexture::DecodeDXTPalettes(uint16_t const (&c0s)[8], uint16_t const (&c1s)[8], uint32_t (&palettes)[8][4]) {
+        // Channels of colour 2 and 3, per block. c0 > c1 selects 4-colour mode, otherwise 3-colour + transparent.
+        uint16_t r[4][8], g[4][8], b[4][8];
+        bool fourColour[8];
+#ifdef ONFS_FSH_SSE2
+        __m128i const c0 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(c0s));
+        __m128i const c1 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(c1s));
+        // Same expansion as Colour::FromRGB16_565
+        auto expand5 = [](__m128i const colour, int const shift) {
+            return _mm_slli_epi16(_mm_and_si128(_mm_srl_epi16(colour, _mm_cvtsi32_si128(shift)), _mm_set1_epi16(0x1F)), 3);
+        };
+        auto expand6 = [](__m128i const colour) { return _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(colour, 5), _mm_set1_epi16(0x3F)), 2); };
+        // x / 3 for x <= 765, as (x * 0xAAAB) >> 17
+        auto divide3 = [](__m128i const x) { return _mm_srli_epi16(_mm_mulhi_epu16(x, _mm_set1_epi16(static_cast<short>(0xAAAB))), 1); };
+        // Unsigned c0 > c1, by flipping the sign bits for the signed compare
+        __m128i const signBit = _mm_set1_epi16(static_cast<short>(0x8000));
+        __m128i const fourColourMask = _mm_cmpgt_epi16(_mm_xor_si128(c0, signBit), _mm_xor_si128(c1, signBit));
+
+        __m128i const channels0[3]{expand5(c0, 11), expand6(c0), expand5(c0, 0)};
+        __m128i const channels1[3]{expand5(c1, 11), expand6(c1), expand5(c1, 0)};
+        uint16_t(*const outputs[3])[8]{r, g, b};
+        for (size_t channel = 0; channel < 3; ++channel) {
+            __m128i const a = channels0[channel];
+            __m128i const b1 = channels1[channel];
+            __m128i const colour2 = divide3(_mm_add_epi16(_mm_add_epi16(a, a), b1));
+            __m128i const colour3 = divide3(_mm_add_epi16(_mm_add_epi16(b1, b1), a));
+            __m128i const halfway = _mm_srli_epi16(_mm_add_epi16(a, b1), 1);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(outputs[channel][0]), a);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(outputs[channel][1]), b1);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(outputs[channel][2]),
+                             _mm_or_si128(_mm_and_si128(fourColourMask, colour2), _mm_andnot_si128(fourColourMask, halfway)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(outputs[channel][3]), _mm_and_si128(fourColourMask, colour3));
+        }
+        uint16_t masks[8];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(masks), fourColourMask);
+        for (size_t blockIdx = 0; blockIdx < 8; ++blockIdx) {
+            fourColour[blockIdx] = masks[blockIdx] != 0;
+        }
+#else
+        for (size_t blockIdx = 0; blockIdx < 8; ++blockIdx) {
+            Colour const colour0 = Colour::FromRGB16_565(c0s[blockIdx]);
+            Colour const colour1 = Colour::FromRGB16_565(c1s[blockIdx]);
+            fourColour[blockIdx] = c0s[blockIdx] > c1s[blockIdx];
+            uint16_t const channels0[3]{colour0.r, colour0.g, colour0.b};
+            uint16_t const channels1[3]{colour1.r, colour1.g, colour1.b};
+            uint16_t(*const outputs[3])[8]{r, g, b};
+            for (size_t channel = 0; channel < 3; ++channel) {
+                uint16_t const a = channels0[channel];
+                uint16_t const b1 = channels1[channel];
+                outputs[channel][0][blockIdx] = a;
+                outputs[channel][1][blockIdx] = b1;
+                outputs[channel][2][blockIdx] =
+                    fourColour[blockIdx] ? static_cast<uint16_t>((2 * a + b1) / 3) : static_cast<uint16_t>((a + b1) / 2);
+                outputs[channel][3][blockIdx] = fourColour[blockIdx] ? static_cast<uint16_t>((a + 2 * b1) / 3) : 0;
+            }
+        }
+#endif
+        // Pack as RGBA bytes, the 3-colour mode's fourth entry is transparent black
+        for (size_t blockIdx = 0; blockIdx < 8; ++blockIdx) {
+            for (size_t entry = 0; entry < 4; ++entry) {
+                uint32_t const alpha = (entry == 3 && !fourColour[blockIdx]) ? 0u : 0xFF000000u;
+                palettes[blockIdx][entry] = static_cast<uint32_t>(r[entry][blockIdx]) | (static_cast<uint32_t>(g[entry][blockIdx]) << 8) |
+                                            (static_cast<uint32_t>(b[entry][blockIdx]) << 16) | alpha;
+            }
+        }
+    }
+
 } // namespace LibOpenNFS::Shared
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <fstream>
 #include <memory>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -51,6 +52,7 @@ namespace LibOpenNFS::Shared {
             return m_rawData;
         }
         std::vector<uint8_t> &RawData() {
+            m_hasContentHash = false;
             return m_rawData;
         }
 
@@ -58,6 +60,7 @@ namespace LibOpenNFS::Shared {
             return m_palette;
         }
         Palette &GetPalette() {
+            m_hasContentHash = false;
             return m_palette;
         }
 
@@ -65,13 +68,53 @@ namespace LibOpenNFS::Shared {
             return m_alphaData;
         }
         std::vector<uint8_t> &AlphaData() {
+            m_hasContentHash = false;
             return m_alphaData;
         }
 
         void SetHasAlphaAttachment(bool const value) {
+            m_hasContentHash = false;
             m_hasAlphaAttachment = value;
         }
 
+        /**
+         * Hash of everything the decoded pixels depend on (format, size, pixel, palette and alpha data), so that textures with
+         * identical content hash the same whichever archive they come from
+         * @return 64-bit FNV-1a hash, the stored one if CacheContentHash was called since the texture last changed
+         */
+        uint64_t ContentHash() const {
+            return m_hasContentHash ? m_contentHash : ComputeContentHash();
+        }
+
+        /**
+         * Store ContentHash, so that later calls don't hash the texture again. Any non-const access to the texture data drops it.
+         */
+        void CacheContentHash() {
+            m_contentHash = ComputeContentHash();
+            m_hasContentHash = true;
+        }
+
+        /**
+         * Bytes per 4x4 block of compressed formats
+         * @return 8 for DXT1, 16 for DXT3, 0 for uncompressed formats
+         */
+        size_t DXTBlockSize() const;
+
+        /**
+         * The DXT blocks as stored, row by row of blocks, for renderers that upload BC1 (DXT1) or BC2 (DXT3) data directly
+         * @return View into the raw data, empty for uncompressed formats or truncated data
+         */
+        std::span<uint8_t const> DXTBlocks() const;
+
+        /**
+         * Decode a DXT1/DXT3 texture straight to RGBA bytes. Palettes are decoded eight blocks at a time (SSE2 where available),
+         * and rows of blocks can be split across threads.
+         * @param rgba Output RGBA bytes (row-major, top-to-bottom)
+         * @param maxThreads Threads to split block rows across (0 = hardware concurrency, 1 = calling thread only)
+         * @return false if the texture isn't DXT compressed
+         */
+        bool DecodeDXTToRGBA(std::vector<uint8_t> &rgba, size_t maxThreads = 1) const;
+
         /**
          * Convert texture to 32-bit ARGB pixel data
          * @return Vector of ARGB pixels (row-major, bottom-to-top for BMP compatibility)
@@ -99,6 +142,21 @@ namespace LibOpenNFS::Shared {
          */
         bool ExportAlphaToBmp(std::string const &filepath) const;
 
+        /**
+         * Build a BMP file in memory, to be written in one go
+         * @param pixels ARGB32 pixels of this texture, from ToARGB32
+         * @param includeAlpha If true, build a 32-bit BGRA BMP with alpha channel embedded
+         * @return The complete file
+         */
+        std::vector<uint8_t> BuildBmp(std::vector<uint32_t> const &pixels, bool includeAlpha = false) const;
+
+        /**
+         * Build an 8-bit grayscale BMP of the alpha channel in memory, to be written in one go
+         * @param pixels ARGB32 pixels of this texture, from ToARGB32
+         * @return The complete file
+         */
+        std::vector<uint8_t> BuildAlphaBmp(std::vector<uint32_t> const &pixels) const;
+
       private:
         std::string m_name;
         uint16_t m_width = 0;
@@ -108,19 +166,25 @@ namespace LibOpenNFS::Shared {
         Palette m_palette;
         std::vector<uint8_t> m_alphaData;
         bool m_hasAlphaAttachment = false;
+        uint64_t m_contentHash = 0;
+        bool m_hasContentHash = false;
+
+        uint64_t ComputeContentHash() const;
 
         // Conversion methods
-        void ConvertIndexed4ToARGB32(std::vector<uint32_t> &output) const;
-        void ConvertIndexed8ToARGB32(std::vector<uint32_t> &output) const;
+        // Palette lookup into 4 bytes per pixel, RGBA byte order or ARGB32 words. Table lookups use AVX2 gathers where enabled,
+        // 4-bit unpacking SSE2.
+        void DecodeIndexed(uint8_t *output, bool rgbaOrder) const;
+        static void LookupIndices(uint8_t const *indices, size_t count, uint32_t const (&lut)[Palette::MAX_COLORS], uint8_t *output);
+        static void UnpackNibbles(uint8_t const *packed, size_t count, uint8_t *indices);
         void ConvertARGB32(std::vector<uint32_t> &output) const;
         void ConvertRGB24ToARGB32(std::vector<uint32_t> &output) const;
         void ConvertARGB16_1555ToARGB32(std::vector<uint32_t> &output) const;
         void ConvertABGR16_1555ToARGB32(std::vector<uint32_t> &output) const;
         void ConvertRGB16_565ToARGB32(std::vector<uint32_t> &output) const;
         void ConvertARGB16_4444ToARGB32(std::vector<uint32_t> &output) const;
-        void DecompressDXT1ToARGB32(std::vector<uint32_t> &output) const;
-        void DecompressDXT3ToARGB32(std::vector<uint32_t> &output) const;
-        void DecompressDXTBlock(std::vector<uint32_t> &output, bool hasDXT3Alpha) const;
+        void DecompressDXTBlockRow(size_t blockRow, uint8_t *rgba) const;
+        static void DecodeDXTPalettes(uint16_t const (&c0s)[8], uint16_t const (&c1s)[8], uint32_t (&palettes)[8][4]);
     };
 
 } // namespace LibOpenNFS::Shared
\ No newline at end of file
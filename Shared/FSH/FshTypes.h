@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -73,6 +74,20 @@ namespace LibOpenNFS::Shared {
         }
     }
 
+    // Bytes of pixel data stored for an image, 0 for unknown formats. 4-bit rows start on a byte boundary.
+    inline size_t GetPixelDataSize(PixelFormat const format, size_t const width, size_t const height) {
+        switch (format) {
+        case PixelFormat::Indexed4Bit:
+            return (width + 1) / 2 * height;
+        case PixelFormat::DXT1:
+            return (width + 3) / 4 * ((height + 3) / 4) * 8;
+        case PixelFormat::DXT3:
+            return (width + 3) / 4 * ((height + 3) / 4) * 16;
+        default:
+            return width * height * (GetBitsPerPixel(format) / 8);
+        }
+    }
+
     inline bool HasAlphaChannel(PixelFormat const format) {
         switch (format) {
         case PixelFormat::ARGB32:
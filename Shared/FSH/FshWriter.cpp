@@ -0,0 +1,323 @@
+#include "FshWriter.h"
+#include "FshArchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace LibOpenNFS::Shared {
+    namespace {
+        constexpr size_t ENTRY_ALIGNMENT = 16;
+        // The next offset of an entry header is a signed 24-bit value
+        constexpr size_t MAX_NEXT_OFFSET = (1u << 23) - 1;
+        // QFS headers store the uncompressed size in 24 bits
+        constexpr size_t MAX_QFS_INPUT_SIZE = (1u << 24) - 1;
+
+        size_t Align(size_t const size) {
+            return (size + ENTRY_ALIGNMENT - 1) / ENTRY_ALIGNMENT * ENTRY_ALIGNMENT;
+        }
+
+        void WriteEntryHeader(uint8_t *output, uint8_t const code, size_t const nextOffset, int16_t const width, int16_t const height) {
+            FshEntryHeader header{};
+            header.code = static_cast<int32_t>(code | (nextOffset << 8));
+            header.width = width;
+            header.height = height;
+            std::memcpy(output, &header, sizeof(header));
+        }
+
+        uint16_t ToARGB16_1555(Colour const &colour) {
+            return static_cast<uint16_t>((colour.a >= 128 ? 0x8000 : 0) | (colour.r >> 3) << 10 | (colour.g >> 3) << 5 | colour.b >> 3);
+        }
+
+        bool IsWritablePaletteFormat(PaletteFormat const format) {
+            return format == PaletteFormat::RGB24 || format == PaletteFormat::RGB24_DOS || format == PaletteFormat::ARGB16_1555 ||
+                   format == PaletteFormat::RGB16_565 || format == PaletteFormat::ARGB32;
+        }
+
+        uint16_t ToRGB16_565(Colour const &colour) {
+            return static_cast<uint16_t>((colour.r >> 3) << 11 | (colour.g >> 2) << 5 | colour.b >> 3);
+        }
+    } // namespace
+
+    FshWriter::FshWriter(std::string directoryId) : m_directoryId(std::move(directoryId)) {
+    }
+
+    FshWriter FshWriter::FromArchive(FshArchive const &archive) {
+        FshWriter writer(archive.DirectoryId());
+        for (auto const &texture : archive.Textures()) {
+            writer.AddTexture(texture);
+        }
+        if (Palette const *globalPalette = archive.GlobalPalette()) {
+            writer.SetGlobalPalette(*globalPalette);
+        }
+        return writer;
+    }
+
+    void FshWriter::AddTexture(FshTexture texture, std::vector<Attachment> attachments) {
+        m_entries.push_back({std::move(texture), std::move(attachments)});
+    }
+
+    void FshWriter::SetGlobalPalette(Palette const &palette) {
+        m_globalPalette = palette;
+        m_hasGlobalPalette = true;
+    }
+
+    void FshWriter::SetPaletteFormat(PaletteFormat const format) {
+        m_paletteFormat = format;
+    }
+
+    void FshWriter::SetShareIdenticalTextures(bool const share) {
+        m_shareIdenticalTextures = share;
+    }
+
+    bool FshWriter::NeedsLocalPalette(FshTexture const &texture) const {
+        if (!texture.HasPalette()) {
+            return false;
+        }
+        if (!m_hasGlobalPalette || texture.GetPalette().Size() != m_globalPalette.Size()) {
+            return true;
+        }
+        for (size_t i = 0; i < m_globalPalette.Size(); ++i) {
+            if (texture.GetPalette()[i].ToARGB32() != m_globalPalette[i].ToARGB32()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t FshWriter::PaletteSize(Palette const &palette) const {
+        switch (m_paletteFormat) {
+        case PaletteFormat::RGB24:
+        case PaletteFormat::RGB24_DOS:
+            return palette.Size() * 3;
+        case PaletteFormat::ARGB16_1555:
+        case PaletteFormat::RGB16_565:
+            return palette.Size() * 2;
+        case PaletteFormat::ARGB32:
+            return palette.Size() * 4;
+        default:
+            return 0;
+        }
+    }
+
+    void FshWriter::WritePalette(Palette const &palette, uint8_t *output) const {
+        WriteEntryHeader(output, static_cast<uint8_t>(m_paletteFormat), 0, static_cast<int16_t>(palette.Size()), 1);
+        uint8_t *data = output + sizeof(FshEntryHeader);
+
+        for (size_t i = 0; i < palette.Size(); ++i) {
+            Colour const &colour = palette[i];
+            switch (m_paletteFormat) {
+            case PaletteFormat::RGB24:
+                data[i * 3] = colour.r;
+                data[i * 3 + 1] = colour.g;
+                data[i * 3 + 2] = colour.b;
+                break;
+            case PaletteFormat::RGB24_DOS:
+                data[i * 3] = static_cast<uint8_t>(colour.r >> 2);
+                data[i * 3 + 1] = static_cast<uint8_t>(colour.g >> 2);
+                data[i * 3 + 2] = static_cast<uint8_t>(colour.b >> 2);
+                break;
+            case PaletteFormat::ARGB16_1555: {
+                uint16_t const value = ToARGB16_1555(colour);
+                std::memcpy(data + i * 2, &value, 2);
+                break;
+            }
+            case PaletteFormat::RGB16_565: {
+                uint16_t const value = ToRGB16_565(colour);
+                std::memcpy(data + i * 2, &value, 2);
+                break;
+            }
+            case PaletteFormat::ARGB32: {
+                uint32_t const value = colour.ToARGB32();
+                std::memcpy(data + i * 4, &value, 4);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+
+    bool FshWriter::IsSameEntry(Entry const &a, Entry const &b) {
+        FshTexture const &textureA = a.texture;
+        FshTexture const &textureB = b.texture;
+        if (textureA.Format() != textureB.Format() || textureA.Width() != textureB.Width() || textureA.Height() != textureB.Height()) {
+            return false;
+        }
+        size_t const dataSize = GetPixelDataSize(textureA.Format(), textureA.Width(), textureA.Height());
+        if (std::memcmp(textureA.RawData().data(), textureB.RawData().data(), dataSize) != 0) {
+            return false;
+        }
+        if (textureA.HasPalette()) {
+            Palette const &paletteA = textureA.GetPalette();
+            Palette const &paletteB = textureB.GetPalette();
+            if (paletteA.Size() != paletteB.Size()) {
+                return false;
+            }
+            for (size_t i = 0; i < paletteA.Size(); ++i) {
+                if (paletteA[i].ToARGB32() != paletteB[i].ToARGB32()) {
+                    return false;
+                }
+            }
+        }
+        if (a.attachments.size() != b.attachments.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.attachments.size(); ++i) {
+            if (a.attachments[i].code != b.attachments[i].code || a.attachments[i].data != b.attachments[i].data) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool FshWriter::Serialize(std::vector<uint8_t> &output, bool const compress, int const maxIterations) const {
+        if (!IsWritablePaletteFormat(m_paletteFormat)) {
+            m_lastError = "Unsupported palette format";
+            return false;
+        }
+
+        // Lay out the directory, global palette and every entry to size the archive before writing anything
+        size_t const numDirectoryEntries = m_entries.size() + (m_hasGlobalPalette ? 1 : 0);
+        size_t offset = Align(sizeof(FshHeader) + numDirectoryEntries * sizeof(FshDirectoryEntry));
+        size_t const globalPaletteOffset = offset;
+        if (m_hasGlobalPalette) {
+            offset += Align(sizeof(FshEntryHeader) + PaletteSize(m_globalPalette));
+        }
+
+        std::vector<size_t> entryOffsets(m_entries.size());
+        std::vector<bool> isShared(m_entries.size(), false);
+        std::unordered_map<uint64_t, std::vector<size_t>> entriesByHash;
+        for (size_t i = 0; i < m_entries.size(); ++i) {
+            FshTexture const &texture = m_entries[i].texture;
+            size_t const dataSize = GetPixelDataSize(texture.Format(), texture.Width(), texture.Height());
+            if (dataSize == 0 || texture.Width() > 0x7FFF || texture.Height() > 0x7FFF) {
+                m_lastError = "Texture " + texture.Name() + " has an unsupported format or size";
+                return false;
+            }
+            if (texture.RawData().size() < dataSize) {
+                m_lastError = "Texture " + texture.Name() + " has too little pixel data";
+                return false;
+            }
+            if (texture.HasPalette() && texture.GetPalette().Size() > Palette::MAX_COLORS) {
+                m_lastError = "Texture " + texture.Name() + " has too many palette colours";
+                return false;
+            }
+
+            if (m_shareIdenticalTextures) {
+                auto &sameHashEntries = entriesByHash[texture.ContentHash()];
+                auto const sameEntry = std::find_if(sameHashEntries.begin(), sameHashEntries.end(),
+                                                    [&](size_t const j) { return IsSameEntry(m_entries[i], m_entries[j]); });
+                if (sameEntry != sameHashEntries.end()) {
+                    entryOffsets[i] = entryOffsets[*sameEntry];
+                    isShared[i] = true;
+                    continue;
+                }
+                sameHashEntries.push_back(i);
+            }
+
+            // Pixel data, then the local palette and attachments, each block giving the offset to the next
+            std::vector<size_t> blockSizes{Align(sizeof(FshEntryHeader) + dataSize)};
+            if (NeedsLocalPalette(texture)) {
+                blockSizes.push_back(Align(sizeof(FshEntryHeader) + PaletteSize(texture.GetPalette())));
+            }
+            for (auto const &attachment : m_entries[i].attachments) {
+                blockSizes.push_back(Align(4 + attachment.data.size()));
+            }
+            entryOffsets[i] = offset;
+            for (size_t const blockSize : blockSizes) {
+                if (blockSize > MAX_NEXT_OFFSET) {
+                    m_lastError = "Texture " + texture.Name() + " is too large for an FSH entry";
+                    return false;
+                }
+                offset += blockSize;
+            }
+        }
+        size_t const fshSize = offset;
+        if (fshSize > static_cast<size_t>(INT32_MAX)) {
+            m_lastError = "Archive is too large for FSH";
+            return false;
+        }
+        if (compress && fshSize > MAX_QFS_INPUT_SIZE) {
+            m_lastError = "Archive is too large for QFS compression";
+            return false;
+        }
+
+        std::vector<uint8_t> fsh(fshSize, 0);
+
+        FshHeader header{};
+        std::memcpy(header.magic, FSH_MAGIC, 4);
+        header.fileSize = static_cast<int32_t>(fshSize);
+        header.numEntries = static_cast<int32_t>(numDirectoryEntries);
+        std::memcpy(header.directoryId, m_directoryId.data(), std::min<size_t>(m_directoryId.size(), 4));
+        std::memcpy(fsh.data(), &header, sizeof(header));
+
+        auto *directory = reinterpret_cast<FshDirectoryEntry *>(fsh.data() + sizeof(FshHeader));
+        if (m_hasGlobalPalette) {
+            std::memcpy(directory->name, "!pal", 4);
+            directory->offset = static_cast<int32_t>(globalPaletteOffset);
+            ++directory;
+            WritePalette(m_globalPalette, fsh.data() + globalPaletteOffset);
+        }
+
+        for (size_t i = 0; i < m_entries.size(); ++i) {
+            Entry const &entry = m_entries[i];
+            FshTexture const &texture = entry.texture;
+            std::memcpy(directory[i].name, texture.Name().data(), std::min<size_t>(texture.Name().size(), 4));
+            directory[i].offset = static_cast<int32_t>(entryOffsets[i]);
+            if (isShared[i]) {
+                continue;
+            }
+
+            bool const hasLocalPalette = NeedsLocalPalette(texture);
+            bool const hasAttachments = hasLocalPalette || !entry.attachments.empty();
+            size_t const dataSize = GetPixelDataSize(texture.Format(), texture.Width(), texture.Height());
+            uint8_t *block = fsh.data() + entryOffsets[i];
+            size_t blockSize = Align(sizeof(FshEntryHeader) + dataSize);
+            WriteEntryHeader(block, static_cast<uint8_t>(texture.Format()), hasAttachments ? blockSize : 0,
+                             static_cast<int16_t>(texture.Width()), static_cast<int16_t>(texture.Height()));
+            std::memcpy(block + sizeof(FshEntryHeader), texture.RawData().data(), dataSize);
+
+            if (hasLocalPalette) {
+                block += blockSize;
+                blockSize = Align(sizeof(FshEntryHeader) + PaletteSize(texture.GetPalette()));
+                WritePalette(texture.GetPalette(), block);
+                if (!entry.attachments.empty()) {
+                    auto *paletteHeader = reinterpret_cast<FshEntryHeader *>(block);
+                    paletteHeader->code |= static_cast<int32_t>(blockSize << 8);
+                }
+            }
+            for (size_t attachmentIdx = 0; attachmentIdx < entry.attachments.size(); ++attachmentIdx) {
+                Attachment const &attachment = entry.attachments[attachmentIdx];
+                block += blockSize;
+                blockSize = Align(4 + attachment.data.size());
+                size_t const nextOffset = attachmentIdx + 1 < entry.attachments.size() ? blockSize : 0;
+                uint32_t const code = attachment.code | static_cast<uint32_t>(nextOffset << 8);
+                std::memcpy(block, &code, 4);
+                std::memcpy(block + 4, attachment.data.data(), attachment.data.size());
+            }
+        }
+
+        output = compress ? QfsCompression::Compress(fsh, maxIterations) : std::move(fsh);
+        return true;
+    }
+
+    bool FshWriter::Save(std::string const &filepath, bool const compress, int const maxIterations) const {
+        std::vector<uint8_t> data;
+        if (!Serialize(data, compress, maxIterations)) {
+            return false;
+        }
+        std::ofstream file(filepath, std::ios::binary);
+        if (!file) {
+            m_lastError = "Failed to open file: " + filepath;
+            return false;
+        }
+        if (!file.write(reinterpret_cast<char const *>(data.data()), static_cast<std::streamsize>(data.size()))) {
+            m_lastError = "Failed to write file: " + filepath;
+            return false;
+        }
+        return true;
+    }
+
+} // namespace LibOpenNFS::Shared
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "FshTexture.h"
+#include "FshTypes.h"
+#include "QfsCompression.h"
+
+#include <string>
+#include <vector>
+
+namespace LibOpenNFS::Shared {
+
+    class FshArchive;
+
+    /**
+     * Writes FSH (SHPI) archives, optionally QFS compressed.
+     *
+     * Textures are written with their pixel data as stored in FshTexture::RawData, followed by a local palette for indexed
+     * textures and any extra attachments. The archive is laid out up front and written into a single buffer of its final size,
+     * with every entry and attachment starting on a 16-byte boundary.
+     *
+     * Usage:
+     *   FshWriter writer = FshWriter::FromArchive(archive);
+     *   writer.SetShareIdenticalTextures(true);
+     *   if (!writer.Save("textures.qfs", true)) {
+     *       std::cerr << writer.LastError();
+     *   }
+     */
+    class FshWriter {
+      public:
+        /**
+         * Attachment written after a texture (and its palette)
+         */
+        struct Attachment {
+            uint8_t code = static_cast<uint8_t>(AttachmentType::Binary);
+            std::vector<uint8_t> data; // Everything following the 4-byte code/next offset word, as stored
+        };
+
+        explicit FshWriter(std::string directoryId = "GIMX");
+
+        /**
+         * Writer holding copies of every texture of an archive, its global palette and directory ID
+         */
+        static FshWriter FromArchive(FshArchive const &archive);
+
+        /**
+         * Add a texture, written in the order added
+         * @param texture Texture to write, its name (up to 4 characters) becomes the directory entry name
+         * @param attachments Attachments written after the texture's pixel data and palette
+         */
+        void AddTexture(FshTexture texture, std::vector<Attachment> attachments = {});
+
+        /**
+         * Write a "!pal" global palette entry. Indexed textures whose palette matches it are written without a local palette.
+         */
+        void SetGlobalPalette(Palette const &palette);
+
+        /**
+         * Format of written palettes, ARGB32 by default (lossless). Serialize fails for formats other than RGB24, RGB24_DOS,
+         * ARGB16_1555, RGB16_565 and ARGB32.
+         */
+        void SetPaletteFormat(PaletteFormat format);
+
+        /**
+         * Point directory entries of textures with identical content and attachments at a single copy of their data
+         */
+        void SetShareIdenticalTextures(bool share);
+
+        size_t TextureCount() const {
+            return m_entries.size();
+        }
+
+        /**
+         * Serialize the archive
+         * @param output Set to the archive
+         * @param compress If true, QFS compress the archive
+         * @param maxIterations QFS compression quality factor (higher = better compression, slower)
+         * @return false if a texture can't be written, see LastError
+         */
+        bool Serialize(std::vector<uint8_t> &output, bool compress = false,
+                       int maxIterations = QfsCompression::DEFAULT_MAX_ITERATIONS) const;
+
+        /**
+         * Serialize the archive to a file, written in one go
+         * @param filepath Output file path
+         * @param compress If true, QFS compress the archive
+         * @param maxIterations QFS compression quality factor (higher = better compression, slower)
+         * @return true on success
+         */
+        bool Save(std::string const &filepath, bool compress = false, int maxIterations = QfsCompression::DEFAULT_MAX_ITERATIONS) const;
+
+        /**
+         * Get the last error message
+         */
+        std::string const &LastError() const {
+            return m_lastError;
+        }
+
+      private:
+        struct Entry {
+            FshTexture texture;
+            std::vector<Attachment> attachments;
+        };
+
+        std::string m_directoryId;
+        std::vector<Entry> m_entries;
+        Palette m_globalPalette;
+        bool m_hasGlobalPalette = false;
+        PaletteFormat m_paletteFormat = PaletteFormat::ARGB32;
+        bool m_shareIdenticalTextures = false;
+        mutable std::string m_lastError;
+
+        bool NeedsLocalPalette(FshTexture const &texture) const;
+        size_t PaletteSize(Palette const &palette) const;
+        void WritePalette(Palette const &palette, uint8_t *output) const;
+        static bool IsSameEntry(Entry const &a, Entry const &b);
+    };
+
+} // namespace LibOpenNFS::Shared
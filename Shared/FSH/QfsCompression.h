@@ -1,7 +1,8 @@
 #pragma once
 
-#include <vector>
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 namespace LibOpenNFS::Shared {
 
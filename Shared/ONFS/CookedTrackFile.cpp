@@ -0,0 +1,463 @@
+#include "CookedTrackFile.h"
+
+#include <functional>
+#include <set>
+#include <unordered_map>
+
+#include "Common/Logging.h"
+
+namespace LibOpenNFS::Shared {
+    namespace {
+        template <typename T> void WritePod(std::ofstream &ofstream, T const &value) {
+            ofstream.write(reinterpret_cast<char const *>(&value), sizeof(T));
+        }
+        template <typename T> void WriteVector(std::ofstream &ofstream, std::vector<T> const &values) {
+            WritePod(ofstream, static_cast<uint32_t>(values.size()));
+            ofstream.write(reinterpret_cast<char const *>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+        }
+        void WriteString(std::ofstream &ofstream, std::string const &value) {
+            WritePod(ofstream, static_cast<uint32_t>(value.size()));
+            ofstream.write(value.data(), static_cast<std::streamsize>(value.size()));
+        }
+
+        template <typename T> [[nodiscard]] bool ReadVector(std::ifstream &ifstream, std::vector<T> &values) {
+            uint32_t count;
+            onfs_check(safe_read(ifstream, count));
+            values.resize(count);
+            return safe_read(ifstream, values);
+        }
+        [[nodiscard]] bool ReadString(std::ifstream &ifstream, std::string &value) {
+            uint32_t length;
+            onfs_check(safe_read(ifstream, length));
+            value.resize(length);
+            return ifstream.read(value.data(), length).gcount() == length;
+        }
+
+        // Meshes shared between entities are written once, to the mesh table, and referred to by index
+        using MeshIndices = std::unordered_map<TrackGeometry const *, uint32_t>;
+        using MeshReader = std::function<std::shared_ptr<TrackGeometry>(uint32_t meshIdx)>;
+        constexpr uint32_t kOwnMesh{UINT32_MAX};
+
+        void WriteGeometry(std::ofstream &ofstream, TrackGeometry const &geometry) {
+            WriteString(ofstream, geometry.name);
+            WritePod(ofstream, geometry.position);
+            WritePod(ofstream, geometry.initialPosition);
+            WritePod(ofstream, geometry.orientation_vec);
+            WritePod(ofstream, geometry.orientation);
+            WritePod(ofstream, geometry.m_bounds);
+            WriteVector(ofstream, geometry.m_vertices);
+            WriteVector(ofstream, geometry.m_normals);
+            WriteVector(ofstream, geometry.m_uvs);
+            WriteVector(ofstream, geometry.m_vertexIndices);
+            WriteVector(ofstream, geometry.m_indices);
+            WriteVector(ofstream, geometry.m_textureIndices);
+            WriteVector(ofstream, geometry.m_shadingData);
+            WriteVector(ofstream, geometry.m_debugData);
+        }
+
+        [[nodiscard]] bool ReadGeometry(std::ifstream &ifstream, TrackGeometry &geometry) {
+            onfs_check(ReadString(ifstream, geometry.name));
+            onfs_check(safe_read(ifstream, geometry.position));
+            onfs_check(safe_read(ifstream, geometry.initialPosition));
+            onfs_check(safe_read(ifstream, geometry.orientation_vec));
+            onfs_check(safe_read(ifstream, geometry.orientation));
+            onfs_check(safe_read(ifstream, geometry.m_bounds));
+            onfs_check(ReadVector(ifstream, geometry.m_vertices));
+            onfs_check(ReadVector(ifstream, geometry.m_normals));
+            onfs_check(ReadVector(ifstream, geometry.m_uvs));
+            onfs_check(ReadVector(ifstream, geometry.m_vertexIndices));
+            onfs_check(ReadVector(ifstream, geometry.m_indices));
+            onfs_check(ReadVector(ifstream, geometry.m_textureIndices));
+            onfs_check(ReadVector(ifstream, geometry.m_shadingData));
+            onfs_check(ReadVector(ifstream, geometry.m_debugData));
+            return true;
+        }
+
+        // Instances of shared meshes only write their placement (TrackEntity::geometry) and the index of the mesh
+        void WriteEntity(std::ofstream &ofstream, TrackEntity const &entity, MeshIndices const &meshIndices) {
+            WritePod(ofstream, entity.entityID);
+            WritePod(ofstream, static_cast<uint32_t>(entity.type));
+            WritePod(ofstream, entity.flags);
+            WritePod(ofstream, static_cast<uint8_t>(entity.hasGeometry));
+            WritePod(ofstream, static_cast<uint8_t>(entity.collidable));
+            WritePod(ofstream, static_cast<uint8_t>(entity.dynamic));
+            WritePod(ofstream, entity.animDelay);
+            WriteVector(ofstream, entity.animKeyframes);
+            WritePod(ofstream, entity.sharedGeometry ? meshIndices.at(entity.sharedGeometry.get()) : kOwnMesh);
+            WriteGeometry(ofstream, entity.geometry);
+        }
+
+        [[nodiscard]] bool ReadEntity(std::ifstream &ifstream, std::vector<TrackEntity> &entities, MeshReader const &readMesh) {
+            uint32_t entityID, type, flags, meshIdx;
+            uint8_t hasGeometry, collidable, dynamic;
+            uint16_t animDelay;
+            std::vector<AnimKeyframe> animKeyframes;
+            TrackGeometry geometry;
+            onfs_check(safe_read(ifstream, entityID));
+            onfs_check(safe_read(ifstream, type));
+            onfs_check(safe_read(ifstream, flags));
+            onfs_check(safe_read(ifstream, hasGeometry));
+            onfs_check(safe_read(ifstream, collidable));
+            onfs_check(safe_read(ifstream, dynamic));
+            onfs_check(safe_read(ifstream, animDelay));
+            onfs_check(ReadVector(ifstream, animKeyframes));
+            onfs_check(safe_read(ifstream, meshIdx));
+            onfs_check(ReadGeometry(ifstream, geometry));
+
+            std::shared_ptr<TrackGeometry> sharedGeometry;
+            if (meshIdx != kOwnMesh) {
+                sharedGeometry = readMesh(meshIdx);
+                onfs_check(sharedGeometry != nullptr);
+            }
+            TrackEntity &entity{sharedGeometry ? entities.emplace_back(entityID, static_cast<EntityType>(type), sharedGeometry,
+                                                                       geometry.position, flags)
+                                : hasGeometry  ? entities.emplace_back(entityID, static_cast<EntityType>(type), geometry,
+                                                                       animKeyframes, animDelay, flags)
+                                               : entities.emplace_back(entityID, static_cast<EntityType>(type), flags)};
+            if (sharedGeometry) {
+                entity.geometry = std::move(geometry);
+                entity.animDelay = animDelay;
+                entity.animKeyframes = std::move(animKeyframes);
+                entity.UpdateBounds();
+            }
+            entity.collidable = collidable;
+            entity.dynamic = dynamic;
+            return true;
+        }
+
+        void WriteEntities(std::ofstream &ofstream, std::vector<TrackEntity> const &entities, MeshIndices const &meshIndices) {
+            WritePod(ofstream, static_cast<uint32_t>(entities.size()));
+            for (auto const &entity : entities) {
+                WriteEntity(ofstream, entity, meshIndices);
+            }
+        }
+
+        [[nodiscard]] bool ReadEntities(std::ifstream &ifstream, std::vector<TrackEntity> &entities, MeshReader const &readMesh) {
+            uint32_t nEntities;
+            onfs_check(safe_read(ifstream, nEntities));
+            entities.clear();
+            entities.reserve(nEntities);
+            for (uint32_t entityIdx = 0; entityIdx < nEntities; ++entityIdx) {
+                onfs_check(ReadEntity(ifstream, entities, readMesh));
+            }
+            return true;
+        }
+
+        void WriteBlockGeometry(std::ofstream &ofstream, TrackBlock const &trackBlock, MeshIndices const &meshIndices) {
+            for (auto const *entities : {&trackBlock.track, &trackBlock.objects, &trackBlock.lanes, &trackBlock.lowResTrack,
+                                         &trackBlock.medResTrack}) {
+                WriteEntities(ofstream, *entities, meshIndices);
+            }
+            WritePod(ofstream, static_cast<uint32_t>(trackBlock.lights.size()));
+            for (auto const &light : trackBlock.lights) {
+                WritePod(ofstream, light.entityID);
+                WritePod(ofstream, light.position);
+                WritePod(ofstream, light.colour);
+                WritePod(ofstream, light.nfsType);
+                WritePod(ofstream, light.unknown1);
+                WritePod(ofstream, light.unknown2);
+                WritePod(ofstream, light.unknown3);
+                WritePod(ofstream, light.unknown4);
+            }
+            WritePod(ofstream, static_cast<uint32_t>(trackBlock.sounds.size()));
+            for (auto const &sound : trackBlock.sounds) {
+                WritePod(ofstream, sound.position);
+                WritePod(ofstream, sound.type);
+            }
+            WritePod(ofstream, trackBlock.nLowResVertices);
+            WritePod(ofstream, trackBlock.nMedResVertices);
+            WritePod(ofstream, trackBlock.nHighResVertices);
+        }
+
+        std::vector<uint32_t> BlockTextureIds(TrackBlock const &trackBlock) {
+            std::set<uint32_t> textureIds;
+            for (auto const *entities : {&trackBlock.track, &trackBlock.objects, &trackBlock.lanes, &trackBlock.lowResTrack,
+                                         &trackBlock.medResTrack}) {
+                for (auto const &entity : *entities) {
+                    textureIds.insert(entity.Mesh().m_textureIndices.begin(), entity.Mesh().m_textureIndices.end());
+                }
+            }
+            return {textureIds.begin(), textureIds.end()};
+        }
+
+        std::vector<uint32_t> BlockMeshIndices(TrackBlock const &trackBlock, MeshIndices const &meshIndices) {
+            std::set<uint32_t> blockMeshIndices;
+            for (auto const *entities : {&trackBlock.track, &trackBlock.objects, &trackBlock.lanes, &trackBlock.lowResTrack,
+                                         &trackBlock.medResTrack}) {
+                for (auto const &entity : *entities) {
+                    if (entity.sharedGeometry) {
+                        blockMeshIndices.insert(meshIndices.at(entity.sharedGeometry.get()));
+                    }
+                }
+            }
+            return {blockMeshIndices.begin(), blockMeshIndices.end()};
+        }
+    } // namespace
+
+    bool CookedTrackFile::Save(std::string const &cookedTrackPath, Track const &track) {
+        LogInfo("Saving cooked track to %s", cookedTrackPath.c_str());
+        std::ofstream ofstream(cookedTrackPath, std::ios::out | std::ios::binary);
+        if (!ofstream.is_open()) {
+            return false;
+        }
+
+        WritePod(ofstream, ONFS_SIGNATURE);
+        WritePod(ofstream, kVersion);
+        WritePod(ofstream, static_cast<uint32_t>(track.nfsVersion));
+        WriteString(ofstream, track.name);
+        WriteString(ofstream, track.basePath);
+        WriteString(ofstream, track.texturePath);
+        WriteString(ofstream, track.tag);
+        WriteVector(ofstream, track.cameraAnimation);
+        WriteVector(ofstream, track.virtualRoad);
+
+        // Number the shared meshes in the order they are first used
+        MeshIndices meshIndices;
+        std::vector<TrackGeometry const *> meshes;
+        auto const addMeshes = [&](std::vector<TrackEntity> const &entities) {
+            for (auto const &entity : entities) {
+                if (entity.sharedGeometry && meshIndices.emplace(entity.sharedGeometry.get(), meshes.size()).second) {
+                    meshes.push_back(entity.sharedGeometry.get());
+                }
+            }
+        };
+        addMeshes(track.globalObjects);
+        for (auto const &trackBlock : track.trackBlocks) {
+            for (auto const *entities : {&trackBlock.track, &trackBlock.objects, &trackBlock.lanes, &trackBlock.lowResTrack,
+                                         &trackBlock.medResTrack}) {
+                addMeshes(*entities);
+            }
+        }
+
+        // Tables are written with placeholder offsets, patched once the payloads that follow have been written. The mesh table
+        // comes first, so that global objects can be read back with their meshes.
+        std::vector<std::streampos> meshOffsetPositions, blockOffsetPositions, textureOffsetPositions;
+        WritePod(ofstream, static_cast<uint32_t>(meshes.size()));
+        for (size_t meshIdx = 0; meshIdx < meshes.size(); ++meshIdx) {
+            meshOffsetPositions.push_back(ofstream.tellp());
+            WritePod(ofstream, uint64_t{0});
+            WritePod(ofstream, uint64_t{0});
+        }
+        WriteEntities(ofstream, track.globalObjects, meshIndices);
+        WritePod(ofstream, static_cast<uint32_t>(track.trackBlocks.size()));
+        for (auto const &trackBlock : track.trackBlocks) {
+            WritePod(ofstream, trackBlock.id);
+            WritePod(ofstream, trackBlock.position);
+            WritePod(ofstream, trackBlock.virtualRoadStartIndex);
+            WritePod(ofstream, trackBlock.nVirtualRoadPositions);
+            WriteVector(ofstream, trackBlock.neighbourIds);
+            WritePod(ofstream, trackBlock.bounds);
+            WriteVector(ofstream, BlockTextureIds(trackBlock));
+            WriteVector(ofstream, BlockMeshIndices(trackBlock, meshIndices));
+            blockOffsetPositions.push_back(ofstream.tellp());
+            WritePod(ofstream, uint64_t{0});
+            WritePod(ofstream, uint64_t{0});
+        }
+        WritePod(ofstream, static_cast<uint32_t>(track.trackTextureAssets.size()));
+        for (auto const &[textureId, textureAsset] : track.trackTextureAssets) {
+            WritePod(ofstream, textureId);
+            textureOffsetPositions.push_back(ofstream.tellp());
+            WritePod(ofstream, uint64_t{0});
+            WritePod(ofstream, uint64_t{0});
+        }
+
+        std::vector<std::pair<uint64_t, uint64_t>> meshRanges, blockRanges, textureRanges;
+        for (TrackGeometry const *mesh : meshes) {
+            auto const offset{static_cast<uint64_t>(ofstream.tellp())};
+            WriteGeometry(ofstream, *mesh);
+            meshRanges.emplace_back(offset, static_cast<uint64_t>(ofstream.tellp()) - offset);
+        }
+        for (auto const &trackBlock : track.trackBlocks) {
+            auto const offset{static_cast<uint64_t>(ofstream.tellp())};
+            WriteBlockGeometry(ofstream, trackBlock, meshIndices);
+            blockRanges.emplace_back(offset, static_cast<uint64_t>(ofstream.tellp()) - offset);
+        }
+        for (auto const &[textureId, textureAsset] : track.trackTextureAssets) {
+            auto const offset{static_cast<uint64_t>(ofstream.tellp())};
+            WritePod(ofstream, textureAsset.width);
+            WritePod(ofstream, textureAsset.height);
+            WritePod(ofstream, textureAsset.layer);
+            WritePod(ofstream, textureAsset.minU);
+            WritePod(ofstream, textureAsset.minV);
+            WritePod(ofstream, textureAsset.maxU);
+            WritePod(ofstream, textureAsset.maxV);
+            WriteVector(ofstream, textureAsset.uvs);
+            WriteString(ofstream, textureAsset.fileReference);
+            WriteString(ofstream, textureAsset.alphaFileReference);
+            WriteVector(ofstream, *textureAsset.Pixels());
+            textureRanges.emplace_back(offset, static_cast<uint64_t>(ofstream.tellp()) - offset);
+        }
+
+        for (size_t meshIdx = 0; meshIdx < meshRanges.size(); ++meshIdx) {
+            ofstream.seekp(meshOffsetPositions[meshIdx]);
+            WritePod(ofstream, meshRanges[meshIdx].first);
+            WritePod(ofstream, meshRanges[meshIdx].second);
+        }
+        for (size_t blockIdx = 0; blockIdx < blockRanges.size(); ++blockIdx) {
+            ofstream.seekp(blockOffsetPositions[blockIdx]);
+            WritePod(ofstream, blockRanges[blockIdx].first);
+            WritePod(ofstream, blockRanges[blockIdx].second);
+        }
+        for (size_t textureIdx = 0; textureIdx < textureRanges.size(); ++textureIdx) {
+            ofstream.seekp(textureOffsetPositions[textureIdx]);
+            WritePod(ofstream, textureRanges[textureIdx].first);
+            WritePod(ofstream, textureRanges[textureIdx].second);
+        }
+
+        return ofstream.good();
+    }
+
+    bool CookedTrackFile::Open(std::string const &cookedTrackPath, CookedTrackFile &cookedTrackFile, Track &track) {
+        LogInfo("Opening cooked track located at %s", cookedTrackPath.c_str());
+        std::ifstream &ifstream{cookedTrackFile.m_stream};
+        ifstream.open(cookedTrackPath, std::ios::in | std::ios::binary);
+
+        uint32_t signature, version, nfsVersion;
+        onfs_check(safe_read(ifstream, signature));
+        onfs_check(safe_read(ifstream, version));
+        if (signature != ONFS_SIGNATURE || version != kVersion) {
+            LogWarning("%s is not a version %u cooked track", cookedTrackPath.c_str(), kVersion);
+            return false;
+        }
+        onfs_check(safe_read(ifstream, nfsVersion));
+        track.nfsVersion = static_cast<NFSVersion>(nfsVersion);
+        onfs_check(ReadString(ifstream, track.name));
+        onfs_check(ReadString(ifstream, track.basePath));
+        onfs_check(ReadString(ifstream, track.texturePath));
+        onfs_check(ReadString(ifstream, track.tag));
+        onfs_check(ReadVector(ifstream, track.cameraAnimation));
+        onfs_check(ReadVector(ifstream, track.virtualRoad));
+        uint32_t nMeshes;
+        onfs_check(safe_read(ifstream, nMeshes));
+        cookedTrackFile.meshes.resize(nMeshes);
+        for (auto &meshEntry : cookedTrackFile.meshes) {
+            onfs_check(safe_read(ifstream, meshEntry.offset));
+            onfs_check(safe_read(ifstream, meshEntry.size));
+        }
+        cookedTrackFile.m_meshes.assign(nMeshes, {});
+        std::set<uint32_t> globalMeshIndices;
+        onfs_check(ReadEntities(ifstream, track.globalObjects, [&](uint32_t const meshIdx) {
+            globalMeshIndices.insert(meshIdx);
+            return cookedTrackFile._ReadMesh(meshIdx);
+        }));
+        cookedTrackFile.globalMeshIndices.assign(globalMeshIndices.begin(), globalMeshIndices.end());
+
+        uint32_t nBlocks;
+        onfs_check(safe_read(ifstream, nBlocks));
+        track.nBlocks = nBlocks;
+        track.trackBlocks.clear();
+        track.trackBlocks.reserve(nBlocks);
+        cookedTrackFile.blocks.resize(nBlocks);
+        for (auto &blockEntry : cookedTrackFile.blocks) {
+            uint32_t id, virtualRoadStartIndex, nVirtualRoadPositions;
+            glm::vec3 position;
+            std::vector<uint32_t> neighbourIds;
+            onfs_check(safe_read(ifstream, id));
+            onfs_check(safe_read(ifstream, position));
+            onfs_check(safe_read(ifstream, virtualRoadStartIndex));
+            onfs_check(safe_read(ifstream, nVirtualRoadPositions));
+            onfs_check(ReadVector(ifstream, neighbourIds));
+            TrackBlock &trackBlock{track.trackBlocks.emplace_back(id, position, virtualRoadStartIndex, nVirtualRoadPositions, neighbourIds)};
+            onfs_check(safe_read(ifstream, trackBlock.bounds));
+            onfs_check(ReadVector(ifstream, blockEntry.textureIds));
+            onfs_check(ReadVector(ifstream, blockEntry.meshIndices));
+            onfs_check(safe_read(ifstream, blockEntry.offset));
+            onfs_check(safe_read(ifstream, blockEntry.size));
+        }
+        uint32_t nTextures;
+        onfs_check(safe_read(ifstream, nTextures));
+        cookedTrackFile.textures.resize(nTextures);
+        for (auto &textureEntry : cookedTrackFile.textures) {
+            onfs_check(safe_read(ifstream, textureEntry.id));
+            onfs_check(safe_read(ifstream, textureEntry.offset));
+            onfs_check(safe_read(ifstream, textureEntry.size));
+        }
+        // Block entities aren't loaded, so the bounds come from the table rather than Track::UpdateBounds
+        track.blockBVH = CullingBVH::Build(track.trackBlocks);
+
+        return true;
+    }
+
+    bool CookedTrackFile::ReadBlock(uint32_t const blockIdx, TrackBlock &trackBlock) {
+        m_stream.clear();
+        m_stream.seekg(static_cast<std::streamoff>(blocks[blockIdx].offset));
+        MeshReader const readMesh{[this](uint32_t const meshIdx) { return _ReadMesh(meshIdx); }};
+        for (auto *entities : {&trackBlock.track, &trackBlock.objects, &trackBlock.lanes, &trackBlock.lowResTrack, &trackBlock.medResTrack}) {
+            onfs_check(ReadEntities(m_stream, *entities, readMesh));
+        }
+        uint32_t nLights;
+        onfs_check(safe_read(m_stream, nLights));
+        trackBlock.lights.clear();
+        for (uint32_t lightIdx = 0; lightIdx < nLights; ++lightIdx) {
+            uint32_t entityID, nfsType, unknown1, unknown2, unknown3;
+            glm::vec3 position;
+            glm::vec4 colour;
+            float unknown4;
+            onfs_check(safe_read(m_stream, entityID));
+            onfs_check(safe_read(m_stream, position));
+            onfs_check(safe_read(m_stream, colour));
+            onfs_check(safe_read(m_stream, nfsType));
+            onfs_check(safe_read(m_stream, unknown1));
+            onfs_check(safe_read(m_stream, unknown2));
+            onfs_check(safe_read(m_stream, unknown3));
+            onfs_check(safe_read(m_stream, unknown4));
+            trackBlock.lights.emplace_back(entityID, position, colour, unknown1, unknown2, unknown3, unknown4).nfsType = nfsType;
+        }
+        uint32_t nSounds;
+        onfs_check(safe_read(m_stream, nSounds));
+        trackBlock.sounds.clear();
+        for (uint32_t soundIdx = 0; soundIdx < nSounds; ++soundIdx) {
+            glm::vec3 position;
+            uint32_t type;
+            onfs_check(safe_read(m_stream, position));
+            onfs_check(safe_read(m_stream, type));
+            // Loaders number sounds by their index in the block
+            trackBlock.sounds.emplace_back(soundIdx, position, type);
+        }
+        onfs_check(safe_read(m_stream, trackBlock.nLowResVertices));
+        onfs_check(safe_read(m_stream, trackBlock.nMedResVertices));
+        onfs_check(safe_read(m_stream, trackBlock.nHighResVertices));
+
+        return true;
+    }
+
+    bool CookedTrackFile::ReadTexture(uint32_t const textureIdx, TrackTextureAsset &textureAsset) {
+        m_stream.clear();
+        m_stream.seekg(static_cast<std::streamoff>(textures[textureIdx].offset));
+        textureAsset.id = textures[textureIdx].id;
+        onfs_check(safe_read(m_stream, textureAsset.width));
+        onfs_check(safe_read(m_stream, textureAsset.height));
+        onfs_check(safe_read(m_stream, textureAsset.layer));
+        onfs_check(safe_read(m_stream, textureAsset.minU));
+        onfs_check(safe_read(m_stream, textureAsset.minV));
+        onfs_check(safe_read(m_stream, textureAsset.maxU));
+        onfs_check(safe_read(m_stream, textureAsset.maxV));
+        onfs_check(ReadVector(m_stream, textureAsset.uvs));
+        onfs_check(ReadString(m_stream, textureAsset.fileReference));
+        onfs_check(ReadString(m_stream, textureAsset.alphaFileReference));
+        onfs_check(ReadVector(m_stream, textureAsset.data));
+
+        return true;
+    }
+
+    std::shared_ptr<TrackGeometry> CookedTrackFile::_ReadMesh(uint32_t const meshIdx) {
+        if (meshIdx >= meshes.size()) {
+            return nullptr;
+        }
+        if (std::shared_ptr<TrackGeometry> mesh{m_meshes[meshIdx].lock()}) {
+            return mesh;
+        }
+        // Read in the middle of an entity, so the stream is put back where it was
+        std::streampos const position{m_stream.tellg()};
+        m_stream.seekg(static_cast<std::streamoff>(meshes[meshIdx].offset));
+        auto mesh{std::make_shared<TrackGeometry>()};
+        bool const success{ReadGeometry(m_stream, *mesh)};
+        m_stream.clear();
+        m_stream.seekg(position);
+        if (!success) {
+            return nullptr;
+        }
+        m_meshes[meshIdx] = mesh;
+        return mesh;
+    }
+} // namespace LibOpenNFS::Shared
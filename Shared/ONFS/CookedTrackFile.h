@@ -0,0 +1,56 @@
+#pragma once
+
+#include "../../Common/IRawData.h"
+#include "Entities/Track.h"
+
+namespace LibOpenNFS::Shared {
+    // Preprocessed ("cooked") Track, written once from a fully loaded Track so that it can later be opened without parsing the
+    // original game files, and its blocks and textures read back individually. Opening reads the header: track metadata, virtual
+    // road, camera animation, global objects, and a table of every block (metadata, bounds, the texture IDs and shared meshes it
+    // uses and where its geometry lives), texture (metadata and where its pixels live) and shared mesh. Meshes shared between
+    // entities (TrackEntity::sharedGeometry) are stored once and read back shared, for as long as an entity using them is alive.
+    // Everything is stored in native byte order.
+    class CookedTrackFile {
+      public:
+        static constexpr uint32_t kVersion{2};
+
+        struct BlockEntry {
+            std::vector<uint32_t> textureIds;
+            std::vector<uint32_t> meshIndices; // Into meshes
+            uint64_t offset{0};
+            uint64_t size{0};
+        };
+        struct MeshEntry {
+            uint64_t offset{0};
+            uint64_t size{0};
+        };
+        struct TextureEntry {
+            uint32_t id{0};
+            uint64_t offset{0};
+            uint64_t size{0};
+        };
+
+        CookedTrackFile() = default;
+
+        static bool Save(std::string const &cookedTrackPath, Track const &track);
+        // On success, track holds every block with its metadata and bounds but no entities, and no textures
+        static bool Open(std::string const &cookedTrackPath, CookedTrackFile &cookedTrackFile, Track &track);
+
+        // Fill the track, objects, lanes, LOD, light and sound entities of a block returned by Open
+        bool ReadBlock(uint32_t blockIdx, TrackBlock &trackBlock);
+        bool ReadTexture(uint32_t textureIdx, TrackTextureAsset &textureAsset);
+
+        std::vector<BlockEntry> blocks;
+        std::vector<TextureEntry> textures;
+        std::vector<MeshEntry> meshes;
+        // Indices into meshes of the meshes used by global objects
+        std::vector<uint32_t> globalMeshIndices;
+
+      private:
+        // The shared mesh at an index into meshes, read unless an entity still holds it
+        std::shared_ptr<TrackGeometry> _ReadMesh(uint32_t meshIdx);
+
+        std::ifstream m_stream;
+        std::vector<std::weak_ptr<TrackGeometry>> m_meshes;
+    };
+} // namespace LibOpenNFS::Shared
@@ -1,8 +1,26 @@
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numbers>
+#include <queue>
+#include <random>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
+#include "Common/BlockCompression.h"
+#include "Common/BlockGraph.h"
+#include "Common/CollisionBVH.h"
+#include "Common/Heightfield.h"
 #include "Common/Logging.h"
+#include "Common/TextureContainer.h"
+#include "Common/VirtualRoadIndex.h"
+#include "Shared/FSH/FshArchive.h"
+#include "Shared/FSH/FshWriter.h"
+
+using namespace LibOpenNFS;
 
 class ParseTest : public testing::Test {
   public:
@@ -13,8 +31,677 @@ class ParseTest : public testing::Test {
     }
 };
 
+namespace {
+    // Texture with deterministic pixel data and, for indexed formats, a palette derived from seed
+    Shared::FshTexture MakeFshTexture(std::string const &name, uint16_t const width, uint16_t const height,
+                                      Shared::PixelFormat const format, uint32_t const seed) {
+        Shared::FshTexture texture(name, width, height, format);
+        texture.RawData().resize(Shared::GetPixelDataSize(format, width, height));
+        for (size_t i = 0; i < texture.RawData().size(); ++i) {
+            texture.RawData()[i] = static_cast<uint8_t>(i * 31 + seed * 7 + i / 13);
+        }
+        texture.SetHasAlphaAttachment(Shared::HasAlphaChannel(format));
+        if (texture.HasPalette()) {
+            for (size_t i = 0; i < Shared::Palette::MAX_COLORS; ++i) {
+                texture.GetPalette()[i] = Shared::Colour(static_cast<uint8_t>(i + seed), static_cast<uint8_t>(255 - i),
+                                                         static_cast<uint8_t>(i * 3), (i & 1) ? 255 : 0);
+            }
+        }
+        return texture;
+    }
+
+    Shared::FshArchive WriteAndLoad(Shared::FshWriter const &writer, bool const compress) {
+        std::vector<uint8_t> data;
+        EXPECT_TRUE(writer.Serialize(data, compress)) << writer.LastError();
+        Shared::FshArchive archive;
+        EXPECT_TRUE(archive.Load(data)) << archive.LastError();
+        return archive;
+    }
+
+    // Block with a single ROAD entity over the given world space triangle list
+    TrackBlock MakeRoadBlock(uint32_t const id, std::vector<glm::vec3> const &vertices, std::vector<uint32_t> const &neighbourIds = {}) {
+        TrackBlock block(id, glm::vec3(0.f), 0, 0, neighbourIds);
+        std::vector<uint32_t> indices(vertices.size());
+        for (uint32_t vertexIdx = 0; vertexIdx < indices.size(); ++vertexIdx) {
+            indices[vertexIdx] = vertexIdx;
+        }
+        block.track.emplace_back(id, EntityType::ROAD,
+                                 TrackGeometry(vertices, std::vector<glm::vec3>(vertices.size(), glm::vec3(0.f, 1.f, 0.f)),
+                                               std::vector<glm::vec2>(vertices.size()), std::vector<uint32_t>(vertices.size(), id), indices,
+                                               std::vector<glm::vec4>(vertices.size()), glm::vec3(0.f)));
+        return block;
+    }
+
+    // Two triangles covering [min.x, max.x] x [min.z, max.z] at height y
+    void AddFlatQuad(std::vector<glm::vec3> &vertices, glm::vec2 const min, glm::vec2 const max, float const y) {
+        vertices.insert(vertices.end(), {glm::vec3(min.x, y, min.y), glm::vec3(max.x, y, min.y), glm::vec3(max.x, y, max.y),
+                                         glm::vec3(min.x, y, min.y), glm::vec3(max.x, y, max.y), glm::vec3(min.x, y, max.y)});
+    }
+
+    TrackVRoad MakeVRoadPoint(glm::vec3 const &position) {
+        glm::vec3 const zero{0.f};
+        return TrackVRoad(position, position, glm::vec3(0.f, 1.f, 0.f), zero, zero, zero, zero, 0);
+    }
+
+    // Brute force references for the CollisionBVH queries
+    bool RayTriangle(glm::vec3 const &origin, glm::vec3 const &direction, CollisionBVH::Triangle const &triangle, float &distance) {
+        glm::vec3 const p{glm::cross(direction, triangle.edge2)};
+        float const det{glm::dot(triangle.edge1, p)};
+        if (std::abs(det) < 1e-12f) {
+            return false;
+        }
+        glm::vec3 const toOrigin{origin - triangle.v0};
+        float const u{glm::dot(toOrigin, p) / det};
+        glm::vec3 const q{glm::cross(toOrigin, triangle.edge1)};
+        float const v{glm::dot(direction, q) / det};
+        distance = glm::dot(triangle.edge2, q) / det;
+        return u >= 0.f && v >= 0.f && u + v <= 1.f && distance >= 0.f;
+    }
+
+    glm::vec3 ClosestPointOnTriangle(glm::vec3 const &point, CollisionBVH::Triangle const &triangle) {
+        glm::vec3 const a{triangle.v0}, b{triangle.v0 + triangle.edge1}, c{triangle.v0 + triangle.edge2};
+        glm::vec3 const ab{triangle.edge1}, ac{triangle.edge2};
+        float const d1{glm::dot(ab, point - a)}, d2{glm::dot(ac, point - a)};
+        if (d1 <= 0.f && d2 <= 0.f) {
+            return a;
+        }
+        float const d3{glm::dot(ab, point - b)}, d4{glm::dot(ac, point - b)};
+        if (d3 >= 0.f && d4 <= d3) {
+            return b;
+        }
+        float const vc{d1 * d4 - d3 * d2};
+        if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f) {
+            return a + ab * (d1 / (d1 - d3));
+        }
+        float const d5{glm::dot(ab, point - c)}, d6{glm::dot(ac, point - c)};
+        if (d6 >= 0.f && d5 <= d6) {
+            return c;
+        }
+        float const vb{d5 * d2 - d1 * d6};
+        if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f) {
+            return a + ac * (d2 / (d2 - d6));
+        }
+        float const va{d3 * d6 - d5 * d4};
+        if (va <= 0.f && d4 - d3 >= 0.f && d5 - d6 >= 0.f) {
+            return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        }
+        return a + ab * (vb / (va + vb + vc)) + ac * (vc / (va + vb + vc));
+    }
+
+    float DistanceToTriangles(glm::vec3 const &point, std::vector<CollisionBVH::Triangle> const &triangles) {
+        float distance{FLT_MAX};
+        for (auto const &triangle : triangles) {
+            distance = std::min(distance, glm::length(point - ClosestPointOnTriangle(point, triangle)));
+        }
+        return distance;
+    }
+
+    // Scalar BC1/BC2/BC3 decoder, as FshTexture decoded DXT1/DXT3 before the batched decoder: endpoints are expanded from 565 by
+    // shifting (or by replicating their top bits, as GPUs do), and colour0 <= colour1 selects three colour mode (index 3
+    // transparent black) outside BC3
+    std::vector<uint8_t> DecodeBlocks(uint8_t const *blocks, uint32_t const width, uint32_t const height, BlockFormat const format,
+                                      bool const replicateBits = false) {
+        std::vector<uint8_t> rgba(static_cast<size_t>(width) * height * 4);
+        size_t const blockSize{BlockCompression::BlockSize(format)};
+        uint32_t const blocksWide{(width + 3) / 4};
+        for (uint32_t blockY = 0; blockY < (height + 3) / 4; ++blockY) {
+            for (uint32_t blockX = 0; blockX < blocksWide; ++blockX) {
+                uint8_t const *const block{blocks + (blockY * blocksWide + blockX) * blockSize};
+                uint8_t const *const colourBlock{format == BlockFormat::BC1 ? block : block + 8};
+                uint16_t const colour0{static_cast<uint16_t>(colourBlock[0] | colourBlock[1] << 8)};
+                uint16_t const colour1{static_cast<uint16_t>(colourBlock[2] | colourBlock[3] << 8)};
+                Shared::Colour palette[4]{Shared::Colour::FromRGB16_565(colour0), Shared::Colour::FromRGB16_565(colour1)};
+                for (uint32_t endpointIdx = 0; replicateBits && endpointIdx < 2; ++endpointIdx) {
+                    palette[endpointIdx].r |= palette[endpointIdx].r >> 5;
+                    palette[endpointIdx].g |= palette[endpointIdx].g >> 6;
+                    palette[endpointIdx].b |= palette[endpointIdx].b >> 5;
+                }
+                bool const fourColour{colour0 > colour1 || format == BlockFormat::BC3};
+                palette[2] = fourColour ? Shared::Colour(static_cast<uint8_t>((2 * palette[0].r + palette[1].r) / 3),
+                                                         static_cast<uint8_t>((2 * palette[0].g + palette[1].g) / 3),
+                                                         static_cast<uint8_t>((2 * palette[0].b + palette[1].b) / 3))
+                                        : Shared::Colour(static_cast<uint8_t>((palette[0].r + palette[1].r) / 2),
+                                                         static_cast<uint8_t>((palette[0].g + palette[1].g) / 2),
+                                                         static_cast<uint8_t>((palette[0].b + palette[1].b) / 2));
+                palette[3] = fourColour ? Shared::Colour(static_cast<uint8_t>((palette[0].r + 2 * palette[1].r) / 3),
+                                                         static_cast<uint8_t>((palette[0].g + 2 * palette[1].g) / 3),
+                                                         static_cast<uint8_t>((palette[0].b + 2 * palette[1].b) / 3))
+                                        : Shared::Colour(0, 0, 0, 0);
+                uint8_t alphas[8]{block[0], block[1]};
+                for (uint32_t alphaIdx = 2; alphaIdx < 8; ++alphaIdx) {
+                    alphas[alphaIdx] = alphas[0] > alphas[1]
+                                           ? static_cast<uint8_t>(((8 - alphaIdx) * alphas[0] + (alphaIdx - 1) * alphas[1]) / 7)
+                                       : alphaIdx < 6 ? static_cast<uint8_t>(((6 - alphaIdx) * alphas[0] + (alphaIdx - 1) * alphas[1]) / 5)
+                                                      : (alphaIdx == 6 ? 0 : 255);
+                }
+                uint64_t alphaIndices{0};
+                for (uint32_t byteIdx = 0; byteIdx < 6; ++byteIdx) {
+                    alphaIndices |= static_cast<uint64_t>(block[2 + byteIdx]) << (byteIdx * 8);
+                }
+
+                for (uint32_t texelIdx = 0; texelIdx < 16; ++texelIdx) {
+                    uint32_t const x{blockX * 4 + texelIdx % 4}, y{blockY * 4 + texelIdx / 4};
+                    if (x >= width || y >= height) {
+                        continue;
+                    }
+                    Shared::Colour texel{palette[colourBlock[4 + texelIdx / 4] >> (texelIdx % 4 * 2) & 3]};
+                    if (format == BlockFormat::BC2) {
+                        texel.a = static_cast<uint8_t>((block[texelIdx / 2] >> (texelIdx % 2 * 4) & 0xF) * 17);
+                    } else if (format == BlockFormat::BC3) {
+                        texel.a = alphas[alphaIndices >> (texelIdx * 3) & 7];
+                    }
+                    uint8_t *const output{rgba.data() + (static_cast<size_t>(y) * width + x) * 4};
+                    output[0] = texel.r;
+                    output[1] = texel.g;
+                    output[2] = texel.b;
+                    output[3] = texel.a;
+                }
+            }
+        }
+        return rgba;
+    }
+
+    uint32_t Read32(std::vector<uint8_t> const &file, size_t const offset) {
+        return file[offset] | file[offset + 1] << 8 | file[offset + 2] << 16 | static_cast<uint32_t>(file[offset + 3]) << 24;
+    }
+    uint64_t Read64(std::vector<uint8_t> const &file, size_t const offset) {
+        return Read32(file, offset) | static_cast<uint64_t>(Read32(file, offset + 4)) << 32;
+    }
+} // namespace
+
 // Test that testing works (TODO: Add actual tests!)
 TEST_F(ParseTest, Dummy) {
-    constexpr std::string sky = "blue";
+    std::string const sky = "blue";
     ASSERT_TRUE(sky == "blue");
-}
\ No newline at end of file
+}
+
+TEST(FshWriterTest, RoundTripsEveryPixelFormat) {
+    Shared::PixelFormat const formats[]{Shared::PixelFormat::Indexed4Bit, Shared::PixelFormat::Indexed8BitPSH,
+                                        Shared::PixelFormat::Indexed8Bit, Shared::PixelFormat::ARGB32,
+                                        Shared::PixelFormat::RGB24,       Shared::PixelFormat::ARGB16_1555,
+                                        Shared::PixelFormat::RGB16_565,   Shared::PixelFormat::ARGB16_4444,
+                                        Shared::PixelFormat::DXT1,        Shared::PixelFormat::DXT3};
+    for (bool const compress : {false, true}) {
+        Shared::FshWriter writer;
+        std::vector<Shared::FshTexture> textures;
+        for (uint32_t formatIdx = 0; formatIdx < std::size(formats); ++formatIdx) {
+            textures.push_back(MakeFshTexture("tex" + std::to_string(formatIdx), static_cast<uint16_t>(13 + formatIdx),
+                                              static_cast<uint16_t>(7 + formatIdx), formats[formatIdx], formatIdx));
+            writer.AddTexture(textures.back());
+        }
+
+        Shared::FshArchive const archive{WriteAndLoad(writer, compress)};
+        EXPECT_EQ(archive.WasCompressed(), compress);
+        ASSERT_EQ(archive.TextureCount(), textures.size());
+        for (size_t textureIdx = 0; textureIdx < textures.size(); ++textureIdx) {
+            Shared::FshTexture const &texture{archive.GetTexture(textureIdx)};
+            EXPECT_EQ(texture.Name(), textures[textureIdx].Name());
+            EXPECT_EQ(texture.Format(), textures[textureIdx].Format());
+            EXPECT_EQ(texture.ToRGBA(), textures[textureIdx].ToRGBA()) << "format " << static_cast<int>(texture.Format());
+        }
+    }
+}
+
+TEST(FshWriterTest, KeepsLocalPalettesBesideAGlobalPalette) {
+    Shared::Palette globalPalette;
+    for (size_t i = 0; i < Shared::Palette::MAX_COLORS; ++i) {
+        globalPalette[i] = Shared::Colour(static_cast<uint8_t>(i), static_cast<uint8_t>(i), static_cast<uint8_t>(i), 255);
+    }
+    Shared::FshTexture const localPaletteTexture{MakeFshTexture("locl", 8, 8, Shared::PixelFormat::Indexed8Bit, 1)};
+    Shared::FshTexture globalPaletteTexture{MakeFshTexture("glob", 8, 8, Shared::PixelFormat::Indexed8Bit, 2)};
+    globalPaletteTexture.GetPalette() = globalPalette;
+
+    Shared::FshWriter writer;
+    writer.SetGlobalPalette(globalPalette);
+    writer.AddTexture(localPaletteTexture);
+    writer.AddTexture(globalPaletteTexture);
+
+    Shared::FshArchive const archive{WriteAndLoad(writer, false)};
+    ASSERT_NE(archive.GlobalPalette(), nullptr);
+    ASSERT_EQ(archive.TextureCount(), 2u);
+    EXPECT_EQ(archive.GetTexture(0).ToRGBA(), localPaletteTexture.ToRGBA());
+    EXPECT_EQ(archive.GetTexture(1).ToRGBA(), globalPaletteTexture.ToRGBA());
+}
+
+TEST(CollisionBVHTest, MatchesBruteForceQueries) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> positionDist(-50.f, 50.f), cornerDist(-3.f, 3.f);
+    Track track;
+    for (uint32_t blockIdx = 0; blockIdx < 8; ++blockIdx) {
+        std::vector<glm::vec3> vertices;
+        for (uint32_t triangleIdx = 0; triangleIdx < 100; ++triangleIdx) {
+            glm::vec3 const centre{positionDist(rng), positionDist(rng) * 0.2f, positionDist(rng)};
+            for (uint32_t corner = 0; corner < 3; ++corner) {
+                vertices.push_back(centre + glm::vec3(cornerDist(rng), cornerDist(rng), cornerDist(rng)));
+            }
+        }
+        track.trackBlocks.push_back(MakeRoadBlock(blockIdx, vertices));
+    }
+    CollisionBVH const bvh{CollisionBVH::Build(track)};
+    auto const &triangles{bvh.Triangles()};
+    ASSERT_EQ(triangles.size(), 800u);
+
+    float constexpr kRadius{1.f}, kSweepDistance{20.f};
+    uint32_t nRayHits{0}, nSweepHits{0};
+    for (uint32_t queryIdx = 0; queryIdx < 200; ++queryIdx) {
+        glm::vec3 const origin{positionDist(rng), positionDist(rng) * 0.2f, positionDist(rng)};
+        glm::vec3 const direction{glm::normalize(glm::vec3(positionDist(rng), positionDist(rng), positionDist(rng)))};
+
+        float nearest{FLT_MAX};
+        for (auto const &triangle : triangles) {
+            float distance;
+            if (RayTriangle(origin, direction, triangle, distance)) {
+                nearest = std::min(nearest, distance);
+            }
+        }
+        CollisionBVH::Hit rayHit;
+        bool const rayHitFound{bvh.Raycast(origin, direction, FLT_MAX, rayHit)};
+        ASSERT_EQ(rayHitFound, nearest != FLT_MAX) << "query " << queryIdx;
+        if (rayHitFound) {
+            ++nRayHits;
+            EXPECT_NEAR(rayHit.distance, nearest, 1e-3f);
+        }
+
+        CollisionBVH::Hit closestHit;
+        ASSERT_TRUE(bvh.ClosestPoint(origin, FLT_MAX, closestHit));
+        EXPECT_NEAR(closestHit.distance, DistanceToTriangles(origin, triangles), 1e-3f);
+        EXPECT_NEAR(glm::length(closestHit.position - origin), closestHit.distance, 1e-3f);
+
+        // The swept sphere touches at the reported distance and overlaps nothing before it
+        CollisionBVH::Hit sweepHit;
+        bool const sweepHitFound{bvh.SphereSweep(origin, direction, kRadius, kSweepDistance, sweepHit)};
+        float const travelled{sweepHitFound ? sweepHit.distance : kSweepDistance};
+        if (sweepHitFound && sweepHit.distance > 0.f) {
+            ++nSweepHits;
+            EXPECT_NEAR(DistanceToTriangles(origin + direction * sweepHit.distance, triangles), kRadius, 1e-2f);
+        }
+        for (float step = 0.f; step + 0.05f < travelled; step += 0.25f) {
+            ASSERT_GE(DistanceToTriangles(origin + direction * step, triangles), kRadius - 1e-3f) << "query " << queryIdx;
+        }
+    }
+    // The scene is dense enough that both kinds of query hit and miss
+    EXPECT_GT(nRayHits, 0u);
+    EXPECT_LT(nRayHits, 200u);
+    EXPECT_GT(nSweepHits, 0u);
+}
+
+TEST(HeightfieldTest, BlendsGridPointHeightsBilinearly) {
+    // Unit quads with random corner heights, which are exactly the grid points of a heightfield with unit cells
+    uint32_t constexpr kGridSize{16};
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> heightDist(0.f, 1.f);
+    std::vector<float> heights((kGridSize + 1) * (kGridSize + 1));
+    for (float &height : heights) {
+        height = heightDist(rng);
+    }
+    auto corner = [&](uint32_t const x, uint32_t const z) {
+        return glm::vec3(static_cast<float>(x), heights[z * (kGridSize + 1) + x], static_cast<float>(z));
+    };
+    std::vector<glm::vec3> vertices;
+    for (uint32_t z = 0; z < kGridSize; ++z) {
+        for (uint32_t x = 0; x < kGridSize; ++x) {
+            vertices.insert(vertices.end(), {corner(x, z), corner(x + 1, z), corner(x + 1, z + 1), corner(x, z), corner(x + 1, z + 1),
+                                             corner(x, z + 1)});
+        }
+    }
+    Track track;
+    track.trackBlocks.push_back(MakeRoadBlock(0, vertices));
+    Heightfield const heightfield{Heightfield::Build(track, 1.f)};
+
+    std::uniform_real_distribution<float> positionDist(0.f, static_cast<float>(kGridSize));
+    for (uint32_t queryIdx = 0; queryIdx < 1000; ++queryIdx) {
+        float const x{positionDist(rng)}, z{positionDist(rng)};
+        uint32_t const cellX{std::min(static_cast<uint32_t>(x), kGridSize - 1)}, cellZ{std::min(static_cast<uint32_t>(z), kGridSize - 1)};
+        float const fx{x - static_cast<float>(cellX)}, fz{z - static_cast<float>(cellZ)};
+        float const expected{(corner(cellX, cellZ).y * (1.f - fx) + corner(cellX + 1, cellZ).y * fx) * (1.f - fz) +
+                             (corner(cellX, cellZ + 1).y * (1.f - fx) + corner(cellX + 1, cellZ + 1).y * fx) * fz};
+        Heightfield::Sample sample;
+        ASSERT_TRUE(heightfield.Query(x, z, sample)) << x << ", " << z;
+        EXPECT_NEAR(sample.height, expected, 1e-4f) << x << ", " << z;
+    }
+    Heightfield::Sample sample;
+    EXPECT_FALSE(heightfield.Query(-5.f, -5.f, sample));
+}
+
+TEST(HeightfieldTest, PicksTheLayerAtTheReferenceHeight) {
+    // A bridge 10 units over a flat road
+    std::vector<glm::vec3> vertices;
+    AddFlatQuad(vertices, glm::vec2(0.f), glm::vec2(8.f), 0.f);
+    AddFlatQuad(vertices, glm::vec2(0.f), glm::vec2(8.f), 10.f);
+    Track track;
+    track.trackBlocks.push_back(MakeRoadBlock(0, vertices));
+    Heightfield const heightfield{Heightfield::Build(track, 1.f, 2.f)};
+
+    Heightfield::Sample sample;
+    ASSERT_TRUE(heightfield.Query(4.5f, 3.25f, 0.f, sample));
+    EXPECT_NEAR(sample.height, 0.f, 1e-5f);
+    ASSERT_TRUE(heightfield.Query(4.5f, 3.25f, 9.5f, sample));
+    EXPECT_NEAR(sample.height, 10.f, 1e-5f);
+    ASSERT_TRUE(heightfield.Query(4.5f, 3.25f, sample));
+    EXPECT_NEAR(sample.height, 10.f, 1e-5f);
+    EXPECT_NEAR(sample.normal.y, 1.f, 1e-5f);
+}
+
+TEST(VirtualRoadIndexTest, MeasuresArcLengthAlongAnOpenRoad) {
+    // Segments of length 1, 2, 3, 4 and 6
+    std::vector<TrackVRoad> virtualRoad;
+    for (glm::vec3 const &position : {glm::vec3(0.f), glm::vec3(1.f, 0.f, 0.f), glm::vec3(3.f, 0.f, 0.f), glm::vec3(6.f, 0.f, 0.f),
+                                      glm::vec3(6.f, 0.f, 4.f), glm::vec3(6.f, 0.f, 10.f)}) {
+        virtualRoad.push_back(MakeVRoadPoint(position));
+    }
+    VirtualRoadIndex const index{VirtualRoadIndex::Build(virtualRoad)};
+    EXPECT_FALSE(index.IsClosedLoop());
+    EXPECT_EQ(index.SegmentCount(), 5u);
+    EXPECT_NEAR(index.Length(), 16.f, 1e-5f);
+
+    VirtualRoadIndex::Projection projection;
+    ASSERT_TRUE(index.AtDistance(7.5f, projection));
+    EXPECT_EQ(projection.vroadIdx, 3u);
+    EXPECT_NEAR(projection.t, 0.375f, 1e-5f);
+    EXPECT_NEAR(glm::length(projection.position - glm::vec3(6.f, 0.f, 1.5f)), 0.f, 1e-5f);
+    // Clamped to the ends
+    ASSERT_TRUE(index.AtDistance(-1.f, projection));
+    EXPECT_NEAR(glm::length(projection.position), 0.f, 1e-5f);
+    ASSERT_TRUE(index.AtDistance(20.f, projection));
+    EXPECT_NEAR(glm::length(projection.position - glm::vec3(6.f, 0.f, 10.f)), 0.f, 1e-5f);
+
+    ASSERT_TRUE(index.Project(glm::vec3(6.5f, 2.f, 5.f), projection));
+    EXPECT_EQ(projection.vroadIdx, 4u);
+    EXPECT_NEAR(projection.distanceAlong, 11.f, 1e-4f);
+    EXPECT_NEAR(projection.distance, std::sqrt(4.25f), 1e-4f);
+}
+
+TEST(VirtualRoadIndexTest, WrapsArcLengthAroundACircuit) {
+    uint32_t constexpr kPoints{64};
+    float constexpr kRadius{100.f};
+    float const angleStep{2.f * std::numbers::pi_v<float> / kPoints};
+    std::vector<TrackVRoad> virtualRoad;
+    for (uint32_t pointIdx = 0; pointIdx < kPoints; ++pointIdx) {
+        float const angle{angleStep * static_cast<float>(pointIdx)};
+        virtualRoad.push_back(MakeVRoadPoint(glm::vec3(std::cos(angle) * kRadius, 0.f, std::sin(angle) * kRadius)));
+    }
+    VirtualRoadIndex const index{VirtualRoadIndex::Build(virtualRoad)};
+    float const chord{2.f * kRadius * std::sin(angleStep / 2.f)};
+    EXPECT_TRUE(index.IsClosedLoop());
+    EXPECT_EQ(index.SegmentCount(), kPoints);
+    EXPECT_NEAR(index.Length(), chord * kPoints, 1e-2f);
+
+    VirtualRoadIndex::Projection projection, wrapped;
+    for (uint32_t pointIdx = 0; pointIdx < kPoints; pointIdx += 7) {
+        ASSERT_TRUE(index.Project(virtualRoad[pointIdx].position, projection));
+        EXPECT_NEAR(projection.distance, 0.f, 1e-3f);
+        EXPECT_NEAR(projection.distanceAlong, chord * static_cast<float>(pointIdx), 1e-2f);
+    }
+    ASSERT_TRUE(index.AtDistance(chord * 2.5f, projection));
+    ASSERT_TRUE(index.AtDistance(index.Length() + chord * 2.5f, wrapped));
+    EXPECT_EQ(projection.vroadIdx, 2u);
+    EXPECT_NEAR(glm::length(projection.position - wrapped.position), 0.f, 1e-2f);
+}
+
+TEST(BlockGraphTest, MatchesBreadthFirstHopDistances) {
+    // Random graph with block IDs that don't match the block indices, plus a self reference, a reference to a block that doesn't
+    // exist and an isolated block
+    uint32_t constexpr kBlocks{40}, kMaxHops{3};
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<uint32_t> blockDist(0, kBlocks - 2);
+    auto blockId = [](uint32_t const blockIdx) { return 1000 + blockIdx * 3; };
+    std::vector<std::vector<uint32_t>> adjacency(kBlocks);
+    std::vector<TrackBlock> trackBlocks;
+    for (uint32_t blockIdx = 0; blockIdx < kBlocks; ++blockIdx) {
+        std::vector<uint32_t> neighbourIds;
+        for (uint32_t edgeIdx = 0; blockIdx + 1 < kBlocks && edgeIdx < 2; ++edgeIdx) {
+            uint32_t const neighbourIdx{blockDist(rng)};
+            neighbourIds.push_back(blockId(neighbourIdx));
+            if (neighbourIdx != blockIdx) {
+                adjacency[blockIdx].push_back(neighbourIdx);
+                adjacency[neighbourIdx].push_back(blockIdx);
+            }
+        }
+        if (blockIdx == 0) {
+            neighbourIds.push_back(blockId(0));
+            neighbourIds.push_back(7);
+        }
+        trackBlocks.emplace_back(blockId(blockIdx), glm::vec3(0.f), 0, 0, neighbourIds);
+    }
+    BlockGraph const graph{BlockGraph::Build(trackBlocks, kMaxHops)};
+    ASSERT_EQ(graph.BlockCount(), kBlocks);
+
+    for (uint32_t sourceIdx = 0; sourceIdx < kBlocks; ++sourceIdx) {
+        std::vector<uint32_t> neighbours{adjacency[sourceIdx]};
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+        auto const graphNeighbours{graph.Neighbours(sourceIdx)};
+        EXPECT_EQ(std::vector<uint32_t>(graphNeighbours.begin(), graphNeighbours.end()), neighbours);
+
+        std::vector<uint16_t> distances(kBlocks, BlockGraph::kUnreachable);
+        std::queue<uint32_t> queue;
+        distances[sourceIdx] = 0;
+        queue.push(sourceIdx);
+        while (!queue.empty()) {
+            uint32_t const blockIdx{queue.front()};
+            queue.pop();
+            for (uint32_t const neighbourIdx : adjacency[blockIdx]) {
+                if (distances[neighbourIdx] == BlockGraph::kUnreachable) {
+                    distances[neighbourIdx] = static_cast<uint16_t>(distances[blockIdx] + 1);
+                    queue.push(neighbourIdx);
+                }
+            }
+        }
+        for (uint32_t targetIdx = 0; targetIdx < kBlocks; ++targetIdx) {
+            ASSERT_EQ(graph.Distance(sourceIdx, targetIdx), distances[targetIdx]) << sourceIdx << " -> " << targetIdx;
+        }
+
+        for (uint32_t hops = 0; hops <= kMaxHops; ++hops) {
+            auto const nearby{graph.WithinHops(sourceIdx, hops)};
+            ASSERT_FALSE(nearby.empty());
+            EXPECT_EQ(nearby.front(), sourceIdx);
+            EXPECT_EQ(nearby.size(), static_cast<size_t>(std::count_if(distances.begin(), distances.end(),
+                                                                       [&](uint16_t const distance) { return distance <= hops; })));
+            for (size_t nearbyIdx = 1; nearbyIdx < nearby.size(); ++nearbyIdx) {
+                EXPECT_LE(distances[nearby[nearbyIdx - 1]], distances[nearby[nearbyIdx]]);
+                EXPECT_LE(distances[nearby[nearbyIdx]], hops);
+            }
+        }
+    }
+    EXPECT_EQ(graph.Distance(0, kBlocks - 1), BlockGraph::kUnreachable);
+}
+
+TEST(TrackTextureTableTest, IteratesInIdOrderAndErases) {
+    TrackTextureTable textures;
+    for (uint32_t const id : {130u, 3u, 64u, 63u, 0u}) {
+        textures[id] = TrackTextureAsset(id, 16, 16, "", "");
+    }
+    auto ids = [&] {
+        std::vector<uint32_t> result;
+        for (auto const &[id, texture] : textures) {
+            EXPECT_EQ(texture.id, id);
+            result.push_back(id);
+        }
+        return result;
+    };
+    EXPECT_EQ(textures.size(), 5u);
+    EXPECT_EQ(ids(), (std::vector<uint32_t>{0, 3, 63, 64, 130}));
+
+    EXPECT_EQ(textures.erase(64), 1u);
+    EXPECT_EQ(textures.erase(64), 0u);
+    EXPECT_EQ(textures.erase(1000), 0u);
+    EXPECT_EQ(textures.erase(0), 1u);
+    EXPECT_EQ(ids(), (std::vector<uint32_t>{3, 63, 130}));
+    EXPECT_EQ(textures.size(), 3u);
+    EXPECT_FALSE(textures.contains(64));
+    EXPECT_EQ(textures.Get(64), nullptr);
+    EXPECT_EQ(textures.find(64), textures.end());
+    EXPECT_THROW(textures.at(0), std::out_of_range);
+    ASSERT_NE(textures.find(130), textures.end());
+    EXPECT_EQ(textures.find(130)->second.id, 130u);
+
+    textures.clear();
+    EXPECT_TRUE(textures.empty());
+    EXPECT_EQ(textures.begin(), textures.end());
+}
+
+TEST(FshTextureTest, DecodesDXTAsTheScalarDecoder) {
+    for (Shared::PixelFormat const format : {Shared::PixelFormat::DXT1, Shared::PixelFormat::DXT3}) {
+        BlockFormat const blockFormat{format == Shared::PixelFormat::DXT1 ? BlockFormat::BC1 : BlockFormat::BC2};
+        // Sizes that are and aren't multiples of the block size, with enough block rows to decode on several threads
+        for (auto const [width, height] : {std::pair<uint16_t, uint16_t>{64, 32}, {13, 9}, {3, 2}, {40, 71}}) {
+            Shared::FshTexture texture(MakeFshTexture("dxtx", width, height, format, width));
+            std::vector<uint8_t> const expected{DecodeBlocks(texture.RawData().data(), width, height, blockFormat)};
+            EXPECT_EQ(texture.ToRGBA(), expected) << width << "x" << height;
+            std::vector<uint8_t> rgba;
+            ASSERT_TRUE(texture.DecodeDXTToRGBA(rgba, 4));
+            EXPECT_EQ(rgba, expected) << width << "x" << height;
+        }
+    }
+}
+
+TEST(FshTextureTest, UnpacksFourBitIndicesLowNibbleFirst) {
+    // Every width up to a few SIMD lanes, so both the vector and the scalar tails are covered
+    for (uint16_t width = 1; width <= 37; ++width) {
+        uint16_t constexpr kHeight{3};
+        Shared::FshTexture const texture{MakeFshTexture("nibl", width, kHeight, Shared::PixelFormat::Indexed4Bit, width)};
+        size_t const rowStride{(width + 1u) / 2u};
+        std::vector<uint8_t> const rgba{texture.ToRGBA()};
+        ASSERT_EQ(rgba.size(), static_cast<size_t>(width) * kHeight * 4);
+        for (uint32_t y = 0; y < kHeight; ++y) {
+            for (uint32_t x = 0; x < width; ++x) {
+                uint8_t const packed{texture.RawData()[y * rowStride + x / 2]};
+                Shared::Colour const &colour{texture.GetPalette()[(x & 1) ? packed >> 4 : packed & 0xF]};
+                uint8_t const *const texel{rgba.data() + (static_cast<size_t>(y) * width + x) * 4};
+                ASSERT_EQ(texel[0], colour.r) << width << ": " << x << ", " << y;
+                EXPECT_EQ(texel[1], colour.g);
+                EXPECT_EQ(texel[2], colour.b);
+                EXPECT_EQ(texel[3], colour.a);
+            }
+        }
+    }
+}
+
+TEST(BlockCompressionTest, EncodesWithinErrorBounds) {
+    // Smooth gradients with a noisy alpha ramp, sized so the last blocks are partial
+    uint32_t constexpr kWidth{37}, kHeight{22};
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> noiseDist(-8, 8);
+    std::vector<uint8_t> rgba(kWidth * kHeight * 4);
+    for (uint32_t y = 0; y < kHeight; ++y) {
+        for (uint32_t x = 0; x < kWidth; ++x) {
+            uint8_t *const texel{rgba.data() + (y * kWidth + x) * 4};
+            texel[0] = static_cast<uint8_t>(x * 255 / kWidth);
+            texel[1] = static_cast<uint8_t>(y * 255 / kHeight);
+            texel[2] = static_cast<uint8_t>(255 - (x + y) * 255 / (kWidth + kHeight));
+            texel[3] = static_cast<uint8_t>(std::clamp(static_cast<int>(x * 7) + noiseDist(rng), 0, 255));
+        }
+    }
+    std::vector<uint8_t> opaque{rgba};
+    for (size_t texelIdx = 0; texelIdx < opaque.size() / 4; ++texelIdx) {
+        opaque[texelIdx * 4 + 3] = 255;
+    }
+    EXPECT_EQ(BlockCompression::ChooseFormat(opaque), BlockFormat::BC1);
+    EXPECT_EQ(BlockCompression::ChooseFormat(rgba), BlockFormat::BC3);
+
+    double previousRmse[2]{DBL_MAX, DBL_MAX};
+    for (CompressionQuality const quality : {CompressionQuality::Fast, CompressionQuality::Normal, CompressionQuality::High}) {
+        for (BlockFormat const format : {BlockFormat::BC1, BlockFormat::BC3}) {
+            std::vector<uint8_t> const &source{format == BlockFormat::BC1 ? opaque : rgba};
+            std::vector<uint8_t> const blocks{BlockCompression::Encode(source, kWidth, kHeight, format, quality)};
+            ASSERT_EQ(blocks.size(), BlockCompression::CompressedSize(format, kWidth, kHeight));
+            std::vector<uint8_t> const decoded{DecodeBlocks(blocks.data(), kWidth, kHeight, format, true)};
+
+            // Bounds for smooth colour. Interpolated alpha steps are at most 255 / 7 apart.
+            int maxColourError{0}, maxAlphaError{0};
+            double squaredError{0.};
+            for (size_t texelIdx = 0; texelIdx < source.size() / 4; ++texelIdx) {
+                for (uint32_t channel = 0; channel < 3; ++channel) {
+                    int const error{std::abs(decoded[texelIdx * 4 + channel] - source[texelIdx * 4 + channel])};
+                    maxColourError = std::max(maxColourError, error);
+                    squaredError += error * error;
+                }
+                maxAlphaError = std::max(maxAlphaError, std::abs(decoded[texelIdx * 4 + 3] - source[texelIdx * 4 + 3]));
+            }
+            double const rmse{std::sqrt(squaredError / (source.size() / 4 * 3))};
+            EXPECT_LE(maxColourError, 20) << static_cast<int>(quality) << " " << static_cast<int>(format);
+            EXPECT_LE(rmse, 6.5) << static_cast<int>(quality) << " " << static_cast<int>(format);
+            // Better endpoints never cost accuracy
+            EXPECT_LE(rmse, previousRmse[format == BlockFormat::BC3] + 1e-6) << static_cast<int>(quality);
+            previousRmse[format == BlockFormat::BC3] = rmse;
+            EXPECT_LE(maxAlphaError, format == BlockFormat::BC1 ? 0 : 255 / 14 + 1) << static_cast<int>(quality);
+        }
+    }
+
+    // Colours exactly representable in 565 survive a solid block unchanged
+    std::vector<uint8_t> const solid{0xFF, 0x82, 0x29, 0xFF, 0xFF, 0x82, 0x29, 0xFF, 0xFF, 0x82, 0x29, 0xFF, 0xFF, 0x82, 0x29, 0xFF};
+    std::vector<uint8_t> const solidBlock{BlockCompression::Encode(solid, 2, 2, BlockFormat::BC1)};
+    EXPECT_EQ(DecodeBlocks(solidBlock.data(), 2, 2, BlockFormat::BC1, true), solid);
+}
+
+TEST(TextureContainerTest, WritesDDSAndKTX2Headers) {
+    TextureContainer container;
+    container.width = 8;
+    container.height = 4;
+    container.nLayers = 3;
+    container.nLevels = 2;
+    container.format = BlockFormat::BC1;
+    container.levelOffsets = {0, container.LayerSize(0) * 3};
+    container.data.resize(container.levelOffsets[1] + container.LayerSize(1) * 3);
+    for (size_t byteIdx = 0; byteIdx < container.data.size(); ++byteIdx) {
+        container.data[byteIdx] = static_cast<uint8_t>(byteIdx);
+    }
+    ASSERT_EQ(container.LayerSize(0), 16u);
+    ASSERT_EQ(container.LayerSize(1), 8u);
+
+    std::vector<uint8_t> const dds{container.Serialize(TextureContainerFormat::DDS)};
+    ASSERT_EQ(dds.size(), 148 + container.data.size());
+    EXPECT_EQ(Read32(dds, 0), 0x20534444u); // 'DDS '
+    EXPECT_EQ(Read32(dds, 4), 124u);
+    EXPECT_EQ(Read32(dds, 12), 4u);  // Height
+    EXPECT_EQ(Read32(dds, 16), 8u);  // Width
+    EXPECT_EQ(Read32(dds, 20), 16u); // Linear size
+    EXPECT_EQ(Read32(dds, 28), 2u);  // Mip count
+    EXPECT_EQ(Read32(dds, 84), 0x30315844u); // 'DX10'
+    EXPECT_EQ(Read32(dds, 128), 71u); // DXGI_FORMAT_BC1_UNORM
+    EXPECT_EQ(Read32(dds, 140), 3u);  // Array size
+    // Each layer's mip chain in turn
+    EXPECT_EQ(dds[148], container.Layer(0, 0)[0]);
+    EXPECT_EQ(dds[148 + 16], container.Layer(1, 0)[0]);
+    EXPECT_EQ(dds[148 + 24], container.Layer(0, 1)[0]);
+
+    std::vector<uint8_t> const ktx2{container.Serialize(TextureContainerFormat::KTX2)};
+    uint8_t constexpr kIdentifier[12]{0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+    ASSERT_GT(ktx2.size(), 128u);
+    EXPECT_TRUE(std::equal(std::begin(kIdentifier), std::end(kIdentifier), ktx2.begin()));
+    EXPECT_EQ(Read32(ktx2, 12), 133u); // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+    EXPECT_EQ(Read32(ktx2, 20), 8u);
+    EXPECT_EQ(Read32(ktx2, 24), 4u);
+    EXPECT_EQ(Read32(ktx2, 32), 3u); // Layers
+    EXPECT_EQ(Read32(ktx2, 36), 1u); // Faces
+    EXPECT_EQ(Read32(ktx2, 40), 2u); // Levels
+    EXPECT_EQ(Read32(ktx2, 44), 0u); // No supercompression
+    uint32_t const dfdOffset{Read32(ktx2, 48)};
+    EXPECT_EQ(dfdOffset, 80u + 24u * 2);
+    EXPECT_EQ(Read32(ktx2, dfdOffset + 12) & 0xFF, 128u); // KHR_DF_MODEL_BC1A
+    for (uint32_t level = 0; level < 2; ++level) {
+        uint64_t const offset{Read64(ktx2, 80 + 24 * level)};
+        uint64_t const length{Read64(ktx2, 80 + 24 * level + 8)};
+        EXPECT_EQ(offset % 8, 0u);
+        EXPECT_EQ(length, container.LayerSize(level) * 3);
+        ASSERT_LE(offset + length, ktx2.size());
+        EXPECT_TRUE(std::equal(ktx2.begin() + static_cast<std::ptrdiff_t>(offset),
+                               ktx2.begin() + static_cast<std::ptrdiff_t>(offset + length), container.Layer(level, 0)));
+    }
+
+    // A single RGBA8 layer is a plain 2D texture with bit masks instead of a DX10 header
+    container.nLayers = 1;
+    container.nLevels = 1;
+    container.format = BlockFormat::None;
+    container.levelOffsets = {0};
+    container.data.assign(container.LayerSize(0), 0x7F);
+    std::vector<uint8_t> const rgbaDds{container.Serialize(TextureContainerFormat::DDS)};
+    ASSERT_EQ(rgbaDds.size(), 128 + container.data.size());
+    EXPECT_EQ(Read32(rgbaDds, 20), 32u); // Pitch
+    EXPECT_EQ(Read32(rgbaDds, 80), 0x41u); // DDPF_RGB | DDPF_ALPHAPIXELS
+    EXPECT_EQ(Read32(rgbaDds, 88), 32u);
+    EXPECT_EQ(Read32(rgbaDds, 104), 0xFF000000u); // Alpha mask
+    std::vector<uint8_t> const rgbaKtx2{container.Serialize(TextureContainerFormat::KTX2)};
+    EXPECT_EQ(Read32(rgbaKtx2, 12), 37u); // VK_FORMAT_R8G8B8A8_UNORM
+    EXPECT_EQ(Read32(rgbaKtx2, 32), 0u);  // Not an array
+}